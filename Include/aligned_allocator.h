@@ -0,0 +1,144 @@
+/**
+ * @file aligned_allocator.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Allocator returning memory aligned on a given boundary.
+ * @details Used with #Array2d, the allocator also pads the lines of the array so that each
+ * line starts on the boundary (see #Allocator_alignment).
+ */
+
+
+#ifndef ALIGNED_ALLOCATOR_H
+#define ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+
+/**
+ * @brief Allocator returning memory aligned on Alignment bytes
+ * @details Alignment must be a power of two, multiple of sizeof(void*). The default alignment
+ * (64 bytes) is the size of a cache line and of an AVX-512 register.
+ *
+ * A minimal example is given by the following code:
+ * @code{cpp}
+ * std::vector<double, Aligned_allocator<double> > v(100);  // v.data() is aligned on 64 bytes
+ *
+ * Array2d<double, Row_major, Aligned_allocator<double> > A(10, 13);
+ * // Each row starts on 64 bytes and A.stride() == 16
+ * @endcode
+ */
+template <class T, size_t Alignment = 64>
+class Aligned_allocator
+{
+ public:
+  typedef T value_type;          /**< @brief Type of the allocated elements */
+  typedef T* pointer;            /**< @brief Pointer on an element */
+  typedef const T* const_pointer; /**< @brief Constant pointer on an element */
+  typedef size_t size_type;      /**< @brief Type of the sizes */
+  typedef std::ptrdiff_t difference_type; /**< @brief Type of the distance between pointers */
+
+  /** @brief Same allocator for another type */
+  template <class U> struct rebind { typedef Aligned_allocator<U, Alignment> other; };
+
+  static_assert((Alignment & (Alignment-1)) == 0 && Alignment % sizeof(void*) == 0,
+                "The alignment must be a power of two, multiple of sizeof(void*)");
+
+  /** @brief Constructor */
+  inline Aligned_allocator() noexcept {}
+
+  /** @brief Conversion from an allocator of another type */
+  template <class U>
+  inline Aligned_allocator(const Aligned_allocator<U, Alignment>&) noexcept {}
+
+  /**
+   * @brief Allocate memory for iN elements, aligned on Alignment bytes
+   * @throw std::bad_alloc if the memory can not be allocated
+   */
+  inline T* allocate(size_t iN);
+
+  /** @brief Free memory returned by allocate() */
+  inline void deallocate(T* iPtr, size_t) noexcept;
+};
+
+
+/** @brief All the aligned allocators with the same alignment are equal */
+template <class T, class U, size_t Alignment>
+inline bool operator==(const Aligned_allocator<T,Alignment>&, const Aligned_allocator<U,Alignment>&)
+{
+  return true;
+}
+
+/** @brief All the aligned allocators with the same alignment are equal */
+template <class T, class U, size_t Alignment>
+inline bool operator!=(const Aligned_allocator<T,Alignment>&, const Aligned_allocator<U,Alignment>&)
+{
+  return false;
+}
+
+
+/**
+ * @brief Alignment in bytes of the memory returned by an allocator
+ * @details The value is 0 if the alignment is unknown (for example, for std::allocator). It
+ * is Alignment for #Aligned_allocator.
+ */
+template <class Alloc>
+struct Allocator_alignment
+{
+  enum { value = 0 };
+};
+
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+template <class T, size_t Alignment>
+struct Allocator_alignment< Aligned_allocator<T,Alignment> >
+{
+  enum { value = Alignment };
+};
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+
+template <class T, size_t Alignment>
+inline T* Aligned_allocator<T,Alignment>::allocate(size_t iN)
+{
+  if (iN == 0)
+    return 0;
+  if (iN > size_t(-1) / sizeof(T))
+    throw std::bad_alloc();
+#ifdef _WIN32
+  void* ptr = _aligned_malloc(iN*sizeof(T), Alignment);
+#else
+  void* ptr = 0;
+  if (posix_memalign(&ptr, Alignment, iN*sizeof(T)) != 0)
+    ptr = 0;
+#endif
+  if (!ptr)
+    throw std::bad_alloc();
+  return static_cast<T*>(ptr);
+}
+
+
+template <class T, size_t Alignment>
+inline void Aligned_allocator<T,Alignment>::deallocate(T* iPtr, size_t) noexcept
+{
+#ifdef _WIN32
+  _aligned_free(iPtr);
+#else
+  free(iPtr);
+#endif
+}
+
+
+#endif // ALIGNED_ALLOCATOR_H
@@ -11,10 +11,101 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include "aligned_allocator.h"
+#include "parallel_tools.h"
+#include "simd_tools.h"
+
+
+template <class E> class Array2d_expr;
+
+
+/**
+ * @brief Layout of #Array2d storing the elements row after row (default layout).
+ * @details The rows are contiguous: rows are cheap to insert, erase and scan, columns are
+ * cheap to append.
+ */
+struct Row_major
+{
+  enum { is_row_major = true }; /**< @brief True for the row-major layout */
+};
+
+
+/**
+ * @brief Layout of #Array2d storing the elements column after column.
+ * @details The columns are contiguous: columns are cheap to insert, erase and scan, rows are
+ * cheap to append. This layout is suited to arrays built column by column.
+ */
+struct Column_major
+{
+  enum { is_row_major = false }; /**< @brief False for the column-major layout */
+};
+
+
+/**
+ * @brief Forward iterator on all the elements of an #Array2d, in the storage order.
+ * @details The elements are visited line after line (row after row for the row-major layout,
+ * column after column for the column-major layout). The iterator skips the unused elements at
+ * the end of each line slot (see the stride of #Array2d). U is either T or const T.
+ */
+template <class U>
+class Array2d_iterator
+{
+ public:
+  typedef std::forward_iterator_tag iterator_category; /**< @brief Iterator category */
+  typedef typename std::remove_const<U>::type value_type; /**< @brief Type of the elements */
+  typedef std::ptrdiff_t difference_type; /**< @brief Type of the distance between iterators */
+  typedef U* pointer;                     /**< @brief Pointer on an element */
+  typedef U& reference;                   /**< @brief Reference on an element */
+
+  /** @brief Default constructor */
+  inline Array2d_iterator();
+
+  /**
+   * @brief Constructor
+   * @param[in] iPtr Pointer on the current element
+   * @param[in] iI Position of the current element in its line
+   * @param[in] iN Number of elements of a line
+   * @param[in] iStride Stride between two lines
+   */
+  inline Array2d_iterator(U* iPtr, int iI, int iN, int iStride);
+
+  /** @brief Conversion from a mutable iterator to a constant iterator */
+  template <class V>
+  inline Array2d_iterator(const Array2d_iterator<V>& iIt);
+
+  /** @brief Access to the current element */
+  inline U& operator*() const;
+
+  /** @brief Access to the members of the current element */
+  inline U* operator->() const;
+
+  /** @brief Move to the next element (prefix) */
+  inline Array2d_iterator& operator++();
+
+  /** @brief Move to the next element (postfix) */
+  inline Array2d_iterator operator++(int);
+
+  /** @brief Return true if the two iterators point on the same element */
+  inline bool operator==(const Array2d_iterator& iIt) const;
+
+  /** @brief Return true if the two iterators point on different elements */
+  inline bool operator!=(const Array2d_iterator& iIt) const;
+
+  U* _ptr;     /**< @brief Pointer on the current element */
+  int _i;      /**< @brief Position of the current element in its line */
+  int _n;      /**< @brief Number of elements of a line */
+  int _stride; /**< @brief Stride between two lines */
+};
+
 
 /**
  * @brief Template for dynamic array with two dimensions.
@@ -29,40 +120,56 @@
  *   // Create an array with 2 line and 3 column.
  *   // This array is filled with value 0.
  *   Array2d<int> myTab(2,3);
- * 
+ *
  *   // Insert a column between column 0 and 1.
  *   // This column is filled with value 5.
  *   myTab.insert_column(1, std::vector<int>(2,5));
- * 
+ *
  *   // Put the value 4 at line 0 and column 2
  *   myTab(0,2) = 4;
- * 
+ *
  *   // Resize the array to get an 3x3 array.
  *   // If elements new elements are created, their value is 1.
  *   myTab.resize(3,3,1);
- * 
+ *
  *   // Print the array in the standard output
  *   for (int j = 0; j < myTab.nb_rows(); j++) {
  *     for (int i = 0; i < myTab.nb_columns(); i++)
  *       std::cout << myTab(j,i) << " ";
  *     std::cout << std::endl;
  *   }
- * 
+ *
  *   return 0;
  * }
  * @endcode
  * The expected output is:
  * @code{txt}
- * 0 5 4 
- * 0 5 0 
- * 1 1 1 
+ * 0 5 4
+ * 0 5 0
+ * 1 1 1
  * @endcode
  *
+ * The elements are stored in a single contiguous buffer, line after line. With the default
+ * layout #Row_major the lines are the rows, with the layout #Column_major the lines are the
+ * columns. Each line occupies a slot whose size (the stride) may be greater than the length
+ * of the line, so that elements can be appended to all the lines (that is, a column for
+ * the row-major layout, a row for the column-major layout) in amortized O(number of lines).
+ * Inserting or erasing a whole line only moves the following lines in a single block.
+ *
+ * The buffer is allocated with Alloc. For example, the arrays of a short task can be
+ * allocated in an arena with std::pmr::polymorphic_allocator:
+ * @code{cpp}
+ * std::pmr::monotonic_buffer_resource arena;
+ * Array2d<double, Row_major, std::pmr::polymorphic_allocator<double> > A(100, 100, &arena);
+ * @endcode
+ * With #Aligned_allocator, each line is padded so that all the lines start on the alignment
+ * boundary (see stride()): the vectorized kernels never load data across two cache lines.
+ *
  * @b Exception @b safety:
- * If the container size is greater than n, the function never throws exceptions (no-throw 
+ * If the container size is greater than n, the function never throws exceptions (no-throw
  * guarantee). Otherwise, the behavior is undefined.
  */
-template <class T>
+template <class T, class Layout = Row_major, class Alloc = std::allocator<T> >
 class Array2d
 {
  public:
@@ -70,23 +177,88 @@ class Array2d
    * @brief Constructor
    * @param[in] iP Number of rows of the array
    * @param[in] iN Number of columns of the array
+   * @param[in] iAlloc Allocator of the buffer
    */
-  inline Array2d(int iP = 0, int iN = 0);
-  
+  inline Array2d(int iP = 0, int iN = 0, const Alloc& iAlloc = Alloc());
+
   /**
    * @brief Copy constructor
    * @param[in] iArray2d 2-dimensional array whose values will be copied
    */
-  inline Array2d(Array2d & iArray2d);
+  inline Array2d(const Array2d & iArray2d);
+
+  /**
+   * @brief Copy constructor with another allocator
+   * @param[in] iArray2d 2-dimensional array whose values will be copied
+   * @param[in] iAlloc Allocator of the buffer
+   */
+  inline Array2d(const Array2d & iArray2d, const Alloc& iAlloc);
+
+  /**
+   * @brief Move constructor
+   * @param[in] iArray2d 2-dimensional array whose buffer is taken (it is left empty)
+   */
+  inline Array2d(Array2d && iArray2d) noexcept;
 
   /** @brief Destructor */
   inline ~Array2d();
 
+  /**
+   * @brief Copy assignment (see copy())
+   * @param[in] iArray2d 2-dimensional array whose values will be copied
+   */
+  inline Array2d& operator=(const Array2d & iArray2d);
+
+  /**
+   * @brief Move assignment
+   * @param[in] iArray2d 2-dimensional array whose buffer is taken (it is left empty)
+   */
+  inline Array2d& operator=(Array2d && iArray2d)
+    noexcept(std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value);
+
+  /**
+   * @brief Constructor from an element-wise expression (see array2d_expr.h)
+   * @param[in] iExpr Expression evaluated in a single pass
+   * @param[in] iAlloc Allocator of the buffer
+   */
+  template <class E>
+  inline Array2d(const Array2d_expr<E> & iExpr, const Alloc& iAlloc = Alloc());
+
+  /**
+   * @brief Assignment of an element-wise expression (see array2d_expr.h)
+   * @details The array is resized to the size of the expression, then each element is
+   * evaluated once, line after line, without temporary array. The array can appear in the
+   * expression.
+   * @param[in] iExpr Expression whose arrays have the same size and layout
+   */
+  template <class E>
+  inline Array2d& operator=(const Array2d_expr<E> & iExpr);
+
+  /**
+   * @brief Assignment of an element-wise expression (see operator=(const Array2d_expr<E>&))
+   * @param[in] iExpr Expression whose arrays have the same size and layout
+   * @param[in] iPolicy Parameters of the multithreading (the lines are evaluated in parallel)
+   */
+  template <class E>
+  inline void assign(const Array2d_expr<E> & iExpr, const Parallel_policy& iPolicy = Parallel_policy());
+
+  /**
+   * @brief Exchange the contents of two arrays in constant time
+   * @param[in,out] ioArray2d Array to exchange with this array
+   * @warning If the allocator does not propagate on swap (for example
+   * std::pmr::polymorphic_allocator), the two arrays must have equal allocators.
+   */
+  inline void swap(Array2d & ioArray2d) noexcept;
+
   /**
    * @brief Resize the array and fill it with the argument array
+   * @details The current buffer is reused if its capacity is large enough, so that copying
+   * arrays of the same size never allocates memory. The copied array is stored without gap
+   * between its lines, and the elements are copied with memcpy if T is trivially copyable.
    * @param[in] iArray2d Array whose will must be copied
+   * @param[in] iPolicy Parameters of the multithreading (the lines are copied in parallel)
    */
-  inline void copy(Array2d& iArray2d);
+  inline void copy(const Array2d& iArray2d, const Parallel_policy& iPolicy = Parallel_policy());
 
   /**
    * @brief Erase a column of the array
@@ -96,6 +268,7 @@ class Array2d
 
   /**
    * @brief Erase columns of the array
+   * @details If all the columns are erased, the array keeps its rows (with no column).
    * @param[in] iBegin Index of the first column to erase
    * @param[in] iEnd Index of the last column to erase (excluded)
    */
@@ -109,6 +282,7 @@ class Array2d
 
   /**
    * @brief Erase rows of the array
+   * @details If all the rows are erased, the array is cleared.
    * @param[in] iBegin Index of the first row to erase
    * @param[in] iEnd Index of the last row to erase
    */
@@ -135,21 +309,23 @@ class Array2d
   inline void push_back_column(const std::vector<T> & iC);
 
   /**
-   * @brief Add a row at the end of the array 
+   * @brief Add a row at the end of the array
    * @param[in] iR Vector containing elements of the new row
    */
   inline void push_back_row(const std::vector<T> & iR);
-  
+
   /**
    * @brief Change the size of the array keeping its elements
    * @param[in] iP New number of rows of the array
    * @param[in] iN New Number of columns of the array
-   * @param[in] iVal Object whose content is copied to the added elements (in case that new size 
-   * is greater than the current container size). If not specified, the default constructor is 
+   * @param[in] iVal Object whose content is copied to the added elements (in case that new size
+   * is greater than the current container size). If not specified, the default constructor is
    * used instead.
+   * @param[in] iPolicy Parameters of the multithreading (the existing lines are extended in
+   * parallel)
    */
-  inline void resize(int iP, int iN, T iVal = T());
-  
+  inline void resize(int iP, int iN, T iVal = T(), const Parallel_policy& iPolicy = Parallel_policy());
+
   /**
    * @brief Removes all elements from the array (which are destroyed), leaving the container
    * with a size of 0.
@@ -162,14 +338,65 @@ class Array2d
   /** @brief Exchange the values of the rows i and j */
   inline void swap_row(int i, int j);
 
+  /**
+   * @brief Erase a set of columns of the array in a single pass over the elements
+   * @details If all the columns are erased, the array keeps its rows (with no column), as with
+   * erase_columns(int,int).
+   * @param[in] iColumns Indexes of the columns to erase (in any order, duplicates are ignored)
+   */
+  inline void erase_columns(const std::vector<int> & iColumns);
+
+  /**
+   * @brief Erase a set of rows of the array in a single pass over the elements
+   * @details If all the rows are erased, the array is cleared, as with erase_rows(int,int).
+   * @param[in] iRows Indexes of the rows to erase (in any order, duplicates are ignored)
+   */
+  inline void erase_rows(const std::vector<int> & iRows);
+
+  /**
+   * @brief Insert several columns in a single pass over the elements
+   * @details The column iC[k] is inserted before the column iPositions[k] of the current
+   * array (at the end if iPositions[k] is nb_columns()). The columns inserted at the same
+   * position keep their order in iC.
+   * @param[in] iPositions Positions of insertion, in the indexes of the current array
+   * @param[in] iC Elements of the new columns (nb_rows() elements each)
+   */
+  inline void insert_columns(const std::vector<int> & iPositions, const std::vector< std::vector<T> > & iC);
+
+  /**
+   * @brief Insert several rows in a single pass over the elements
+   * @details The row iR[k] is inserted before the row iPositions[k] of the current array (at
+   * the end if iPositions[k] is nb_rows()). The rows inserted at the same position keep their
+   * order in iR.
+   * @param[in] iPositions Positions of insertion, in the indexes of the current array
+   * @param[in] iR Elements of the new rows (nb_columns() elements each)
+   */
+  inline void insert_rows(const std::vector<int> & iPositions, const std::vector< std::vector<T> > & iR);
+
+  /**
+   * @brief Reorder the columns: the new column i is the former column iPermutation[i]
+   * @param[in] iPermutation Permutation of [0, nb_columns()[
+   */
+  inline void permute_columns(const std::vector<int> & iPermutation);
+
+  /**
+   * @brief Reorder the rows: the new row j is the former row iPermutation[j]
+   * @param[in] iPermutation Permutation of [0, nb_rows()[
+   */
+  inline void permute_rows(const std::vector<int> & iPermutation);
+
+  /** @brief Return the allocator of the buffer */
+  inline Alloc get_allocator() const;
+
   /** @brief Return the number of rows of the array */
-  inline int nb_rows();
+  inline int nb_rows() const;
 
   /** @brief Return the number of columns of the array */
-  inline int nb_columns();
+  inline int nb_columns() const;
 
   /**
    * @brief Write access to coefficients of the array
+   * @details The indexes are checked only in debug builds (that is, if NDEBUG is not defined).
    * @param[in] iJ Index of the row
    * @param[in] iI Index of the column
    */
@@ -182,11 +409,115 @@ class Array2d
    */
   inline const T& operator()(int iJ, int iI)const;
 
+  /**
+   * @brief Write access to coefficients of the array without bounds checking
+   * @details Unlike operator()(int,int), this method never checks its arguments, even in
+   * debug builds.
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   */
+  inline T& unchecked(int iJ, int iI);
+
+  /**
+   * @brief Read access to coefficients of the array without bounds checking
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   */
+  inline const T& unchecked(int iJ, int iI)const;
+
+  /**
+   * @brief Return the number of lines of the storage (rows for the row-major layout, columns
+   * for the column-major layout)
+   */
+  inline int nb_lines() const;
+
+  /** @brief Return the number of elements of a line of the storage */
+  inline int line_size() const;
+
+  /**
+   * @brief Return the distance (in elements) between the beginnings of two consecutive lines
+   * @details The stride is greater or equal to line_size(). With an aligned allocator (for
+   * example #Aligned_allocator), it is a multiple of the alignment, so that all the lines
+   * start on the alignment boundary.
+   */
+  inline int stride() const;
+
+  /**
+   * @brief Return a pointer on the first element of a line of the storage
+   * @details The line_size() elements of the line are contiguous.
+   * @param[in] iK Index of the line
+   */
+  inline T* line_data(int iK);
+
+  /**
+   * @brief Return a constant pointer on the first element of a line of the storage
+   * @param[in] iK Index of the line
+   */
+  inline const T* line_data(int iK)const;
+
+  /**
+   * @brief Return a pointer on the first element of a row
+   * @details The nb_columns() elements of the row are contiguous.
+   * @param[in] iJ Index of the row
+   * @warning Only available with the row-major layout.
+   */
+  inline T* row_data(int iJ);
+
+  /**
+   * @brief Return a constant pointer on the first element of a row
+   * @param[in] iJ Index of the row
+   * @warning Only available with the row-major layout.
+   */
+  inline const T* row_data(int iJ)const;
+
+  /** @brief Return a pointer on the first element of a row (same as row_data()) */
+  inline T* row_begin(int iJ);
+
+  /** @brief Return a constant pointer on the first element of a row */
+  inline const T* row_begin(int iJ)const;
+
+  /** @brief Return a pointer past the last element of a row */
+  inline T* row_end(int iJ);
+
+  /** @brief Return a constant pointer past the last element of a row */
+  inline const T* row_end(int iJ)const;
+
+  /**
+   * @brief Return a pointer on the first element of a column
+   * @details The nb_rows() elements of the column are contiguous.
+   * @param[in] iI Index of the column
+   * @warning Only available with the column-major layout.
+   */
+  inline T* column_data(int iI);
+
+  /**
+   * @brief Return a constant pointer on the first element of a column
+   * @param[in] iI Index of the column
+   * @warning Only available with the column-major layout.
+   */
+  inline const T* column_data(int iI)const;
+
+  typedef Array2d_iterator<T> iterator;             /**< @brief Iterator on all the elements */
+  typedef Array2d_iterator<const T> const_iterator; /**< @brief Constant iterator on all the elements */
+
+  /** @brief Return an iterator on the first element of the array (in the storage order) */
+  inline iterator begin();
+
+  /** @brief Return a constant iterator on the first element of the array (in the storage order) */
+  inline const_iterator begin()const;
+
+  /** @brief Return an iterator past the last element of the array */
+  inline iterator end();
+
+  /** @brief Return a constant iterator past the last element of the array */
+  inline const_iterator end()const;
+
   /**
    * @brief Print the array on the standard output
    * @details The method is specialized for the following type: char, unsigned char, int, short
    * int, long int, unsigned int, unsigned short int, unsigned long int, float, double, long
    * double, std::string. In the other cases, the method prints nothing.
+   * To write large arrays in a file, use write_array2d_text() (see array2d_io.h).
    */
   inline void print();
 
@@ -195,359 +526,1585 @@ class Array2d
    * @param[in] A Array with the same size
    * @details The method is specialized for the following type: int, short, int, long int,
    * unsigned int, unsigned short int, unsigned long int, float, double, long, double.
-   * @return The dot product of the two arrays. If T has no operator * (that is, if the method is 
+   * @param[in] iPolicy Parameters of the multithreading
+   * @return The dot product of the two arrays. If T has no operator * (that is, if the method is
    * not specialized for the type T), the method returns a default construction of T.
    */
-  inline T dot_product(Array2d<T>& A);
+  inline T dot_product(const Array2d& A, const Parallel_policy& iPolicy = Parallel_policy()) const;
 
- protected:
-  std::vector< std::vector<T> > _aT; /**< @brief Array containing the values */
-  
-};
+  /**
+   * @brief Return the sum of the elements of the array
+   * @details The computation uses the kernels of #Simd_kernels (vectorized for float, double
+   * and int) on blocks of lines, which are distributed among the threads.
+   * @param[in] iPolicy Parameters of the multithreading
+   */
+  inline T sum(const Parallel_policy& iPolicy = Parallel_policy()) const;
 
+  /**
+   * @brief Return the minimal element of the array
+   * @param[in] iPolicy Parameters of the multithreading
+   * @warning The array must not be empty.
+   */
+  inline T min(const Parallel_policy& iPolicy = Parallel_policy()) const;
 
-//==============================================================================
-// Implementation of methods
-//==============================================================================
+  /**
+   * @brief Return the maximal element of the array
+   * @param[in] iPolicy Parameters of the multithreading
+   * @warning The array must not be empty.
+   */
+  inline T max(const Parallel_policy& iPolicy = Parallel_policy()) const;
 
-template <class T>
-inline Array2d<T>::Array2d(int iP, int iN)
-: _aT(iP, std::vector<T>(iN, T()))
-{
-}
+  /**
+   * @brief Return the squared Frobenius norm of the array (sum of the squares of its elements)
+   * @param[in] iPolicy Parameters of the multithreading
+   */
+  inline T norm2(const Parallel_policy& iPolicy = Parallel_policy()) const;
 
-template <class T>
-inline Array2d<T>::Array2d(Array2d & iArray2d)
-: _aT(iArray2d._aT)
-{
-}
+  /**
+   * @brief Compute this = a*X + this
+   * @param[in] iA Scalar a
+   * @param[in] iX Array X with the same size
+   * @param[in] iPolicy Parameters of the multithreading
+   */
+  inline void axpy(T iA, const Array2d& iX, const Parallel_policy& iPolicy = Parallel_policy());
 
-template <class T>
-inline Array2d<T>::~Array2d()
-{
-}
+  /**
+   * @brief Assign a value to all the elements of the array
+   * @param[in] iVal New value of the elements
+   * @param[in] iPolicy Parameters of the multithreading
+   */
+  inline void fill(const T& iVal, const Parallel_policy& iPolicy = Parallel_policy());
 
-template <class T>
-inline void Array2d<T>::copy(Array2d& iArray2d)
-{
-  unsigned int nb_rows = iArray2d.nb_rows();
-  unsigned int nb_cols = iArray2d.nb_columns();
-  resize(nb_rows,nb_cols);
-  for (unsigned int r = 0; r < nb_rows; r++) {
-    for (unsigned int c = 0; c < nb_cols; c++) {
-      (*this)(r,c) = iArray2d(r,c);
-    }
-  }
-}
+  /**
+   * @brief Replace each element x of the array by F(x)
+   * @param[in] iF Function or functor taking a T and returning a T
+   * @param[in] iPolicy Parameters of the multithreading. If several threads are used, iF must
+   * be thread-safe.
+   */
+  template <class F>
+  inline void transform(F iF, const Parallel_policy& iPolicy = Parallel_policy());
 
-template <class T>
-inline void Array2d<T>::erase_column(int iI)
-{
-  if (0 <= iI && iI < nb_columns()) {
-    for (int j = 0; j < _aT.size(); j++)
-      _aT[j].erase(_aT.begin()+iI);
-  }
-  else {
-    std::cerr << "[WARNING] void Array2d<T>::erase_column(int)" << std::endl
-              << "Column index out of range. No column removed." << std::endl;
-    assert(false);
-  }
-}
+  /**
+   * @brief Compute the transpose of the array
+   * @details The array is processed by square tiles which fit in the cache, so that both the
+   * reads and the writes stay local. If oT is this array, transpose_in_place() is called.
+   * @param[out] oT Transpose of the array (resized to nb_columns() x nb_rows())
+   * @param[in] iPolicy Parameters of the multithreading (the tiles are distributed among the
+   * threads)
+   */
+  inline void transpose(Array2d& oT, const Parallel_policy& iPolicy = Parallel_policy()) const;
 
-template <class T>
-inline void Array2d<T>::erase_columns(int iBegin, int iEnd)
-{
-  if (0 <= iBegin && iBegin <= iEnd && iEnd <= nb_columns()) {
-    for (int j = 0; j < _aT.size(); j++)
-      _aT[j].erase(_aT[j].begin()+iBegin, _aT[j].begin()+iEnd);
-  }
-  else {
-    std::cerr << "[WARNING] void Array2d<T>::erase_columns(int,int)" << std::endl
-              << "Column index out of range. No columns removed." << std::endl;
-    assert(false);
-  }
-}
+  /**
+   * @brief Transpose the array
+   * @details A square array is transposed in place by swapping its tiles. Otherwise, the
+   * transpose is computed in a temporary array.
+   * @param[in] iPolicy Parameters of the multithreading
+   */
+  inline void transpose_in_place(const Parallel_policy& iPolicy = Parallel_policy());
 
-template <class T>
-inline void Array2d<T>::erase_row(int iJ)
-{
-  if (0 <= iJ && iJ < nb_rows()) {
-    _aT.erase(_aT.begin()+iJ);
-  }
-  else {
-    std::cerr << "[WARNING] void Array2d<T>::erase_row(int)" << std::endl
-              << "Row index out of range. No row removed." << std::endl;
-    assert(false);
-  }
-}
+  /**
+   * @brief Compute the matrix product C = this * B
+   * @details The product is computed by tiles of the inner dimension and of the lines of C,
+   * each tile being updated with the axpy kernel of #Simd_kernels on contiguous lines. The
+   * lines of C are distributed among the threads.
+   * @param[in] iB Array whose number of rows is the number of columns of this array
+   * @param[out] oC Product (resized to nb_rows() x iB.nb_columns()). It can be this array or iB.
+   * @param[in] iPolicy Parameters of the multithreading
+   */
+  inline void multiply(const Array2d& iB, Array2d& oC, const Parallel_policy& iPolicy = Parallel_policy()) const;
 
-template <class T>
-inline void Array2d<T>::erase_rows(int iBegin, int iEnd)
-{
-  if (0 <= iBegin && iBegin <= iEnd && iEnd <= nb_rows()){
-    _aT.erase(_aT.begin()+iBegin, _aT.begin()+iEnd);
-  }
-  else {
-    std::cerr << "[WARNING] void Array2d<T>::erase_rows(int,int)" << std::endl
-              << "Row index out of range. No rows removed." << std::endl;
-    assert(false);
-  }
-}
+ protected:
+  enum { TILE_SIZE = 64 }; /**< @brief Side of the tiles of transpose() and multiply() */
 
-template <class T>
-inline void Array2d<T>::insert_column(int iI, const std::vector<T> & iC)
-{
-  if (nb_rows()==0) {
-    _aT.assign(iC.size(), std::vector<T>());
-  }
-  if (0 <= iI && iI <= nb_columns()) {
-    if (iC.size() == (unsigned int)nb_rows()) {
-      for (int j = 0; j < nb_rows(); j++)
-        _aT[j].insert(_aT[j].begin()+iI, iC[j]);
-    }
-    else {
-      std::cerr << "[WARNING] void Array2d<T>::insert_column(int, const std::vector<T>&)" << std::endl
-                << "New column size different from array column size. No column added." << std::endl;
-      assert(false);
-    }
-  }
-  else {
-    std::cerr << "[WARNING] void Array2d<T>::insert_column(int, const std::vector<T>&)" << std::endl
-              << "Column index out of range. No column added." << std::endl;
-    assert(false);
-  }
-}
+  /** @brief Return the position of the element (iJ,iI) in the buffer */
+  inline ptrdiff_t index(int iJ, int iI) const;
 
+  /**
+   * @brief Insert a line of the storage
+   * @param[in] iK Index for insertion of the line
+   * @param[in] iL Vector containing the line_size() elements of the new line
+   */
+  inline void insert_line(int iK, const std::vector<T> & iL);
 
-template <class T>
-inline void Array2d<T>::insert_row(int iJ, const std::vector<T> & iR)
-{
-  if (0 <= iJ && iJ <= nb_rows()) {
-    if (iR.size() == (unsigned int)nb_columns()) {
-      _aT.insert(_aT.begin()+iJ, iR);
-    }
-    else {
-      std::cerr << "[WARNING] void Array2d<T>::insert_row(int, const std::vector<T>&)" << std::endl
-                << "New row size different from array row size. No row added." << std::endl;
-      assert(false);
-    }
-  }
-  else {
-    std::cerr << "[WARNING] void Array2d<T>::insert_row(int, const std::vector<T>&)" << std::endl
-              << "Row index out of range. No row added." << std::endl;
-    assert(false);
-  }
-}
+  /**
+   * @brief Erase lines of the storage
+   * @param[in] iBegin Index of the first line to erase
+   * @param[in] iEnd Index of the last line to erase (excluded)
+   */
+  inline void erase_lines(int iBegin, int iEnd);
 
+  /**
+   * @brief Insert an element at the same position in all the lines of the storage
+   * @param[in] iI Position of the new elements in the lines
+   * @param[in] iV Vector containing the nb_lines() new elements
+   */
+  inline void insert_in_lines(int iI, const std::vector<T> & iV);
 
-template <class T>
-inline void Array2d<T>::resize(int iP, int iN, T iVal)
-{
-  _aT.resize(iP);
-  for (int i = 0; i < iP; i++)
-    _aT[i].resize(iN, iVal);
-}
+  /**
+   * @brief Erase the elements at the same positions in all the lines of the storage
+   * @param[in] iBegin Position of the first element to erase in the lines
+   * @param[in] iEnd Position of the last element to erase in the lines (excluded)
+   */
+  inline void erase_in_lines(int iBegin, int iEnd);
 
+  /**
+   * @brief Erase lines of the storage in a single pass
+   * @param[in] iK Indexes of the lines to erase (sorted, without duplicates)
+   */
+  inline void erase_line_set(const std::vector<int> & iK);
+
+  /**
+   * @brief Erase the elements at the same positions in all the lines of the storage
+   * @param[in] iK Positions of the elements to erase (sorted, without duplicates)
+   */
+  inline void erase_in_line_set(const std::vector<int> & iK);
+
+  /**
+   * @brief Insert lines of the storage in a single pass
+   * @param[in] iK Positions of insertion
+   * @param[in] iL Elements of the new lines
+   * @param[in] iOrder Indexes of iK and iL sorted by position
+   */
+  inline void insert_line_set(const std::vector<int> & iK, const std::vector< std::vector<T> > & iL,
+                              const std::vector<int> & iOrder);
+
+  /**
+   * @brief Insert elements at the same positions in all the lines of the storage
+   * @param[in] iK Positions of insertion in the lines
+   * @param[in] iV Elements inserted at each position (nb_lines() elements each)
+   * @param[in] iOrder Indexes of iK and iV sorted by position
+   */
+  inline void insert_in_line_set(const std::vector<int> & iK, const std::vector< std::vector<T> > & iV,
+                                 const std::vector<int> & iOrder);
+
+  /**
+   * @brief Reorder the lines of the storage by following the cycles of the permutation
+   * @param[in] iPermutation Permutation of the lines (the new line k is the former line
+   * iPermutation[k])
+   */
+  inline void permute_lines(const std::vector<int> & iPermutation);
+
+  /**
+   * @brief Reorder the elements of all the lines of the storage
+   * @param[in] iPermutation Permutation of the elements of a line
+   */
+  inline void permute_in_lines(const std::vector<int> & iPermutation);
+
+  /**
+   * @brief Sort a set of indexes and remove its duplicates
+   * @return False if an index is not in [0, iN[
+   */
+  static inline bool sort_indexes(std::vector<int> & ioK, int iN);
+
+  /**
+   * @brief Check the positions and the sizes of the inserted vectors, and return in oOrder the
+   * indexes sorted by position
+   * @return False if a position is not in [0, iNbMax] or if a vector has not iSize elements
+   */
+  static inline bool sort_insertions(const std::vector<int> & iK, const std::vector< std::vector<T> > & iV,
+                                     int iNbMax, int iSize, std::vector<int> & oOrder);
+
+  /** @brief Return true if iPermutation is a permutation of [0, iN[ */
+  static inline bool is_permutation(const std::vector<int> & iPermutation, int iN);
+
+  /**
+   * @brief Reallocate the buffer with a new stride, keeping the elements
+   * @param[in] iStride New stride (must be greater or equal to the line size)
+   */
+  inline void set_stride(int iStride);
+
+  /**
+   * @brief Return the smallest stride greater or equal to iN which keeps the lines aligned
+   * @details If the allocator is aligned (see #Allocator_alignment), the stride is a multiple
+   * of the alignment divided by sizeof(T). Otherwise, the stride is iN.
+   */
+  static inline int padded_stride(int iN);
+
+  /**
+   * @brief Geometrically increase the stride until it can hold lines of iN elements
+   * @param[in] iN Number of elements the lines must be able to hold
+   */
+  inline void grow_stride(int iN);
+
+  /**
+   * @brief Print a warning and stop (in debug builds) if the indexes are out of range
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   */
+  inline void check_range(int iJ, int iI)const;
+
+  /** @brief Print the array if T can be streamed */
+  inline void print(std::true_type);
+
+  /** @brief Print a warning because T can not be streamed */
+  inline void print(std::false_type);
+
+  /** @brief Dot product for the types with an operator * */
+  inline T dot_product(const Array2d& A, const Parallel_policy& iPolicy, std::true_type) const;
+
+  /** @brief Print a warning because the dot product is not defined for T */
+  inline T dot_product(const Array2d& A, const Parallel_policy& iPolicy, std::false_type) const;
+
+  /**
+   * @brief Copy iN elements (with memcpy for trivially copyable types)
+   * @param[in] iSrc Pointer on the first element to copy
+   * @param[out] oDst Pointer on the first destination element
+   * @param[in] iN Number of elements to copy
+   */
+  static inline void copy_elements(const T* iSrc, T* oDst, size_t iN);
+
+  /**
+   * @brief Apply a function on blocks of lines, the blocks being distributed among the threads
+   * @param[in] iF Function called as iF(begin, end) on the lines [begin, end)
+   * @param[in] iPolicy Parameters of the multithreading
+   */
+  template <class F>
+  inline void for_lines(F iF, const Parallel_policy& iPolicy)const;
+
+  /**
+   * @brief Reduce the array by blocks of lines, the blocks being distributed among the threads
+   * @param[in] iReduce Function called as iReduce(begin, end), returning the reduction of the
+   * lines [begin, end)
+   * @param[in] iCombine Function combining two partial reductions
+   * @param[in] iPolicy Parameters of the multithreading
+   * @return Reduction of the whole array
+   */
+  template <class F, class G>
+  inline T reduce_lines(F iReduce, G iCombine, const Parallel_policy& iPolicy)const;
+
+  std::vector<T, Alloc> _aT; /**< @brief Contiguous buffer containing the values, line after line */
+  int _nb_lines;      /**< @brief Number of lines (rows if row-major, columns otherwise) */
+  int _line_size;     /**< @brief Number of elements of a line */
+  int _stride;        /**< @brief Distance between the beginnings of two consecutive lines */
+
+};
+
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS  // Only Macro definitions for specialization of template
+
+/* Types for which Array2d<T>::print() is defined */
+template <class T> struct Array2d_printable : std::false_type {};
+
+#define ARRAY2D_PRINT(T)                                        \
+  template<> struct Array2d_printable<T> : std::true_type {};
+
+ARRAY2D_PRINT(char)
+ARRAY2D_PRINT(unsigned char)
+ARRAY2D_PRINT(int)
+ARRAY2D_PRINT(short int)
+ARRAY2D_PRINT(long int)
+ARRAY2D_PRINT(unsigned int)
+ARRAY2D_PRINT(unsigned short int)
+ARRAY2D_PRINT(unsigned long int)
+ARRAY2D_PRINT(float)
+ARRAY2D_PRINT(double)
+ARRAY2D_PRINT(long double)
+ARRAY2D_PRINT(std::string)
+
+/* Types for which Array2d<T>::dot_product() is defined */
+template <class T> struct Array2d_has_dot_product : std::false_type {};
+
+#define ARRAY2D_DOT_PRODUCT(T)                                          \
+  template<> struct Array2d_has_dot_product<T> : std::true_type {};
+
+ARRAY2D_DOT_PRODUCT(int)
+ARRAY2D_DOT_PRODUCT(short int)
+ARRAY2D_DOT_PRODUCT(long int)
+ARRAY2D_DOT_PRODUCT(unsigned int)
+ARRAY2D_DOT_PRODUCT(unsigned short int)
+ARRAY2D_DOT_PRODUCT(unsigned long int)
+ARRAY2D_DOT_PRODUCT(float)
+ARRAY2D_DOT_PRODUCT(double)
+ARRAY2D_DOT_PRODUCT(long double)
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+template <class U>
+inline Array2d_iterator<U>::Array2d_iterator()
+: _ptr(0),
+  _i(0),
+  _n(0),
+  _stride(0)
+{
+}
+
+template <class U>
+inline Array2d_iterator<U>::Array2d_iterator(U* iPtr, int iI, int iN, int iStride)
+: _ptr(iPtr),
+  _i(iI),
+  _n(iN),
+  _stride(iStride)
+{
+}
+
+template <class U>
+template <class V>
+inline Array2d_iterator<U>::Array2d_iterator(const Array2d_iterator<V>& iIt)
+: _ptr(iIt._ptr),
+  _i(iIt._i),
+  _n(iIt._n),
+  _stride(iIt._stride)
+{
+}
+
+template <class U>
+inline U& Array2d_iterator<U>::operator*() const
+{
+  return *_ptr;
+}
+
+template <class U>
+inline U* Array2d_iterator<U>::operator->() const
+{
+  return _ptr;
+}
+
+template <class U>
+inline Array2d_iterator<U>& Array2d_iterator<U>::operator++()
+{
+  ++_ptr;
+  if (++_i == _n) {
+    _ptr += _stride-_n;
+    _i = 0;
+  }
+  return *this;
+}
+
+template <class U>
+inline Array2d_iterator<U> Array2d_iterator<U>::operator++(int)
+{
+  Array2d_iterator<U> it(*this);
+  ++(*this);
+  return it;
+}
+
+template <class U>
+inline bool Array2d_iterator<U>::operator==(const Array2d_iterator& iIt) const
+{
+  return _ptr == iIt._ptr;
+}
+
+template <class U>
+inline bool Array2d_iterator<U>::operator!=(const Array2d_iterator& iIt) const
+{
+  return _ptr != iIt._ptr;
+}
+
+
+template <class T, class Layout, class Alloc>
+inline Array2d<T,Layout,Alloc>::Array2d(int iP, int iN, const Alloc& iAlloc)
+: _aT(iAlloc),
+  _nb_lines(0),
+  _line_size(0),
+  _stride(0)
+{
+  resize(iP, iN);
+}
+
+template <class T, class Layout, class Alloc>
+inline Array2d<T,Layout,Alloc>::Array2d(const Array2d & iArray2d)
+: _aT(std::allocator_traits<Alloc>::select_on_container_copy_construction(iArray2d._aT.get_allocator())),
+  _nb_lines(0),
+  _line_size(0),
+  _stride(0)
+{
+  copy(iArray2d);
+}
+
+template <class T, class Layout, class Alloc>
+inline Array2d<T,Layout,Alloc>::Array2d(const Array2d & iArray2d, const Alloc& iAlloc)
+: _aT(iAlloc),
+  _nb_lines(0),
+  _line_size(0),
+  _stride(0)
+{
+  copy(iArray2d);
+}
+
+template <class T, class Layout, class Alloc>
+inline Array2d<T,Layout,Alloc>::Array2d(Array2d && iArray2d) noexcept
+: _aT(std::move(iArray2d._aT)),
+  _nb_lines(iArray2d._nb_lines),
+  _line_size(iArray2d._line_size),
+  _stride(iArray2d._stride)
+{
+  iArray2d._aT.clear();
+  iArray2d._nb_lines = 0;
+  iArray2d._line_size = 0;
+  iArray2d._stride = 0;
+}
+
+template <class T, class Layout, class Alloc>
+inline Array2d<T,Layout,Alloc>::~Array2d()
+{
+}
+
+template <class T, class Layout, class Alloc>
+inline Array2d<T,Layout,Alloc>& Array2d<T,Layout,Alloc>::operator=(const Array2d & iArray2d)
+{
+  copy(iArray2d);
+  return *this;
+}
+
+template <class T, class Layout, class Alloc>
+inline Array2d<T,Layout,Alloc>& Array2d<T,Layout,Alloc>::operator=(Array2d && iArray2d)
+  noexcept(std::allocator_traits<Alloc>::propagate_on_container_move_assignment::value)
+{
+  if (&iArray2d != this) {
+    // The vector moves the elements one by one if the allocators differ and do not propagate
+    _aT = std::move(iArray2d._aT);
+    _nb_lines = iArray2d._nb_lines;
+    _line_size = iArray2d._line_size;
+    _stride = iArray2d._stride;
+    iArray2d._aT.clear();
+    iArray2d._nb_lines = 0;
+    iArray2d._line_size = 0;
+    iArray2d._stride = 0;
+  }
+  return *this;
+}
+
+template <class T, class Layout, class Alloc>
+template <class E>
+inline Array2d<T,Layout,Alloc>::Array2d(const Array2d_expr<E> & iExpr, const Alloc& iAlloc)
+: _aT(iAlloc),
+  _nb_lines(0),
+  _line_size(0),
+  _stride(0)
+{
+  assign(iExpr);
+}
+
+template <class T, class Layout, class Alloc>
+template <class E>
+inline Array2d<T,Layout,Alloc>& Array2d<T,Layout,Alloc>::operator=(const Array2d_expr<E> & iExpr)
+{
+  assign(iExpr);
+  return *this;
+}
+
+template <class T, class Layout, class Alloc>
+template <class E>
+inline void Array2d<T,Layout,Alloc>::assign(const Array2d_expr<E> & iExpr, const Parallel_policy& iPolicy)
+{
+  static_assert(std::is_same<typename E::layout_type, Layout>::value,
+                "The arrays of an expression must have the layout of the assigned array");
+  const E& expr = iExpr.self();
+  const int nb_rows = expr.nb_rows();
+  const int nb_columns = expr.nb_columns();
+  if (!expr.check_size(nb_rows, nb_columns)) {
+    std::cerr << "[ERROR] void Array2d<T>::assign(const Array2d_expr<E>&, const Parallel_policy&)" << std::endl
+              << "The arrays of the expression have not the same size." << std::endl;
+    assert(false);
+    return;
+  }
+  resize(nb_rows, nb_columns, T(), iPolicy);
+  for_lines([this, &expr](int iBegin, int iEnd) {
+      for (int k = iBegin; k < iEnd; k++) {
+        const typename E::Line line = expr.line(k);
+        T* dst = line_data(k);
+        for (int i = 0; i < _line_size; i++)
+          dst[i] = line[i];
+      }
+    }, iPolicy);
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::swap(Array2d & ioArray2d) noexcept
+{
+  _aT.swap(ioArray2d._aT);
+  std::swap(_nb_lines, ioArray2d._nb_lines);
+  std::swap(_line_size, ioArray2d._line_size);
+  std::swap(_stride, ioArray2d._stride);
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::copy(const Array2d& iArray2d, const Parallel_policy& iPolicy)
+{
+  if (&iArray2d == this)
+    return;
+  if (iArray2d._line_size == 0) {
+    clear();
+    _nb_lines = iArray2d._nb_lines;
+    return;
+  }
+  // vector::resize keeps the capacity: no allocation if the buffer is large enough
+  _stride = padded_stride(iArray2d._line_size);
+  _aT.resize((size_t)iArray2d._nb_lines*_stride);
+  _nb_lines = iArray2d._nb_lines;
+  _line_size = iArray2d._line_size;
+  for_lines([this, &iArray2d](int iBegin, int iEnd) {
+      if (iArray2d._stride == _stride)
+        copy_elements(iArray2d.line_data(iBegin), line_data(iBegin), (size_t)(iEnd-iBegin)*_stride);
+      else {
+        for (int k = iBegin; k < iEnd; k++)
+          copy_elements(iArray2d.line_data(k), line_data(k), _line_size);
+      }
+    }, iPolicy);
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::copy_elements(const T* iSrc, T* oDst, size_t iN)
+{
+  if (std::is_trivially_copyable<T>::value) {
+    if (iN > 0)
+      std::memcpy((void*)oDst, (const void*)iSrc, iN*sizeof(T));
+  }
+  else
+    std::copy(iSrc, iSrc+iN, oDst);
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::erase_column(int iI)
+{
+  if (0 <= iI && iI < nb_columns()) {
+    erase_columns(iI, iI+1);
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::erase_column(int)" << std::endl
+              << "Column index out of range. No column removed." << std::endl;
+    assert(false);
+  }
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::erase_columns(int iBegin, int iEnd)
+{
+  if (0 <= iBegin && iBegin <= iEnd && iEnd <= nb_columns()) {
+    if (Layout::is_row_major)
+      erase_in_lines(iBegin, iEnd);
+    else
+      erase_lines(iBegin, iEnd);
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::erase_columns(int,int)" << std::endl
+              << "Column index out of range. No columns removed." << std::endl;
+    assert(false);
+  }
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::erase_row(int iJ)
+{
+  if (0 <= iJ && iJ < nb_rows()) {
+    erase_rows(iJ, iJ+1);
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::erase_row(int)" << std::endl
+              << "Row index out of range. No row removed." << std::endl;
+    assert(false);
+  }
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::erase_rows(int iBegin, int iEnd)
+{
+  if (0 <= iBegin && iBegin <= iEnd && iEnd <= nb_rows()){
+    if (Layout::is_row_major)
+      erase_lines(iBegin, iEnd);
+    else
+      erase_in_lines(iBegin, iEnd);
+    if (nb_rows() == 0)
+      clear();
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::erase_rows(int,int)" << std::endl
+              << "Row index out of range. No rows removed." << std::endl;
+    assert(false);
+  }
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::insert_column(int iI, const std::vector<T> & iC)
+{
+  if (nb_rows()==0) {
+    clear();
+    (Layout::is_row_major ? _nb_lines : _line_size) = iC.size();
+  }
+  if (0 <= iI && iI <= nb_columns()) {
+    if (iC.size() == (unsigned int)nb_rows()) {
+      if (Layout::is_row_major)
+        insert_in_lines(iI, iC);
+      else
+        insert_line(iI, iC);
+    }
+    else {
+      std::cerr << "[WARNING] void Array2d<T>::insert_column(int, const std::vector<T>&)" << std::endl
+                << "New column size different from array column size. No column added." << std::endl;
+      assert(false);
+    }
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::insert_column(int, const std::vector<T>&)" << std::endl
+              << "Column index out of range. No column added." << std::endl;
+    assert(false);
+  }
+}
+
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::insert_row(int iJ, const std::vector<T> & iR)
+{
+  if (0 <= iJ && iJ <= nb_rows()) {
+    if (iR.size() == (unsigned int)nb_columns()) {
+      if (Layout::is_row_major)
+        insert_line(iJ, iR);
+      else
+        insert_in_lines(iJ, iR);
+    }
+    else {
+      std::cerr << "[WARNING] void Array2d<T>::insert_row(int, const std::vector<T>&)" << std::endl
+                << "New row size different from array row size. No row added." << std::endl;
+      assert(false);
+    }
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::insert_row(int, const std::vector<T>&)" << std::endl
+              << "Row index out of range. No row added." << std::endl;
+    assert(false);
+  }
+}
+
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::resize(int iP, int iN, T iVal, const Parallel_policy& iPolicy)
+{
+  if (iP <= 0 || iN < 0) {
+    clear();
+    return;
+  }
+  const int nb_lines = Layout::is_row_major ? iP : iN;
+  const int line_size = Layout::is_row_major ? iN : iP;
+  if (line_size > _stride)
+    set_stride(line_size);
+  if (nb_lines < _nb_lines) {
+    _aT.resize((size_t)nb_lines*_stride);
+    _nb_lines = nb_lines;
+  }
+  if (line_size > _line_size) {
+    for_lines([this, line_size, &iVal](int iBegin, int iEnd) {
+        for (int k = iBegin; k < iEnd; k++)
+          std::fill(line_data(k)+_line_size, line_data(k)+line_size, iVal);
+      }, iPolicy);
+  }
+  _aT.resize((size_t)nb_lines*_stride, iVal);
+  _nb_lines = nb_lines;
+  _line_size = line_size;
+}
+
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::clear()
+{
+  _aT.clear();
+  _nb_lines = 0;
+  _line_size = 0;
+  _stride = 0;
+}
+
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::push_back_column(const std::vector<T> & iC)
+{
+  if (nb_rows()==0) {
+    clear();
+    (Layout::is_row_major ? _nb_lines : _line_size) = iC.size();
+  }
+  if (iC.size() == (unsigned int)nb_rows()) {
+    if (Layout::is_row_major)
+      insert_in_lines(_line_size, iC);
+    else
+      insert_line(_nb_lines, iC);
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::push_back_column(const std::vector<T>&)" << std::endl
+              << "New column size different from array column size. No column added." << std::endl;
+    assert(false);
+  }
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::push_back_row(const std::vector<T> & iR)
+{
+  if (nb_rows()==0) {
+    clear();
+    (Layout::is_row_major ? _line_size : _nb_lines) = iR.size();
+  }
+  if (iR.size() == (unsigned int)nb_columns()) {
+    if (Layout::is_row_major)
+      insert_line(_nb_lines, iR);
+    else
+      insert_in_lines(_line_size, iR);
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::push_back_row(const std::vector<T>&)" << std::endl
+              << "New row size different from array row size. No row added." << std::endl;
+    assert(false);
+  }
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::swap_column(int i, int j)
+{
+  if (0 <= i && i < nb_columns() && 0 <= j && j < nb_columns()) {
+    for (int k = 0; k < nb_rows(); k++)
+      std::swap(unchecked(k,i), unchecked(k,j));
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::swap_column(int,int)" << std::endl
+              << "Column index out of range. No column swapped." << std::endl;
+    assert(false);
+  }
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::swap_row(int i, int j)
+{
+  if (0 <= i && i < nb_rows() && 0 <= j && j < nb_rows()) {
+    for (int k = 0; k < nb_columns(); k++)
+      std::swap(unchecked(i,k), unchecked(j,k));
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::swap_row(int,int)" << std::endl
+              << "Row index out of range. No row swapped." << std::endl;
+    assert(false);
+  }
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::erase_columns(const std::vector<int> & iColumns)
+{
+  std::vector<int> columns(iColumns);
+  if (sort_indexes(columns, nb_columns())) {
+    if (Layout::is_row_major)
+      erase_in_line_set(columns);
+    else
+      erase_line_set(columns);
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::erase_columns(const std::vector<int>&)" << std::endl
+              << "Column index out of range. No columns removed." << std::endl;
+    assert(false);
+  }
+}
 
-template <class T>
-inline void Array2d<T>::clear()
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::erase_rows(const std::vector<int> & iRows)
 {
-  _aT.clear();
+  std::vector<int> rows(iRows);
+  if (sort_indexes(rows, nb_rows())) {
+    if (Layout::is_row_major)
+      erase_line_set(rows);
+    else
+      erase_in_line_set(rows);
+    if (nb_rows() == 0)
+      clear();
+  }
+  else {
+    std::cerr << "[WARNING] void Array2d<T>::erase_rows(const std::vector<int>&)" << std::endl
+              << "Row index out of range. No rows removed." << std::endl;
+    assert(false);
+  }
 }
 
-
-template <class T>
-inline void Array2d<T>::push_back_column(const std::vector<T> & iC)
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::insert_columns(const std::vector<int> & iPositions, const std::vector< std::vector<T> > & iC)
 {
-  if (nb_rows()==0) {
-    _aT.assign(iC.size(), std::vector<T>());
-  }
-  if (iC.size() == (unsigned int)nb_rows()) {
-    for (int j = 0; j < nb_rows(); j++)
-      _aT[j].push_back(iC[j]);
+  std::vector<int> order;
+  if (sort_insertions(iPositions, iC, nb_columns(), nb_rows(), order)) {
+    if (Layout::is_row_major)
+      insert_in_line_set(iPositions, iC, order);
+    else
+      insert_line_set(iPositions, iC, order);
   }
   else {
-    std::cerr << "[WARNING] void Array2d<T>::push_back_column(const std::vector<T>&)" << std::endl
-              << "New column size different from array column size. No column added." << std::endl;
+    std::cerr << "[WARNING] void Array2d<T>::insert_columns(const std::vector<int>&, const std::vector<std::vector<T> >&)" << std::endl
+              << "Column index out of range or new column size different from array column size. No column added." << std::endl;
     assert(false);
   }
 }
 
-template <class T>
-inline void Array2d<T>::push_back_row(const std::vector<T> & iR)
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::insert_rows(const std::vector<int> & iPositions, const std::vector< std::vector<T> > & iR)
 {
-  if (nb_rows()==0 || iR.size() == (unsigned int)nb_columns()) {
-    _aT.push_back(iR);
+  std::vector<int> order;
+  if (sort_insertions(iPositions, iR, nb_rows(), nb_columns(), order)) {
+    if (Layout::is_row_major)
+      insert_line_set(iPositions, iR, order);
+    else
+      insert_in_line_set(iPositions, iR, order);
   }
   else {
-    std::cerr << "[WARNING] void Array2d<T>::push_back_row(const std::vector<T>&)" << std::endl
-              << "New row size different from array row size. No row added." << std::endl;
+    std::cerr << "[WARNING] void Array2d<T>::insert_rows(const std::vector<int>&, const std::vector<std::vector<T> >&)" << std::endl
+              << "Row index out of range or new row size different from array row size. No row added." << std::endl;
     assert(false);
   }
 }
 
-template <class T>
-inline void Array2d<T>::swap_column(int i, int j)
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::permute_columns(const std::vector<int> & iPermutation)
 {
-  if (0 <= i && i < nb_columns() && 0 <= j && j < nb_columns()) {
-    for (int k = 0; k < nb_rows(); k++)
-      std::swap(_aT[k][i], _aT[k][j]);
+  if (is_permutation(iPermutation, nb_columns())) {
+    if (Layout::is_row_major)
+      permute_in_lines(iPermutation);
+    else
+      permute_lines(iPermutation);
   }
   else {
-    std::cerr << "[WARNING] void Array2d<T>::swap_column(int,int)" << std::endl
-              << "Column index out of range. No column swapped." << std::endl;
+    std::cerr << "[WARNING] void Array2d<T>::permute_columns(const std::vector<int>&)" << std::endl
+              << "The argument is not a permutation of the columns. Array unchanged." << std::endl;
     assert(false);
   }
 }
 
-template <class T>
-inline void Array2d<T>::swap_row(int i, int j)
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::permute_rows(const std::vector<int> & iPermutation)
 {
-  if (0 <= i && i < nb_rows() && 0 <= j && j < nb_rows()) {
-    std::swap(_aT[i], _aT[j]);
+  if (is_permutation(iPermutation, nb_rows())) {
+    if (Layout::is_row_major)
+      permute_lines(iPermutation);
+    else
+      permute_in_lines(iPermutation);
   }
   else {
-    std::cerr << "[WARNING] void Array2d<T>::swap_row(int,int)" << std::endl
-              << "Row index out of range. No row swapped." << std::endl;
+    std::cerr << "[WARNING] void Array2d<T>::permute_rows(const std::vector<int>&)" << std::endl
+              << "The argument is not a permutation of the rows. Array unchanged." << std::endl;
     assert(false);
   }
 }
 
-template <class T>
-inline int Array2d<T>::nb_rows()
+template <class T, class Layout, class Alloc>
+inline Alloc Array2d<T,Layout,Alloc>::get_allocator() const
 {
-  return _aT.size();
+  return _aT.get_allocator();
 }
 
-template <class T>
-inline int Array2d<T>::nb_columns()
+template <class T, class Layout, class Alloc>
+inline int Array2d<T,Layout,Alloc>::nb_rows() const
 {
-  return (nb_rows() ? _aT[0].size() : 0);
+  return Layout::is_row_major ? _nb_lines : _line_size;
 }
 
-template <class T>
-inline T& Array2d<T>::operator()(int iJ, int iI)
+template <class T, class Layout, class Alloc>
+inline int Array2d<T,Layout,Alloc>::nb_columns() const
 {
-  if (0 <= iJ && iJ < nb_rows()) {
-    if (0 <= iI && iI < nb_columns()) {
-      return _aT[iJ][iI];
+  return Layout::is_row_major ? _line_size : _nb_lines;
+}
+
+template <class T, class Layout, class Alloc>
+inline T& Array2d<T,Layout,Alloc>::operator()(int iJ, int iI)
+{
+#ifndef NDEBUG
+  check_range(iJ, iI);
+#endif
+  return _aT[index(iJ, iI)];
+}
+
+template <class T, class Layout, class Alloc>
+inline const T& Array2d<T,Layout,Alloc>::operator()(int iJ, int iI)const
+{
+#ifndef NDEBUG
+  check_range(iJ, iI);
+#endif
+  return _aT[index(iJ, iI)];
+}
+
+template <class T, class Layout, class Alloc>
+inline T& Array2d<T,Layout,Alloc>::unchecked(int iJ, int iI)
+{
+  return _aT[index(iJ, iI)];
+}
+
+template <class T, class Layout, class Alloc>
+inline const T& Array2d<T,Layout,Alloc>::unchecked(int iJ, int iI)const
+{
+  return _aT[index(iJ, iI)];
+}
+
+template <class T, class Layout, class Alloc>
+inline int Array2d<T,Layout,Alloc>::nb_lines() const
+{
+  return _nb_lines;
+}
+
+template <class T, class Layout, class Alloc>
+inline int Array2d<T,Layout,Alloc>::line_size() const
+{
+  return _line_size;
+}
+
+template <class T, class Layout, class Alloc>
+inline int Array2d<T,Layout,Alloc>::stride() const
+{
+  return _stride;
+}
+
+template <class T, class Layout, class Alloc>
+inline T* Array2d<T,Layout,Alloc>::line_data(int iK)
+{
+  return _aT.data() + (ptrdiff_t)iK*_stride;
+}
+
+template <class T, class Layout, class Alloc>
+inline const T* Array2d<T,Layout,Alloc>::line_data(int iK)const
+{
+  return _aT.data() + (ptrdiff_t)iK*_stride;
+}
+
+template <class T, class Layout, class Alloc>
+inline T* Array2d<T,Layout,Alloc>::row_data(int iJ)
+{
+  static_assert(Layout::is_row_major, "Array2d::row_data() requires the row-major layout");
+  return line_data(iJ);
+}
+
+template <class T, class Layout, class Alloc>
+inline const T* Array2d<T,Layout,Alloc>::row_data(int iJ)const
+{
+  static_assert(Layout::is_row_major, "Array2d::row_data() requires the row-major layout");
+  return line_data(iJ);
+}
+
+template <class T, class Layout, class Alloc>
+inline T* Array2d<T,Layout,Alloc>::row_begin(int iJ)
+{
+  return row_data(iJ);
+}
+
+template <class T, class Layout, class Alloc>
+inline const T* Array2d<T,Layout,Alloc>::row_begin(int iJ)const
+{
+  return row_data(iJ);
+}
+
+template <class T, class Layout, class Alloc>
+inline T* Array2d<T,Layout,Alloc>::row_end(int iJ)
+{
+  return row_data(iJ) + _line_size;
+}
+
+template <class T, class Layout, class Alloc>
+inline const T* Array2d<T,Layout,Alloc>::row_end(int iJ)const
+{
+  return row_data(iJ) + _line_size;
+}
+
+template <class T, class Layout, class Alloc>
+inline T* Array2d<T,Layout,Alloc>::column_data(int iI)
+{
+  static_assert(!Layout::is_row_major, "Array2d::column_data() requires the column-major layout");
+  return line_data(iI);
+}
+
+template <class T, class Layout, class Alloc>
+inline const T* Array2d<T,Layout,Alloc>::column_data(int iI)const
+{
+  static_assert(!Layout::is_row_major, "Array2d::column_data() requires the column-major layout");
+  return line_data(iI);
+}
+
+template <class T, class Layout, class Alloc>
+inline typename Array2d<T,Layout,Alloc>::iterator Array2d<T,Layout,Alloc>::begin()
+{
+  return iterator(_line_size ? _aT.data() : _aT.data()+(ptrdiff_t)_nb_lines*_stride, 0, _line_size, _stride);
+}
+
+template <class T, class Layout, class Alloc>
+inline typename Array2d<T,Layout,Alloc>::const_iterator Array2d<T,Layout,Alloc>::begin()const
+{
+  return const_iterator(_line_size ? _aT.data() : _aT.data()+(ptrdiff_t)_nb_lines*_stride, 0, _line_size, _stride);
+}
+
+template <class T, class Layout, class Alloc>
+inline typename Array2d<T,Layout,Alloc>::iterator Array2d<T,Layout,Alloc>::end()
+{
+  return iterator(_aT.data()+(ptrdiff_t)_nb_lines*_stride, 0, _line_size, _stride);
+}
+
+template <class T, class Layout, class Alloc>
+inline typename Array2d<T,Layout,Alloc>::const_iterator Array2d<T,Layout,Alloc>::end()const
+{
+  return const_iterator(_aT.data()+(ptrdiff_t)_nb_lines*_stride, 0, _line_size, _stride);
+}
+
+template <class T, class Layout, class Alloc>
+inline ptrdiff_t Array2d<T,Layout,Alloc>::index(int iJ, int iI) const
+{
+  return Layout::is_row_major ? (ptrdiff_t)iJ*_stride+iI : (ptrdiff_t)iI*_stride+iJ;
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::insert_line(int iK, const std::vector<T> & iL)
+{
+  if (_stride < _line_size)
+    set_stride(_line_size);
+  typename std::vector<T, Alloc>::iterator line = _aT.insert(_aT.begin()+(ptrdiff_t)iK*_stride, _stride, T());
+  std::copy(iL.begin(), iL.end(), line);
+  _nb_lines++;
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::erase_lines(int iBegin, int iEnd)
+{
+  _aT.erase(_aT.begin()+(ptrdiff_t)iBegin*_stride, _aT.begin()+(ptrdiff_t)iEnd*_stride);
+  _nb_lines -= iEnd-iBegin;
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::insert_in_lines(int iI, const std::vector<T> & iV)
+{
+  grow_stride(_line_size+1);
+  for (int k = 0; k < _nb_lines; k++) {
+    T* line = line_data(k);
+    std::copy_backward(line+iI, line+_line_size, line+_line_size+1);
+    line[iI] = iV[k];
+  }
+  _line_size++;
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::erase_in_lines(int iBegin, int iEnd)
+{
+  for (int k = 0; k < _nb_lines; k++) {
+    T* line = line_data(k);
+    std::copy(line+iEnd, line+_line_size, line+iBegin);
+  }
+  _line_size -= iEnd-iBegin;
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::erase_line_set(const std::vector<int> & iK)
+{
+  if (iK.empty())
+    return;
+  // The kept lines are moved down in a single pass
+  int w = iK[0];
+  size_t e = 0;
+  for (int k = iK[0]; k < _nb_lines; k++) {
+    if (e < iK.size() && iK[e] == k) {
+      e++;
+      continue;
     }
-    else {
-      std::cerr << "[WARNING] void Array2d<T>::operator()(int,int)" << std::endl
-                << "Column index out of range." << std::endl;
-      assert(false);
+    copy_elements(line_data(k), line_data(w), _line_size);
+    w++;
+  }
+  _aT.erase(_aT.begin()+(ptrdiff_t)w*_stride, _aT.end());
+  _nb_lines = w;
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::erase_in_line_set(const std::vector<int> & iK)
+{
+  if (iK.empty())
+    return;
+  const int nb_erased = iK.size();
+  for (int k = 0; k < _nb_lines; k++) {
+    T* line = line_data(k);
+    T* w = line + iK[0];
+    for (int e = 0; e < nb_erased; e++) {
+      const int end = e+1 < nb_erased ? iK[e+1] : _line_size;
+      w = std::copy(line+iK[e]+1, line+end, w);
     }
   }
-  else {
-    std::cerr << "[WARNING] void Array2d<T>::operator()(int,int)" << std::endl
-              << "Row index out of range." << std::endl;
-    assert(false);
+  _line_size -= nb_erased;
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::insert_line_set(const std::vector<int> & iK, const std::vector< std::vector<T> > & iL,
+                                                     const std::vector<int> & iOrder)
+{
+  if (iOrder.empty())
+    return;
+  if (_stride < _line_size)
+    set_stride(_line_size);
+  const int nb_inserted = iOrder.size();
+  _aT.resize((size_t)(_nb_lines+nb_inserted)*_stride);
+  // From the end, each line is moved once, after the new lines inserted before it
+  int src = _nb_lines;
+  for (int r = nb_inserted-1; r >= 0; r--) {
+    const int pos = iK[iOrder[r]];
+    for (int k = src-1; k >= pos; k--)
+      copy_elements(line_data(k), line_data(k+r+1), _line_size);
+    std::copy(iL[iOrder[r]].begin(), iL[iOrder[r]].end(), line_data(pos+r));
+    src = pos;
   }
-  return _aT[0][0];
+  _nb_lines += nb_inserted;
 }
 
-template <class T>
-inline const T& Array2d<T>::operator()(int iJ, int iI)const
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::insert_in_line_set(const std::vector<int> & iK, const std::vector< std::vector<T> > & iV,
+                                                        const std::vector<int> & iOrder)
 {
-  if (0 <= iJ && iJ < nb_rows()) {
-    if (0 <= iI && iI < nb_columns()) {
-      return _aT[iJ][iI];
+  if (iOrder.empty())
+    return;
+  const int nb_inserted = iOrder.size();
+  grow_stride(_line_size+nb_inserted);
+  for (int k = 0; k < _nb_lines; k++) {
+    T* line = line_data(k);
+    int src = _line_size;
+    for (int r = nb_inserted-1; r >= 0; r--) {
+      const int pos = iK[iOrder[r]];
+      std::copy_backward(line+pos, line+src, line+src+r+1);
+      line[pos+r] = iV[iOrder[r]][k];
+      src = pos;
     }
-    else {
-      std::cerr << "[WARNING] void Array2d<T>::operator()(int,int)" << std::endl
-                << "Column index out of range." << std::endl;
-      assert(false);
+  }
+  _line_size += nb_inserted;
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::permute_lines(const std::vector<int> & iPermutation)
+{
+  std::vector<char> is_done(_nb_lines, false);
+  std::vector<T> tmp(_line_size);
+  for (int k = 0; k < _nb_lines; k++) {
+    if (is_done[k] || iPermutation[k] == k)
+      continue;
+    // Follow the cycle of k with a single temporary line
+    std::copy(line_data(k), line_data(k)+_line_size, tmp.begin());
+    int j = k;
+    while (iPermutation[j] != k) {
+      copy_elements(line_data(iPermutation[j]), line_data(j), _line_size);
+      is_done[j] = true;
+      j = iPermutation[j];
     }
+    std::copy(tmp.begin(), tmp.end(), line_data(j));
+    is_done[j] = true;
   }
-  else {
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::permute_in_lines(const std::vector<int> & iPermutation)
+{
+  std::vector<T> tmp(_line_size);
+  for (int k = 0; k < _nb_lines; k++) {
+    T* line = line_data(k);
+    for (int i = 0; i < _line_size; i++)
+      tmp[i] = line[iPermutation[i]];
+    std::copy(tmp.begin(), tmp.end(), line);
+  }
+}
+
+template <class T, class Layout, class Alloc>
+inline bool Array2d<T,Layout,Alloc>::sort_indexes(std::vector<int> & ioK, int iN)
+{
+  std::sort(ioK.begin(), ioK.end());
+  ioK.erase(std::unique(ioK.begin(), ioK.end()), ioK.end());
+  return ioK.empty() || (ioK.front() >= 0 && ioK.back() < iN);
+}
+
+template <class T, class Layout, class Alloc>
+inline bool Array2d<T,Layout,Alloc>::sort_insertions(const std::vector<int> & iK, const std::vector< std::vector<T> > & iV,
+                                                     int iNbMax, int iSize, std::vector<int> & oOrder)
+{
+  if (iK.size() != iV.size())
+    return false;
+  oOrder.resize(iK.size());
+  for (size_t r = 0; r < iK.size(); r++) {
+    if (iK[r] < 0 || iK[r] > iNbMax || iV[r].size() != (size_t)iSize)
+      return false;
+    oOrder[r] = r;
+  }
+  std::stable_sort(oOrder.begin(), oOrder.end(), [&iK](int a, int b) { return iK[a] < iK[b]; });
+  return true;
+}
+
+template <class T, class Layout, class Alloc>
+inline bool Array2d<T,Layout,Alloc>::is_permutation(const std::vector<int> & iPermutation, int iN)
+{
+  if (iPermutation.size() != (size_t)iN)
+    return false;
+  std::vector<char> is_used(iN, false);
+  for (int k = 0; k < iN; k++) {
+    if (iPermutation[k] < 0 || iPermutation[k] >= iN || is_used[iPermutation[k]])
+      return false;
+    is_used[iPermutation[k]] = true;
+  }
+  return true;
+}
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::check_range(int iJ, int iI)const
+{
+  if (iJ < 0 || iJ >= nb_rows()) {
     std::cerr << "[WARNING] void Array2d<T>::operator()(int,int)" << std::endl
               << "Row index out of range." << std::endl;
     assert(false);
   }
-  return _aT[0][0];
+  else if (iI < 0 || iI >= nb_columns()) {
+    std::cerr << "[WARNING] void Array2d<T>::operator()(int,int)" << std::endl
+              << "Column index out of range." << std::endl;
+    assert(false);
+  }
 }
 
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::set_stride(int iStride)
+{
+  iStride = padded_stride(iStride);
+  const int nb_copied = std::min(_line_size, iStride);
+  std::vector<T, Alloc> aT((size_t)_nb_lines*iStride, T(), _aT.get_allocator());
+  for (int k = 0; k < _nb_lines; k++)
+    std::copy(_aT.begin()+(ptrdiff_t)k*_stride, _aT.begin()+(ptrdiff_t)k*_stride+nb_copied, aT.begin()+(ptrdiff_t)k*iStride);
+  _aT.swap(aT);
+  _stride = iStride;
+}
 
-template <class T>
-inline void Array2d<T>::print()
+template <class T, class Layout, class Alloc>
+inline int Array2d<T,Layout,Alloc>::padded_stride(int iN)
 {
-  std::cerr << "[WARNING] void Array2d<T>::print()" << std::endl
-            << "The function is not specialized for this type." << std::endl;
+  const int alignment = Allocator_alignment<Alloc>::value;
+  const int padding = (alignment > (int)sizeof(T) && alignment % sizeof(T) == 0) ? alignment / sizeof(T) : 1;
+  return (iN + padding - 1) / padding * padding;
 }
 
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::grow_stride(int iN)
+{
+  if (iN > _stride)
+    set_stride(std::max(iN, 2*_stride));
+}
 
 
-#ifndef DOXYGEN_SHOULD_SKIP_THIS  // Only Macro definitions for specialization of template
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::print()
+{
+  print(Array2d_printable<T>());
+}
 
-#define ARRAY2D_PRINT(T)                        \
-  template<>                                    \
-  inline void Array2d<T>::print()               \
-  {                                             \
-    for (int i = 0; i < nb_rows(); i++) {       \
-      for (int j = 0; j < nb_columns(); j++)    \
-        std::cout << (*this)(i,j) << "\t";      \
-      std::cout << std::endl;                   \
-    }                                           \
-  }                     
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::print(std::true_type)
+{
+  for (int i = 0; i < nb_rows(); i++) {
+    for (int j = 0; j < nb_columns(); j++)
+      std::cout << unchecked(i,j) << "\t";
+    std::cout << '\n';  // No flush for each row
+  }
+  std::cout.flush();
+}
 
-ARRAY2D_PRINT(char)
-ARRAY2D_PRINT(unsigned char)
-ARRAY2D_PRINT(int)
-ARRAY2D_PRINT(short int)
-ARRAY2D_PRINT(long int)
-ARRAY2D_PRINT(unsigned int)
-ARRAY2D_PRINT(unsigned short int)
-ARRAY2D_PRINT(unsigned long int)
-ARRAY2D_PRINT(float)
-ARRAY2D_PRINT(double)
-ARRAY2D_PRINT(long double)
-ARRAY2D_PRINT(std::string)
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::print(std::false_type)
+{
+  std::cerr << "[WARNING] void Array2d<T>::print()" << std::endl
+            << "The function is not specialized for this type." << std::endl;
+}
 
-#endif // DOXYGEN_SHOULD_SKIP_THIS
 
+template <class T, class Layout, class Alloc>
+inline T Array2d<T,Layout,Alloc>::dot_product(const Array2d& A, const Parallel_policy& iPolicy) const
+{
+  return dot_product(A, iPolicy, Array2d_has_dot_product<T>());
+}
 
+template <class T, class Layout, class Alloc>
+inline T Array2d<T,Layout,Alloc>::dot_product(const Array2d& A, const Parallel_policy& iPolicy, std::true_type) const
+{
+  if (nb_columns() != A.nb_columns() || nb_rows() != A.nb_rows()) {
+    std::cerr << "[ERROR] T Array2d<T>::dot_product(const Array2d<T>& A)" << std::endl
+              << "The two array have not the same same size." << std::endl;
+    return 0;
+  }
+  return reduce_lines([this, &A](int iBegin, int iEnd) -> T {
+      if (_stride == _line_size && A._stride == _line_size)
+        return Simd_kernels<T>::dot(line_data(iBegin), A.line_data(iBegin), (size_t)(iEnd-iBegin)*_line_size);
+      T dot_prod = 0;
+      for (int k = iBegin; k < iEnd; k++)
+        dot_prod += Simd_kernels<T>::dot(line_data(k), A.line_data(k), _line_size);
+      return dot_prod;
+    },
+    [](T a, T b) -> T { return a + b; },
+    iPolicy);
+}
 
-template <class T>
-inline T Array2d<T>::dot_product(Array2d<T>& A)
+template <class T, class Layout, class Alloc>
+inline T Array2d<T,Layout,Alloc>::dot_product(const Array2d&, const Parallel_policy&, std::false_type) const
 {
   std::cerr << "[WARNING] T Array2d<T>::dot_product(const Array2d<T>&)" << std::endl
             << "The function is not specialized for this type." << std::endl;
+  return T();
 }
 
 
-#ifndef DOXYGEN_SHOULD_SKIP_THIS  // Only Macro definitions for specialization of template
+template <class T, class Layout, class Alloc>
+inline T Array2d<T,Layout,Alloc>::sum(const Parallel_policy& iPolicy) const
+{
+  return reduce_lines([this](int iBegin, int iEnd) -> T {
+      if (_stride == _line_size)
+        return Simd_kernels<T>::sum(line_data(iBegin), (size_t)(iEnd-iBegin)*_line_size);
+      T s = T();
+      for (int k = iBegin; k < iEnd; k++)
+        s += Simd_kernels<T>::sum(line_data(k), _line_size);
+      return s;
+    },
+    [](const T& a, const T& b) -> T { return a + b; },
+    iPolicy);
+}
 
-#define ARRAY2D_DOT_PRODUCT(T)                                          \
-  template<>                                                            \
-  inline T Array2d<T>::dot_product(Array2d<T>& A)                       \
-  {                                                                     \
-    T dot_prod = 0;                                                     \
-    if (nb_columns() != A.nb_columns() || nb_rows() != A.nb_rows()) {   \
-      std::cerr << "[ERROR] T Array2d<T>::dot_product(const Array2d<T>& A)" << std::endl \
-                << "The two array have not the same same size." << std::endl; \
-    }                                                                   \
-    else {                                                              \
-      for (int i = 0; i < nb_rows(); i++) {                             \
-        for (int j = 0; j < nb_columns(); j++) {                        \
-          dot_prod += ( (*this)(i,j) * A(i,j) );                        \
-        }                                                               \
-      }                                                                 \
-    }                                                                   \
-    return dot_prod;                                                    \
+
+template <class T, class Layout, class Alloc>
+inline T Array2d<T,Layout,Alloc>::min(const Parallel_policy& iPolicy) const
+{
+  if (_nb_lines == 0 || _line_size == 0) {
+    std::cerr << "[WARNING] T Array2d<T>::min()" << std::endl
+              << "The array is empty." << std::endl;
+    assert(false);
+    return T();
   }
+  return reduce_lines([this](int iBegin, int iEnd) -> T {
+      if (_stride == _line_size)
+        return Simd_kernels<T>::min(line_data(iBegin), (size_t)(iEnd-iBegin)*_line_size);
+      T m = Simd_kernels<T>::min(line_data(iBegin), _line_size);
+      for (int k = iBegin+1; k < iEnd; k++)
+        m = std::min(m, Simd_kernels<T>::min(line_data(k), _line_size));
+      return m;
+    },
+    [](const T& a, const T& b) -> T { return std::min(a, b); },
+    iPolicy);
+}
 
-ARRAY2D_DOT_PRODUCT(int)
-ARRAY2D_DOT_PRODUCT(short int)
-ARRAY2D_DOT_PRODUCT(long int)
-ARRAY2D_DOT_PRODUCT(unsigned int)
-ARRAY2D_DOT_PRODUCT(unsigned short int)
-ARRAY2D_DOT_PRODUCT(unsigned long int)
-ARRAY2D_DOT_PRODUCT(float)
-ARRAY2D_DOT_PRODUCT(double)
-ARRAY2D_DOT_PRODUCT(long double)
 
-#endif // DOXYGEN_SHOULD_SKIP_THIS
+template <class T, class Layout, class Alloc>
+inline T Array2d<T,Layout,Alloc>::max(const Parallel_policy& iPolicy) const
+{
+  if (_nb_lines == 0 || _line_size == 0) {
+    std::cerr << "[WARNING] T Array2d<T>::max()" << std::endl
+              << "The array is empty." << std::endl;
+    assert(false);
+    return T();
+  }
+  return reduce_lines([this](int iBegin, int iEnd) -> T {
+      if (_stride == _line_size)
+        return Simd_kernels<T>::max(line_data(iBegin), (size_t)(iEnd-iBegin)*_line_size);
+      T m = Simd_kernels<T>::max(line_data(iBegin), _line_size);
+      for (int k = iBegin+1; k < iEnd; k++)
+        m = std::max(m, Simd_kernels<T>::max(line_data(k), _line_size));
+      return m;
+    },
+    [](const T& a, const T& b) -> T { return std::max(a, b); },
+    iPolicy);
+}
 
 
-#endif // ARRAY2D_H
+template <class T, class Layout, class Alloc>
+inline T Array2d<T,Layout,Alloc>::norm2(const Parallel_policy& iPolicy) const
+{
+  return reduce_lines([this](int iBegin, int iEnd) -> T {
+      if (_stride == _line_size)
+        return Simd_kernels<T>::norm2(line_data(iBegin), (size_t)(iEnd-iBegin)*_line_size);
+      T s = T();
+      for (int k = iBegin; k < iEnd; k++)
+        s += Simd_kernels<T>::norm2(line_data(k), _line_size);
+      return s;
+    },
+    [](const T& a, const T& b) -> T { return a + b; },
+    iPolicy);
+}
+
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::axpy(T iA, const Array2d& iX, const Parallel_policy& iPolicy)
+{
+  if (_nb_lines != iX._nb_lines || _line_size != iX._line_size) {
+    std::cerr << "[WARNING] void Array2d<T>::axpy(T, const Array2d<T>&)" << std::endl
+              << "The two array have not the same same size." << std::endl;
+    assert(false);
+    return;
+  }
+  for_lines([this, iA, &iX](int iBegin, int iEnd) {
+      if (_stride == _line_size && iX._stride == _line_size)
+        Simd_kernels<T>::axpy(iA, iX.line_data(iBegin), line_data(iBegin), (size_t)(iEnd-iBegin)*_line_size);
+      else {
+        for (int k = iBegin; k < iEnd; k++)
+          Simd_kernels<T>::axpy(iA, iX.line_data(k), line_data(k), _line_size);
+      }
+    }, iPolicy);
+}
+
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::fill(const T& iVal, const Parallel_policy& iPolicy)
+{
+  for_lines([this, &iVal](int iBegin, int iEnd) {
+      for (int k = iBegin; k < iEnd; k++)
+        std::fill(line_data(k), line_data(k)+_line_size, iVal);
+    }, iPolicy);
+}
+
+
+template <class T, class Layout, class Alloc>
+template <class F>
+inline void Array2d<T,Layout,Alloc>::transform(F iF, const Parallel_policy& iPolicy)
+{
+  for_lines([this, &iF](int iBegin, int iEnd) {
+      for (int k = iBegin; k < iEnd; k++) {
+        T* line = line_data(k);
+        for (int i = 0; i < _line_size; i++)
+          line[i] = iF(line[i]);
+      }
+    }, iPolicy);
+}
+
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::transpose(Array2d& oT, const Parallel_policy& iPolicy) const
+{
+  if (&oT == this) {
+    oT.transpose_in_place(iPolicy);
+    return;
+  }
+  oT.resize(nb_columns(), nb_rows(), T(), iPolicy);
+  // The line iI of oT contains the elements iI of the lines of this array
+  oT.for_lines([this, &oT](int iBegin, int iEnd) {
+      for (int ib = iBegin; ib < iEnd; ib += TILE_SIZE) {
+        const int ie = std::min(iEnd, ib+TILE_SIZE);
+        for (int kb = 0; kb < _nb_lines; kb += TILE_SIZE) {
+          const int ke = std::min(_nb_lines, kb+TILE_SIZE);
+          for (int i = ib; i < ie; i++) {
+            T* dst = oT.line_data(i);
+            const T* src = line_data(0) + i;
+            for (int k = kb; k < ke; k++)
+              dst[k] = src[(ptrdiff_t)k*_stride];
+          }
+        }
+      }
+    }, iPolicy);
+}
+
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::transpose_in_place(const Parallel_policy& iPolicy)
+{
+  if (_nb_lines != _line_size) {
+    Array2d T_array(0, 0, _aT.get_allocator());
+    transpose(T_array, iPolicy);
+    swap(T_array);
+    return;
+  }
+  // Swap the tile (kb,ib) with the tile (ib,kb), for ib >= kb
+  const int nb_tiles = (_nb_lines + TILE_SIZE - 1) / TILE_SIZE;
+  const int tiles_per_block = iPolicy.items_per_block((long)TILE_SIZE*_line_size);
+  const int nb_blocks = (nb_tiles + tiles_per_block - 1) / tiles_per_block;
+  PARALLEL_TOOLS_OMP(parallel for schedule(dynamic) num_threads(iPolicy.get_nb_threads()) if(nb_blocks > 1))
+  for (int b = 0; b < nb_blocks; b++) {
+    for (int t = b*tiles_per_block; t < std::min(nb_tiles, (b+1)*tiles_per_block); t++) {
+      const int kb = t*TILE_SIZE;
+      const int ke = std::min(_nb_lines, kb+TILE_SIZE);
+      for (int ib = kb; ib < _line_size; ib += TILE_SIZE) {
+        const int ie = std::min(_line_size, ib+TILE_SIZE);
+        for (int k = kb; k < ke; k++) {
+          T* line = line_data(k);
+          for (int i = (ib == kb ? k+1 : ib); i < ie; i++)
+            std::swap(line[i], _aT[(ptrdiff_t)i*_stride+k]);
+        }
+      }
+    }
+  }
+}
+
+
+template <class T, class Layout, class Alloc>
+inline void Array2d<T,Layout,Alloc>::multiply(const Array2d& iB, Array2d& oC, const Parallel_policy& iPolicy) const
+{
+  if (nb_columns() != iB.nb_rows()) {
+    std::cerr << "[ERROR] void Array2d<T>::multiply(const Array2d<T>&, Array2d<T>&)" << std::endl
+              << "The number of columns of the array is not the number of rows of B." << std::endl;
+    assert(false);
+    return;
+  }
+  if (&oC == this || &oC == &iB) {
+    Array2d C(0, 0, oC._aT.get_allocator());
+    multiply(iB, C, iPolicy);
+    oC.swap(C);
+    return;
+  }
+  oC.resize(nb_rows(), iB.nb_columns(), T(), iPolicy);
+  oC.fill(T(), iPolicy);
+  // Row-major: row i of C += A(i,k) * row k of B.
+  // Column-major: column j of C += B(k,j) * column k of A.
+  const Array2d& X = Layout::is_row_major ? *this : iB;
+  const Array2d& Y = Layout::is_row_major ? iB : *this;
+  const int inner = X._line_size;
+  oC.for_lines([&X, &Y, &oC, inner](int iBegin, int iEnd) {
+      for (int kb = 0; kb < inner; kb += TILE_SIZE) {
+        const int ke = std::min(inner, kb+TILE_SIZE);
+        for (int jb = 0; jb < oC._line_size; jb += 4*TILE_SIZE) {
+          const int len = std::min(oC._line_size-jb, 4*TILE_SIZE);
+          for (int i = iBegin; i < iEnd; i++) {
+            const T* x = X.line_data(i);
+            T* c = oC.line_data(i) + jb;
+            for (int k = kb; k < ke; k++)
+              Simd_kernels<T>::axpy(x[k], Y.line_data(k) + jb, c, len);
+          }
+        }
+      }
+    }, iPolicy);
+}
 
+
+template <class T, class Layout, class Alloc>
+template <class F>
+inline void Array2d<T,Layout,Alloc>::for_lines(F iF, const Parallel_policy& iPolicy)const
+{
+  const int lines_per_block = iPolicy.items_per_block(_line_size);
+  const int nb_blocks = (_nb_lines + lines_per_block - 1) / lines_per_block;
+  if (nb_blocks <= 1) {
+    iF(0, _nb_lines);
+    return;
+  }
+  PARALLEL_TOOLS_OMP(parallel for schedule(static) num_threads(iPolicy.get_nb_threads()))
+  for (int b = 0; b < nb_blocks; b++)
+    iF(b*lines_per_block, std::min(_nb_lines, (b+1)*lines_per_block));
+}
+
+
+template <class T, class Layout, class Alloc>
+template <class F, class G>
+inline T Array2d<T,Layout,Alloc>::reduce_lines(F iReduce, G iCombine, const Parallel_policy& iPolicy)const
+{
+  const int lines_per_block = iPolicy.items_per_block(_line_size);
+  const int nb_blocks = (_nb_lines + lines_per_block - 1) / lines_per_block;
+  if (nb_blocks <= 1)
+    return iReduce(0, _nb_lines);
+
+  if (iPolicy.is_deterministic()) {
+    // The blocks only depend on the grain size and are combined in order
+    std::vector<T> partial(nb_blocks);
+    PARALLEL_TOOLS_OMP(parallel for schedule(static) num_threads(iPolicy.get_nb_threads()))
+    for (int b = 0; b < nb_blocks; b++)
+      partial[b] = iReduce(b*lines_per_block, std::min(_nb_lines, (b+1)*lines_per_block));
+    T result = partial[0];
+    for (int b = 1; b < nb_blocks; b++)
+      result = iCombine(result, partial[b]);
+    return result;
+  }
+
+  // Each thread reduces its blocks, then the threads are combined in any order
+  T result = T();
+  bool is_first = true;
+  PARALLEL_TOOLS_OMP(parallel num_threads(iPolicy.get_nb_threads()))
+  {
+    T local = T();
+    bool is_local_first = true;
+    PARALLEL_TOOLS_OMP(for schedule(dynamic) nowait)
+    for (int b = 0; b < nb_blocks; b++) {
+      T value = iReduce(b*lines_per_block, std::min(_nb_lines, (b+1)*lines_per_block));
+      local = is_local_first ? value : iCombine(local, value);
+      is_local_first = false;
+    }
+    PARALLEL_TOOLS_OMP(critical)
+    if (!is_local_first) {
+      result = is_first ? local : iCombine(result, local);
+      is_first = false;
+    }
+  }
+  return result;
+}
+
+
+#endif // ARRAY2D_H
@@ -0,0 +1,282 @@
+/**
+ * @file array2d_expr.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Element-wise arithmetic on #Array2d with expression templates.
+ * @details The operators +, -, * and / between arrays (element by element) and between arrays
+ * and scalars do not compute anything: they build a light object describing the expression.
+ * The expression is evaluated when it is assigned to an #Array2d, in a single pass over the
+ * elements, without temporary arrays:
+ * @code{cpp}
+ * #include "array2d_expr.h"
+ *
+ * Array2d<double> A(100,100), B(100,100), D(100,100);
+ * Array2d<double> C;
+ * C = 2.*A + B - D;   // One loop, no intermediate array
+ * @endcode
+ * All the arrays of an expression must have the same size and the same layout.
+ */
+
+
+#ifndef ARRAY2D_EXPR_H
+#define ARRAY2D_EXPR_H
+
+#include <functional>
+#include <type_traits>
+
+#include "array2d.h"
+
+
+/** @brief Base class of all the expressions (used to recognize them) */
+struct Array2d_expr_base
+{
+};
+
+
+/**
+ * @brief Base class of the expressions (curiously recurring template pattern)
+ * @details An expression E defines:
+ * - the types value_type (type of the elements) and layout_type (#Row_major or #Column_major),
+ * - nb_rows() and nb_columns() (-1 for a scalar, which has any size),
+ * - check_size(p, n), which returns true if all the arrays of the expression are p x n,
+ * - the type Line and line(k), which returns an object whose operator[](i) evaluates the
+ * element i of the storage line k.
+ */
+template <class E>
+class Array2d_expr : public Array2d_expr_base
+{
+ public:
+  /** @brief Return the expression as its real type */
+  inline const E& self() const { return static_cast<const E&>(*this); }
+
+  /** @brief Return the number of rows of the expression */
+  inline int nb_rows() const { return self().nb_rows(); }
+
+  /** @brief Return the number of columns of the expression */
+  inline int nb_columns() const { return self().nb_columns(); }
+};
+
+
+/** @brief Expression made of an #Array2d (which is referenced, not copied) */
+template <class T, class Layout, class Alloc>
+class Array2d_ref_expr : public Array2d_expr< Array2d_ref_expr<T,Layout,Alloc> >
+{
+ public:
+  typedef T value_type;       /**< @brief Type of the elements */
+  typedef Layout layout_type; /**< @brief Layout of the arrays */
+  typedef const T* Line;      /**< @brief Evaluation of a line */
+
+  /** @brief Constructor */
+  inline explicit Array2d_ref_expr(const Array2d<T,Layout,Alloc>& iArray2d) : _array2d(iArray2d) {}
+
+  /** @brief Return the number of rows */
+  inline int nb_rows() const { return _array2d.nb_rows(); }
+
+  /** @brief Return the number of columns */
+  inline int nb_columns() const { return _array2d.nb_columns(); }
+
+  /** @brief Return true if the array is iP x iN */
+  inline bool check_size(int iP, int iN) const { return nb_rows() == iP && nb_columns() == iN; }
+
+  /** @brief Return the line iK */
+  inline Line line(int iK) const { return _array2d.line_data(iK); }
+
+ protected:
+  const Array2d<T,Layout,Alloc>& _array2d; /**< @brief Referenced array */
+};
+
+
+/** @brief Expression made of a scalar, which has the same value for all the elements */
+template <class T, class Layout>
+class Array2d_scalar_expr : public Array2d_expr< Array2d_scalar_expr<T,Layout> >
+{
+ public:
+  typedef T value_type;       /**< @brief Type of the elements */
+  typedef Layout layout_type; /**< @brief Layout of the arrays */
+
+  /** @brief Evaluation of a line: the scalar for all the elements */
+  struct Line
+  {
+    T _value; /**< @brief Value of the scalar */
+    /** @brief Return the scalar */
+    inline const T& operator[](int) const { return _value; }
+  };
+
+  /** @brief Constructor */
+  inline explicit Array2d_scalar_expr(const T& iValue) : _value(iValue) {}
+
+  /** @brief Return -1 (any number of rows) */
+  inline int nb_rows() const { return -1; }
+
+  /** @brief Return -1 (any number of columns) */
+  inline int nb_columns() const { return -1; }
+
+  /** @brief Return true (a scalar has any size) */
+  inline bool check_size(int, int) const { return true; }
+
+  /** @brief Return the line iK */
+  inline Line line(int) const { Line l = { _value }; return l; }
+
+ protected:
+  T _value; /**< @brief Value of the scalar */
+};
+
+
+/** @brief Expression applying a binary operator element by element */
+template <class Op, class L, class R>
+class Array2d_binary_expr : public Array2d_expr< Array2d_binary_expr<Op,L,R> >
+{
+ public:
+  typedef typename L::value_type value_type;   /**< @brief Type of the elements */
+  typedef typename L::layout_type layout_type; /**< @brief Layout of the arrays */
+
+  static_assert(std::is_same<typename L::layout_type, typename R::layout_type>::value,
+                "The arrays of an expression must have the same layout");
+
+  /** @brief Evaluation of a line */
+  struct Line
+  {
+    typename L::Line _l; /**< @brief Line of the left operand */
+    typename R::Line _r; /**< @brief Line of the right operand */
+    /** @brief Return the element iI of the line */
+    inline value_type operator[](int iI) const { return Op()(_l[iI], _r[iI]); }
+  };
+
+  /** @brief Constructor */
+  inline Array2d_binary_expr(const L& iL, const R& iR) : _l(iL), _r(iR) {}
+
+  /** @brief Return the number of rows */
+  inline int nb_rows() const { return _l.nb_rows() >= 0 ? _l.nb_rows() : _r.nb_rows(); }
+
+  /** @brief Return the number of columns */
+  inline int nb_columns() const { return _l.nb_columns() >= 0 ? _l.nb_columns() : _r.nb_columns(); }
+
+  /** @brief Return true if all the arrays of the expression are iP x iN */
+  inline bool check_size(int iP, int iN) const { return _l.check_size(iP, iN) && _r.check_size(iP, iN); }
+
+  /** @brief Return the line iK */
+  inline Line line(int iK) const { Line l = { _l.line(iK), _r.line(iK) }; return l; }
+
+ protected:
+  L _l; /**< @brief Left operand */
+  R _r; /**< @brief Right operand */
+};
+
+
+/** @brief Expression applying the opposite element by element */
+template <class E>
+class Array2d_negate_expr : public Array2d_expr< Array2d_negate_expr<E> >
+{
+ public:
+  typedef typename E::value_type value_type;   /**< @brief Type of the elements */
+  typedef typename E::layout_type layout_type; /**< @brief Layout of the arrays */
+
+  /** @brief Evaluation of a line */
+  struct Line
+  {
+    typename E::Line _e; /**< @brief Line of the operand */
+    /** @brief Return the element iI of the line */
+    inline value_type operator[](int iI) const { return -_e[iI]; }
+  };
+
+  /** @brief Constructor */
+  inline explicit Array2d_negate_expr(const E& iE) : _e(iE) {}
+
+  /** @brief Return the number of rows */
+  inline int nb_rows() const { return _e.nb_rows(); }
+
+  /** @brief Return the number of columns */
+  inline int nb_columns() const { return _e.nb_columns(); }
+
+  /** @brief Return true if all the arrays of the expression are iP x iN */
+  inline bool check_size(int iP, int iN) const { return _e.check_size(iP, iN); }
+
+  /** @brief Return the line iK */
+  inline Line line(int iK) const { Line l = { _e.line(iK) }; return l; }
+
+ protected:
+  E _e; /**< @brief Operand */
+};
+
+
+/**
+ * @brief Conversion of the operands of the operators to expressions
+ * @details Defined for #Array2d (referenced by an #Array2d_ref_expr) and for the expressions
+ * (copied). The operators are not defined for the other types.
+ */
+template <class X, class Enable = void>
+struct Array2d_operand
+{
+};
+
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+template <class T, class Layout, class Alloc>
+struct Array2d_operand< Array2d<T,Layout,Alloc> >
+{
+  typedef Array2d_ref_expr<T,Layout,Alloc> type;
+  static inline type make(const Array2d<T,Layout,Alloc>& iX) { return type(iX); }
+};
+
+template <class X>
+struct Array2d_operand<X, typename std::enable_if<std::is_base_of<Array2d_expr_base, X>::value>::type>
+{
+  typedef X type;
+  static inline const X& make(const X& iX) { return iX; }
+};
+
+
+// Operators between two arrays or expressions, and between an array or expression and a scalar
+#define ARRAY2D_EXPR_OPERATOR(OP, FUNCTOR)                                                      \
+  template <class A, class B>                                                                   \
+  inline Array2d_binary_expr<FUNCTOR<typename Array2d_operand<A>::type::value_type>,            \
+                             typename Array2d_operand<A>::type, typename Array2d_operand<B>::type> \
+  operator OP(const A& iA, const B& iB)                                                         \
+  {                                                                                             \
+    return Array2d_binary_expr<FUNCTOR<typename Array2d_operand<A>::type::value_type>,          \
+                               typename Array2d_operand<A>::type, typename Array2d_operand<B>::type> \
+      (Array2d_operand<A>::make(iA), Array2d_operand<B>::make(iB));                             \
+  }                                                                                             \
+                                                                                                \
+  template <class A>                                                                            \
+  inline Array2d_binary_expr<FUNCTOR<typename Array2d_operand<A>::type::value_type>,            \
+                             typename Array2d_operand<A>::type,                                 \
+                             Array2d_scalar_expr<typename Array2d_operand<A>::type::value_type, \
+                                                 typename Array2d_operand<A>::type::layout_type> > \
+  operator OP(const A& iA, const typename Array2d_operand<A>::type::value_type& iS)            \
+  {                                                                                             \
+    typedef typename Array2d_operand<A>::type E;                                                \
+    return Array2d_binary_expr<FUNCTOR<typename E::value_type>, E,                              \
+                               Array2d_scalar_expr<typename E::value_type, typename E::layout_type> > \
+      (Array2d_operand<A>::make(iA), Array2d_scalar_expr<typename E::value_type, typename E::layout_type>(iS)); \
+  }                                                                                             \
+                                                                                                \
+  template <class B>                                                                            \
+  inline Array2d_binary_expr<FUNCTOR<typename Array2d_operand<B>::type::value_type>,            \
+                             Array2d_scalar_expr<typename Array2d_operand<B>::type::value_type, \
+                                                 typename Array2d_operand<B>::type::layout_type>, \
+                             typename Array2d_operand<B>::type>                                 \
+  operator OP(const typename Array2d_operand<B>::type::value_type& iS, const B& iB)            \
+  {                                                                                             \
+    typedef typename Array2d_operand<B>::type E;                                                \
+    return Array2d_binary_expr<FUNCTOR<typename E::value_type>,                                 \
+                               Array2d_scalar_expr<typename E::value_type, typename E::layout_type>, E> \
+      (Array2d_scalar_expr<typename E::value_type, typename E::layout_type>(iS), Array2d_operand<B>::make(iB)); \
+  }
+
+ARRAY2D_EXPR_OPERATOR(+, std::plus)
+ARRAY2D_EXPR_OPERATOR(-, std::minus)
+ARRAY2D_EXPR_OPERATOR(*, std::multiplies)
+ARRAY2D_EXPR_OPERATOR(/, std::divides)
+
+template <class A>
+inline Array2d_negate_expr<typename Array2d_operand<A>::type> operator-(const A& iA)
+{
+  return Array2d_negate_expr<typename Array2d_operand<A>::type>(Array2d_operand<A>::make(iA));
+}
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+
+#endif // ARRAY2D_EXPR_H
@@ -0,0 +1,907 @@
+/**
+ * @file array2d_io.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Binary persistence of #Array2d and read-only memory-mapped arrays.
+ * @details The tools are:
+ * - save_array2d() writes an array in a binary file.
+ * - load_array2d() reads a binary file in an array.
+ * - #Array2d_mapped maps a binary file in memory and gives a read-only access to its elements
+ * without copying them.
+ * - write_array2d_text() writes an array in a text file (TSV, CSV, ...).
+ * - read_array2d_text() reads a text file in an array.
+ *
+ * The binary file is made of a header of 64 bytes (see #Array2d_file_header) followed by the
+ * elements, line after line in the layout of the saved array, without gap between the lines.
+ * The files are portable between platforms with the same endianness and the same size of T.
+ */
+
+
+#ifndef ARRAY2D_IO_H
+#define ARRAY2D_IO_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "array2d.h"
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+#ifndef ARRAY2D_IO_CHUNK_SIZE
+/** @brief Size in bytes of the chunks read and written by the text functions */
+#define ARRAY2D_IO_CHUNK_SIZE (1 << 20)
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define ARRAY2D_IO_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+/**
+ * @brief Tag identifying the type of the elements in the binary files
+ * @details The tag is 0 for the types which can not be saved. It is defined for the arithmetic
+ * types: char, signed char, unsigned char, short int, unsigned short int, int, unsigned int,
+ * long int, unsigned long int, long long int, unsigned long long int, float, double and long
+ * double.
+ */
+template <class T> struct Array2d_type_tag { enum { value = 0 }; };
+
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS  // Only Macro definitions for specialization of template
+
+#define ARRAY2D_TYPE_TAG(T, TAG)                                        \
+  template<> struct Array2d_type_tag<T> { enum { value = TAG }; };
+
+ARRAY2D_TYPE_TAG(char, 1)
+ARRAY2D_TYPE_TAG(signed char, 2)
+ARRAY2D_TYPE_TAG(unsigned char, 3)
+ARRAY2D_TYPE_TAG(short int, 4)
+ARRAY2D_TYPE_TAG(unsigned short int, 5)
+ARRAY2D_TYPE_TAG(int, 6)
+ARRAY2D_TYPE_TAG(unsigned int, 7)
+ARRAY2D_TYPE_TAG(long int, 8)
+ARRAY2D_TYPE_TAG(unsigned long int, 9)
+ARRAY2D_TYPE_TAG(long long int, 10)
+ARRAY2D_TYPE_TAG(unsigned long long int, 11)
+ARRAY2D_TYPE_TAG(float, 12)
+ARRAY2D_TYPE_TAG(double, 13)
+ARRAY2D_TYPE_TAG(long double, 14)
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief Header of the binary files of #Array2d (64 bytes)
+ * @details The elements follow the header, so that they are aligned on 64 bytes in a mapped
+ * file.
+ */
+struct Array2d_file_header
+{
+  char magic[8];         /**< @brief "ARRAY2D" followed by a null character */
+  uint32_t version;      /**< @brief Version of the format (currently 1) */
+  uint32_t endianness;   /**< @brief 0x01020304 written in the byte order of the writer */
+  uint32_t type_tag;     /**< @brief Type of the elements (see #Array2d_type_tag) */
+  uint32_t element_size; /**< @brief Size in bytes of an element */
+  uint32_t row_major;    /**< @brief 1 if the elements are stored row after row, 0 otherwise */
+  uint32_t reserved;     /**< @brief Unused (0) */
+  int64_t nb_rows;       /**< @brief Number of rows */
+  int64_t nb_columns;    /**< @brief Number of columns */
+  char padding[16];      /**< @brief Unused (0) */
+
+  /**
+   * @brief Fill the header for an array of T
+   * @param[in] iNbRows Number of rows
+   * @param[in] iNbColumns Number of columns
+   * @param[in] iRowMajor True if the elements are stored row after row
+   */
+  template <class T>
+  inline void set(int64_t iNbRows, int64_t iNbColumns, bool iRowMajor);
+
+  /**
+   * @brief Check that the header describes an array of T
+   * @param[in] iFileName Name of the file (for the error messages)
+   * @return True if the header is valid, false otherwise (an error message is printed)
+   */
+  template <class T>
+  inline bool check(const std::string& iFileName) const;
+
+  /**
+   * @brief Return the size in bytes of the elements following the header
+   * @warning The header must be valid (see check()), so that the size does not overflow
+   */
+  inline int64_t data_size() const;
+};
+
+
+/**
+ * @brief Write an array in a binary file
+ * @param[in] iArray2d Array to save
+ * @param[in] iFileName Name of the file (it is overwritten)
+ * @return True if the file was written, false otherwise (an error message is printed)
+ */
+template <class T, class Layout, class Alloc>
+inline bool save_array2d(const Array2d<T,Layout,Alloc>& iArray2d, const std::string& iFileName);
+
+/**
+ * @brief Read an array from a binary file written by save_array2d()
+ * @details The file can have been written from an array with another layout.
+ * @param[out] oArray2d Array resized and filled with the elements of the file
+ * @param[in] iFileName Name of the file
+ * @return True if the file was read, false otherwise (an error message is printed and the
+ * array is cleared)
+ */
+template <class T, class Layout, class Alloc>
+inline bool load_array2d(Array2d<T,Layout,Alloc>& oArray2d, const std::string& iFileName);
+
+
+/**
+ * @brief Write an array in a text stream, a row per line
+ * @details The elements are formatted in a buffer (with std::to_chars if available), which is
+ * written in the stream by chunks of #ARRAY2D_IO_CHUNK_SIZE bytes. The stream is not flushed.
+ * The floating point numbers are written with enough digits to be read back exactly.
+ * @param[in] iArray2d Array to write (T must be an arithmetic type)
+ * @param[out] oStream Output stream
+ * @param[in] iSeparator Separator of the elements of a row ('\t' for TSV, ',' for CSV)
+ * @return True if the array was written, false otherwise
+ */
+template <class T, class Layout, class Alloc>
+inline bool write_array2d_text(const Array2d<T,Layout,Alloc>& iArray2d, std::ostream& oStream, char iSeparator = '\t');
+
+/**
+ * @brief Write an array in a text file, a row per line
+ * @param[in] iArray2d Array to write (T must be an arithmetic type)
+ * @param[in] iFileName Name of the file (it is overwritten)
+ * @param[in] iSeparator Separator of the elements of a row ('\t' for TSV, ',' for CSV)
+ * @return True if the file was written, false otherwise (an error message is printed)
+ */
+template <class T, class Layout, class Alloc>
+inline bool write_array2d_text(const Array2d<T,Layout,Alloc>& iArray2d, const std::string& iFileName, char iSeparator = '\t');
+
+/**
+ * @brief Read an array from a text stream, a row per line
+ * @details The stream is read by chunks of #ARRAY2D_IO_CHUNK_SIZE bytes, and the elements are
+ * parsed in place (with std::from_chars if available). The empty lines are ignored, the spaces
+ * around the elements and the carriage returns at the end of the lines are allowed. All the
+ * rows must have the same number of elements. Each row is written in the array as soon as its
+ * line is parsed (the number of rows of the array is doubled when it is full).
+ * @param[out] oArray2d Array resized and filled with the elements (T must be an arithmetic
+ * type)
+ * @param[in] iStream Input stream
+ * @param[in] iSeparator Separator of the elements of a row ('\t' for TSV, ',' for CSV)
+ * @return True if the array was read, false otherwise: invalid element, rows of different sizes
+ * or error of the stream (an error message is printed and the array is cleared)
+ */
+template <class T, class Layout, class Alloc>
+inline bool read_array2d_text(Array2d<T,Layout,Alloc>& oArray2d, std::istream& iStream, char iSeparator = '\t');
+
+/**
+ * @brief Read an array from a text file, a row per line (see read_array2d_text(Array2d&, std::istream&, char))
+ * @param[out] oArray2d Array resized and filled with the elements
+ * @param[in] iFileName Name of the file
+ * @param[in] iSeparator Separator of the elements of a row ('\t' for TSV, ',' for CSV)
+ * @return True if the file was read, false otherwise (an error message is printed)
+ */
+template <class T, class Layout, class Alloc>
+inline bool read_array2d_text(Array2d<T,Layout,Alloc>& oArray2d, const std::string& iFileName, char iSeparator = '\t');
+
+
+/**
+ * @brief Conversion between the arithmetic types and their text representation
+ * @details std::to_chars and std::from_chars are used if the standard library provides them
+ * (C++17), otherwise snprintf and strtoll / strtoull / strtold.
+ */
+template <class T>
+struct Array2d_text
+{
+  /** @brief Maximal number of characters written by write() */
+  enum { MAX_LENGTH = 64 };
+
+  /**
+   * @brief Write a value
+   * @param[out] oFirst Beginning of the output buffer (at least MAX_LENGTH characters)
+   * @param[in] iValue Value to write
+   * @return Pointer past the last written character
+   */
+  static inline char* write(char* oFirst, const T& iValue);
+
+  /**
+   * @brief Parse a value
+   * @param[in] iFirst Beginning of the text
+   * @param[in] iLast End of the text
+   * @param[out] oValue Parsed value
+   * @return True if the whole text is a valid value
+   */
+  static inline bool read(const char* iFirst, const char* iLast, T& oValue);
+};
+
+
+/**
+ * @brief Read-only array whose elements are mapped from a binary file written by
+ * save_array2d()
+ * @details The elements are not copied: the pages of the file are loaded by the system when
+ * they are accessed, and they are shared between the processes mapping the same file. The
+ * layout of the file must be Layout.
+ *
+ * On the platforms without mmap, the elements are read in a buffer.
+ *
+ * A minimal example is given by the following code:
+ * @code{cpp}
+ * Array2d<double> grid(1000, 1000);
+ * save_array2d(grid, "grid.bin");
+ *
+ * Array2d_mapped<double> mapped;
+ * if (mapped.open("grid.bin"))
+ *   std::cout << mapped(10, 20) << std::endl;
+ * @endcode
+ */
+template <class T, class Layout = Row_major>
+class Array2d_mapped
+{
+ public:
+  /** @brief Constructor of a closed array */
+  inline Array2d_mapped();
+
+  /**
+   * @brief Constructor mapping a file (see open())
+   * @param[in] iFileName Name of the file
+   */
+  inline Array2d_mapped(const std::string& iFileName);
+
+  /**
+   * @brief Move constructor
+   * @param[in] iMapped Mapped array whose mapping is taken (it is left closed)
+   */
+  inline Array2d_mapped(Array2d_mapped&& iMapped) noexcept;
+
+  /** @brief Destructor (unmap the file) */
+  inline ~Array2d_mapped();
+
+  /**
+   * @brief Move assignment
+   * @param[in] iMapped Mapped array whose mapping is taken (it is left closed)
+   */
+  inline Array2d_mapped& operator=(Array2d_mapped&& iMapped) noexcept;
+
+  /**
+   * @brief Map a binary file
+   * @param[in] iFileName Name of the file
+   * @return True if the file was mapped, false otherwise (an error message is printed)
+   */
+  inline bool open(const std::string& iFileName);
+
+  /** @brief Unmap the file */
+  inline void close();
+
+  /** @brief Return true if a file is mapped */
+  inline bool is_open() const;
+
+  /** @brief Return the number of rows of the array */
+  inline int nb_rows() const;
+
+  /** @brief Return the number of columns of the array */
+  inline int nb_columns() const;
+
+  /** @brief Return the number of lines of the storage (rows if row-major, columns otherwise) */
+  inline int nb_lines() const;
+
+  /** @brief Return the number of elements of a line of the storage */
+  inline int line_size() const;
+
+  /**
+   * @brief Read access to coefficients of the array
+   * @details The indexes are checked only in debug builds (that is, if NDEBUG is not defined).
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   */
+  inline const T& operator()(int iJ, int iI) const;
+
+  /**
+   * @brief Read access to coefficients of the array without bounds checking
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   */
+  inline const T& unchecked(int iJ, int iI) const;
+
+  /**
+   * @brief Return a pointer on the first element of a line of the storage
+   * @param[in] iK Index of the line
+   */
+  inline const T* line_data(int iK) const;
+
+  /** @brief Return a pointer on the first element (the lines are contiguous) */
+  inline const T* data() const;
+
+  /**
+   * @brief Copy the elements in an array
+   * @param[out] oArray2d Array resized and filled with the elements
+   */
+  template <class Alloc>
+  inline void copy_to(Array2d<T,Layout,Alloc>& oArray2d) const;
+
+ protected:
+  Array2d_mapped(const Array2d_mapped&);            // Not copyable
+  Array2d_mapped& operator=(const Array2d_mapped&); // Not copyable
+
+  /** @brief Return the position of the element (iJ,iI) from the first element */
+  inline size_t index(int iJ, int iI) const;
+
+  void* _map;            /**< @brief Beginning of the mapped file (or of the buffer) */
+  size_t _map_size;      /**< @brief Size in bytes of the mapped file */
+  const T* _data;        /**< @brief First element */
+  int _nb_lines;         /**< @brief Number of lines (rows if row-major, columns otherwise) */
+  int _line_size;        /**< @brief Number of elements of a line */
+  std::vector<char> _buffer; /**< @brief Content of the file if mmap is not available */
+};
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+
+static_assert(sizeof(Array2d_file_header) == 64, "The header of the array files must have 64 bytes");
+
+
+template <class T>
+inline void Array2d_file_header::set(int64_t iNbRows, int64_t iNbColumns, bool iRowMajor)
+{
+  std::memset(this, 0, sizeof(Array2d_file_header));
+  std::memcpy(magic, "ARRAY2D", 8);
+  version = 1;
+  endianness = 0x01020304;
+  type_tag = Array2d_type_tag<T>::value;
+  element_size = sizeof(T);
+  row_major = iRowMajor ? 1 : 0;
+  nb_rows = iNbRows;
+  nb_columns = iNbColumns;
+}
+
+
+template <class T>
+inline bool Array2d_file_header::check(const std::string& iFileName) const
+{
+  std::string error;
+  if (std::memcmp(magic, "ARRAY2D", 8) != 0)
+    error = "The file is not an array file.";
+  else if (version != 1)
+    error = "Unknown version of the file format.";
+  else if (endianness != 0x01020304)
+    error = "The file was written with another endianness.";
+  else if (type_tag != (uint32_t)Array2d_type_tag<T>::value || element_size != sizeof(T))
+    error = "The type of the elements of the file is not the type of the array.";
+  else if (nb_rows < 0 || nb_columns < 0 || nb_rows > std::numeric_limits<int>::max()
+           || nb_columns > std::numeric_limits<int>::max())
+    error = "Invalid size of the array.";
+  else if (nb_columns > 0 && nb_rows > std::numeric_limits<int64_t>::max() / element_size / nb_columns)
+    error = "The size of the array is too large.";
+  if (error.empty())
+    return true;
+  std::cerr << "[ERROR] Array2d_file_header::check(const std::string&)" << std::endl
+            << iFileName << ": " << error << std::endl;
+  return false;
+}
+
+
+inline int64_t Array2d_file_header::data_size() const
+{
+  return nb_rows * nb_columns * element_size;
+}
+
+
+template <class T, class Layout, class Alloc>
+inline bool save_array2d(const Array2d<T,Layout,Alloc>& iArray2d, const std::string& iFileName)
+{
+  static_assert(Array2d_type_tag<T>::value != 0, "save_array2d() requires an arithmetic type");
+  std::ofstream file(iFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file) {
+    std::cerr << "[ERROR] bool save_array2d(const Array2d<T>&, const std::string&)" << std::endl
+              << "Impossible to open the file " << iFileName << std::endl;
+    return false;
+  }
+  Array2d_file_header header;
+  header.set<T>(iArray2d.nb_rows(), iArray2d.nb_columns(), Layout::is_row_major);
+  file.write((const char*)&header, sizeof(header));
+  for (int k = 0; k < iArray2d.nb_lines(); k++)
+    file.write((const char*)iArray2d.line_data(k), iArray2d.line_size()*sizeof(T));
+  if (!file) {
+    std::cerr << "[ERROR] bool save_array2d(const Array2d<T>&, const std::string&)" << std::endl
+              << "Impossible to write the file " << iFileName << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+template <class T, class Layout, class Alloc>
+inline bool load_array2d(Array2d<T,Layout,Alloc>& oArray2d, const std::string& iFileName)
+{
+  static_assert(Array2d_type_tag<T>::value != 0, "load_array2d() requires an arithmetic type");
+  oArray2d.clear();
+  std::ifstream file(iFileName.c_str(), std::ios::in | std::ios::binary);
+  if (!file) {
+    std::cerr << "[ERROR] bool load_array2d(Array2d<T>&, const std::string&)" << std::endl
+              << "Impossible to open the file " << iFileName << std::endl;
+    return false;
+  }
+  Array2d_file_header header;
+  if (!file.read((char*)&header, sizeof(header))) {
+    std::cerr << "[ERROR] bool load_array2d(Array2d<T>&, const std::string&)" << std::endl
+              << iFileName << ": The file is too short." << std::endl;
+    return false;
+  }
+  if (!header.check<T>(iFileName))
+    return false;
+
+  // Check the length of the file before allocating the array
+  const std::streamoff data_begin = file.tellg();
+  file.seekg(0, std::ios::end);
+  const std::streamoff data_end = file.tellg();
+  file.seekg(data_begin);
+  if (!file || data_end - data_begin < header.data_size()) {
+    std::cerr << "[ERROR] bool load_array2d(Array2d<T>&, const std::string&)" << std::endl
+              << iFileName << ": The file is too short." << std::endl;
+    return false;
+  }
+
+  oArray2d.resize((int)header.nb_rows, (int)header.nb_columns);
+  if (header.row_major == (Layout::is_row_major ? 1u : 0u)) {
+    for (int k = 0; k < oArray2d.nb_lines() && file; k++)
+      file.read((char*)oArray2d.line_data(k), oArray2d.line_size()*sizeof(T));
+  }
+  else {
+    // The lines of the file are the other dimension of the array
+    const int nb_file_lines = oArray2d.line_size();
+    std::vector<T> line(oArray2d.nb_lines());
+    for (int k = 0; k < nb_file_lines && file; k++) {
+      file.read((char*)line.data(), line.size()*sizeof(T));
+      for (int i = 0; i < (int)line.size(); i++)
+        oArray2d.line_data(i)[k] = line[i];
+    }
+  }
+  if (!file) {
+    std::cerr << "[ERROR] bool load_array2d(Array2d<T>&, const std::string&)" << std::endl
+              << iFileName << ": The file is too short." << std::endl;
+    oArray2d.clear();
+    return false;
+  }
+  return true;
+}
+
+
+template <class T>
+inline char* Array2d_text<T>::write(char* oFirst, const T& iValue)
+{
+#ifdef __cpp_lib_to_chars
+  return std::to_chars(oFirst, oFirst + MAX_LENGTH, iValue).ptr;
+#else
+  int n;
+  if (std::is_floating_point<T>::value)
+    n = snprintf(oFirst, MAX_LENGTH, "%.*Lg", std::numeric_limits<T>::max_digits10, (long double)iValue);
+  else if (std::is_signed<T>::value)
+    n = snprintf(oFirst, MAX_LENGTH, "%lld", (long long)iValue);
+  else
+    n = snprintf(oFirst, MAX_LENGTH, "%llu", (unsigned long long)iValue);
+  return oFirst + n;
+#endif
+}
+
+
+template <class T>
+inline bool Array2d_text<T>::read(const char* iFirst, const char* iLast, T& oValue)
+{
+  if (iFirst != iLast && *iFirst == '+')
+    ++iFirst;
+#ifdef __cpp_lib_to_chars
+  std::from_chars_result result = std::from_chars(iFirst, iLast, oValue);
+  return result.ec == std::errc() && result.ptr == iLast;
+#else
+  // strtoll and strtold need a null-terminated string
+  char field[MAX_LENGTH];
+  if (iFirst == iLast || iLast - iFirst >= MAX_LENGTH)
+    return false;
+  std::memcpy(field, iFirst, iLast - iFirst);
+  field[iLast - iFirst] = '\0';
+  char* end;
+  if (std::is_floating_point<T>::value)
+    oValue = (T)strtold(field, &end);
+  else if (std::is_signed<T>::value)
+    oValue = (T)strtoll(field, &end, 10);
+  else
+    oValue = (T)strtoull(field, &end, 10);
+  return end == field + (iLast - iFirst);
+#endif
+}
+
+
+template <class T, class Layout, class Alloc>
+inline bool write_array2d_text(const Array2d<T,Layout,Alloc>& iArray2d, std::ostream& oStream, char iSeparator)
+{
+  static_assert(std::is_arithmetic<T>::value, "write_array2d_text() requires an arithmetic type");
+  std::vector<char> buffer(ARRAY2D_IO_CHUNK_SIZE + Array2d_text<T>::MAX_LENGTH + 1);
+  char* const first = buffer.data();
+  char* current = first;
+  for (int j = 0; j < iArray2d.nb_rows(); j++) {
+    for (int i = 0; i < iArray2d.nb_columns(); i++) {
+      current = Array2d_text<T>::write(current, iArray2d.unchecked(j,i));
+      *current++ = (i+1 < iArray2d.nb_columns()) ? iSeparator : '\n';
+      if (current - first >= ARRAY2D_IO_CHUNK_SIZE) {
+        oStream.write(first, current - first);
+        current = first;
+      }
+    }
+  }
+  oStream.write(first, current - first);
+  return (bool)oStream;
+}
+
+
+template <class T, class Layout, class Alloc>
+inline bool write_array2d_text(const Array2d<T,Layout,Alloc>& iArray2d, const std::string& iFileName, char iSeparator)
+{
+  std::ofstream file(iFileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file || !write_array2d_text(iArray2d, file, iSeparator)) {
+    std::cerr << "[ERROR] bool write_array2d_text(const Array2d<T>&, const std::string&, char)" << std::endl
+              << "Impossible to write the file " << iFileName << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+template <class T, class Layout, class Alloc>
+inline bool read_array2d_text(Array2d<T,Layout,Alloc>& oArray2d, std::istream& iStream, char iSeparator)
+{
+  static_assert(std::is_arithmetic<T>::value, "read_array2d_text() requires an arithmetic type");
+  oArray2d.clear();
+  std::vector<T> row;  // Elements of the current line
+  int nb_rows = 0;
+  int nb_columns = -1;
+  long line_number = 0;
+  std::vector<char> buffer(ARRAY2D_IO_CHUNK_SIZE);
+  size_t nb_kept = 0;  // Characters of an incomplete line kept from the previous chunk
+  bool is_end = false;
+  while (!is_end) {
+    if (nb_kept == buffer.size())
+      buffer.resize(2*buffer.size());  // Line longer than a chunk
+    iStream.read(buffer.data() + nb_kept, buffer.size() - nb_kept);
+    if (iStream.bad()) {
+      std::cerr << "[ERROR] bool read_array2d_text(Array2d<T>&, std::istream&, char)" << std::endl
+                << "Error while reading the stream after line " << line_number << "." << std::endl;
+      oArray2d.clear();
+      return false;
+    }
+    const size_t nb_chars = nb_kept + iStream.gcount();
+    is_end = !iStream;
+    const char* first = buffer.data();
+    const char* last = first + nb_chars;
+    if (!is_end) {
+      // Only parse the complete lines
+      while (last != first && last[-1] != '\n')
+        --last;
+      if (last == first) {
+        nb_kept = nb_chars;
+        continue;
+      }
+    }
+
+    while (first != last) {
+      const char* end_of_line = std::find(first, last, '\n');
+      const char* next_line = end_of_line == last ? last : end_of_line + 1;
+      line_number++;
+      if (end_of_line != first && end_of_line[-1] == '\r')
+        --end_of_line;
+      if (end_of_line == first) {
+        first = next_line;
+        continue;
+      }
+      row.clear();
+      for (const char* field = first; ; ) {
+        const char* end_of_field = std::find(field, end_of_line, iSeparator);
+        const char* begin = field;
+        const char* end = end_of_field;
+        while (begin != end && *begin == ' ')
+          ++begin;
+        while (end != begin && end[-1] == ' ')
+          --end;
+        T value;
+        if (!Array2d_text<T>::read(begin, end, value)) {
+          std::cerr << "[ERROR] bool read_array2d_text(Array2d<T>&, std::istream&, char)" << std::endl
+                    << "Invalid element \"" << std::string(begin, end) << "\" at line "
+                    << line_number << "." << std::endl;
+          oArray2d.clear();
+          return false;
+        }
+        row.push_back(value);
+        if (end_of_field == end_of_line)
+          break;
+        field = end_of_field + 1;
+      }
+      if (nb_columns < 0)
+        nb_columns = (int)row.size();
+      else if ((int)row.size() != nb_columns) {
+        std::cerr << "[ERROR] bool read_array2d_text(Array2d<T>&, std::istream&, char)" << std::endl
+                  << "Line " << line_number << " has " << row.size() << " elements instead of "
+                  << nb_columns << "." << std::endl;
+        oArray2d.clear();
+        return false;
+      }
+      // The rows are added by blocks, doubling the number of rows of the array
+      if (nb_rows == oArray2d.nb_rows())
+        oArray2d.resize(std::max(2*nb_rows, 16), nb_columns);
+      for (int i = 0; i < nb_columns; i++)
+        oArray2d.unchecked(nb_rows, i) = row[i];
+      nb_rows++;
+      first = next_line;
+    }
+
+    nb_kept = buffer.data() + nb_chars - last;
+    std::memmove(buffer.data(), last, nb_kept);
+  }
+
+  oArray2d.resize(nb_rows, nb_columns);
+  return true;
+}
+
+
+template <class T, class Layout, class Alloc>
+inline bool read_array2d_text(Array2d<T,Layout,Alloc>& oArray2d, const std::string& iFileName, char iSeparator)
+{
+  std::ifstream file(iFileName.c_str(), std::ios::in | std::ios::binary);
+  if (!file) {
+    oArray2d.clear();
+    std::cerr << "[ERROR] bool read_array2d_text(Array2d<T>&, const std::string&, char)" << std::endl
+              << "Impossible to open the file " << iFileName << std::endl;
+    return false;
+  }
+  return read_array2d_text(oArray2d, file, iSeparator);
+}
+
+
+template <class T, class Layout>
+inline Array2d_mapped<T,Layout>::Array2d_mapped()
+: _map(0),
+  _map_size(0),
+  _data(0),
+  _nb_lines(0),
+  _line_size(0),
+  _buffer()
+{
+}
+
+
+template <class T, class Layout>
+inline Array2d_mapped<T,Layout>::Array2d_mapped(const std::string& iFileName)
+: _map(0),
+  _map_size(0),
+  _data(0),
+  _nb_lines(0),
+  _line_size(0),
+  _buffer()
+{
+  open(iFileName);
+}
+
+
+template <class T, class Layout>
+inline Array2d_mapped<T,Layout>::Array2d_mapped(Array2d_mapped&& iMapped) noexcept
+: _map(0),
+  _map_size(0),
+  _data(0),
+  _nb_lines(0),
+  _line_size(0),
+  _buffer()
+{
+  *this = std::move(iMapped);
+}
+
+
+template <class T, class Layout>
+inline Array2d_mapped<T,Layout>::~Array2d_mapped()
+{
+  close();
+}
+
+
+template <class T, class Layout>
+inline Array2d_mapped<T,Layout>& Array2d_mapped<T,Layout>::operator=(Array2d_mapped&& iMapped) noexcept
+{
+  if (&iMapped != this) {
+    close();
+    std::swap(_map, iMapped._map);
+    std::swap(_map_size, iMapped._map_size);
+    std::swap(_data, iMapped._data);
+    std::swap(_nb_lines, iMapped._nb_lines);
+    std::swap(_line_size, iMapped._line_size);
+    _buffer.swap(iMapped._buffer);
+  }
+  return *this;
+}
+
+
+template <class T, class Layout>
+inline bool Array2d_mapped<T,Layout>::open(const std::string& iFileName)
+{
+  static_assert(Array2d_type_tag<T>::value != 0, "Array2d_mapped requires an arithmetic type");
+  close();
+#ifdef ARRAY2D_IO_MMAP
+  int fd = ::open(iFileName.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    std::cerr << "[ERROR] bool Array2d_mapped<T>::open(const std::string&)" << std::endl
+              << "Impossible to open the file " << iFileName << std::endl;
+    if (fd >= 0)
+      ::close(fd);
+    return false;
+  }
+  _map_size = st.st_size;
+  if (_map_size >= sizeof(Array2d_file_header))
+    _map = mmap(0, _map_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);  // The mapping stays valid
+  if (_map == MAP_FAILED) {
+    std::cerr << "[ERROR] bool Array2d_mapped<T>::open(const std::string&)" << std::endl
+              << "Impossible to map the file " << iFileName << std::endl;
+    _map = 0;
+    _map_size = 0;
+    return false;
+  }
+#else
+  std::ifstream file(iFileName.c_str(), std::ios::in | std::ios::binary);
+  if (!file) {
+    std::cerr << "[ERROR] bool Array2d_mapped<T>::open(const std::string&)" << std::endl
+              << "Impossible to open the file " << iFileName << std::endl;
+    return false;
+  }
+  _buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  _map_size = _buffer.size();
+  _map = _buffer.data();
+#endif
+
+  const Array2d_file_header* header = (const Array2d_file_header*)_map;
+  std::string error;
+  if (_map_size < sizeof(Array2d_file_header))
+    error = "The file is too short.";
+  else if (header->check<T>(iFileName)) {
+    if (header->row_major != (Layout::is_row_major ? 1u : 0u))
+      error = "The layout of the file is not the layout of the array.";
+    else if ((int64_t)(_map_size - sizeof(Array2d_file_header)) < header->data_size())
+      error = "The file is too short.";
+  }
+  else {
+    close();  // The error is printed by check()
+    return false;
+  }
+  if (!error.empty()) {
+    std::cerr << "[ERROR] bool Array2d_mapped<T>::open(const std::string&)" << std::endl
+              << iFileName << ": " << error << std::endl;
+    close();
+    return false;
+  }
+
+  _nb_lines = (int)(Layout::is_row_major ? header->nb_rows : header->nb_columns);
+  _line_size = (int)(Layout::is_row_major ? header->nb_columns : header->nb_rows);
+  _data = (const T*)((const char*)_map + sizeof(Array2d_file_header));
+  return true;
+}
+
+
+template <class T, class Layout>
+inline void Array2d_mapped<T,Layout>::close()
+{
+#ifdef ARRAY2D_IO_MMAP
+  if (_map)
+    munmap(_map, _map_size);
+#endif
+  _buffer.clear();
+  _map = 0;
+  _map_size = 0;
+  _data = 0;
+  _nb_lines = 0;
+  _line_size = 0;
+}
+
+
+template <class T, class Layout>
+inline bool Array2d_mapped<T,Layout>::is_open() const
+{
+  return _map != 0;
+}
+
+
+template <class T, class Layout>
+inline int Array2d_mapped<T,Layout>::nb_rows() const
+{
+  return Layout::is_row_major ? _nb_lines : _line_size;
+}
+
+
+template <class T, class Layout>
+inline int Array2d_mapped<T,Layout>::nb_columns() const
+{
+  return Layout::is_row_major ? _line_size : _nb_lines;
+}
+
+
+template <class T, class Layout>
+inline int Array2d_mapped<T,Layout>::nb_lines() const
+{
+  return _nb_lines;
+}
+
+
+template <class T, class Layout>
+inline int Array2d_mapped<T,Layout>::line_size() const
+{
+  return _line_size;
+}
+
+
+template <class T, class Layout>
+inline const T& Array2d_mapped<T,Layout>::operator()(int iJ, int iI) const
+{
+#ifndef NDEBUG
+  if (iJ < 0 || iJ >= nb_rows() || iI < 0 || iI >= nb_columns()) {
+    std::cerr << "[WARNING] const T& Array2d_mapped<T>::operator()(int,int)" << std::endl
+              << "Index out of range." << std::endl;
+    assert(false);
+  }
+#endif
+  return _data[index(iJ, iI)];
+}
+
+
+template <class T, class Layout>
+inline const T& Array2d_mapped<T,Layout>::unchecked(int iJ, int iI) const
+{
+  return _data[index(iJ, iI)];
+}
+
+
+template <class T, class Layout>
+inline const T* Array2d_mapped<T,Layout>::line_data(int iK) const
+{
+  return _data + (size_t)iK*_line_size;
+}
+
+
+template <class T, class Layout>
+inline const T* Array2d_mapped<T,Layout>::data() const
+{
+  return _data;
+}
+
+
+template <class T, class Layout>
+template <class Alloc>
+inline void Array2d_mapped<T,Layout>::copy_to(Array2d<T,Layout,Alloc>& oArray2d) const
+{
+  oArray2d.resize(nb_rows(), nb_columns());
+  for (int k = 0; k < _nb_lines; k++)
+    std::memcpy(oArray2d.line_data(k), line_data(k), _line_size*sizeof(T));
+}
+
+
+template <class T, class Layout>
+inline size_t Array2d_mapped<T,Layout>::index(int iJ, int iI) const
+{
+  return Layout::is_row_major ? (size_t)iJ*_line_size+iI : (size_t)iI*_line_size+iJ;
+}
+
+
+#endif // ARRAY2D_IO_H
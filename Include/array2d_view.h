@@ -0,0 +1,567 @@
+/**
+ * @file array2d_view.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Non-owning views on a rectangular region of an #Array2d.
+ * @details A view is a pointer and four integers: building a view, a block, a row or a column
+ * of a view never allocates memory and never copies the elements.
+ * @code{cpp}
+ * #include "array2d_view.h"
+ *
+ * Array2d<double> A(1000, 1000);
+ * Array2d_view<double> v(A);
+ * for (int j = 0; j < 1000; j += 100)
+ *   for (int i = 0; i < 1000; i += 100)
+ *     v.block(j, i, 100, 100).fill(j + i);       // Tiled processing without copy
+ * double s = v.column(5).sum();                  // Sum of the column 5
+ * double t = v.strided(0, 0, 500, 1000, 2, 1).sum(); // Sum of the even rows
+ * @endcode
+ * A view is invalidated by all the operations which reallocate or move the elements of the
+ * array (insertion, deletion, resize, ...).
+ */
+
+
+#ifndef ARRAY2D_VIEW_H
+#define ARRAY2D_VIEW_H
+
+#include <assert.h>
+#include <iostream>
+#include <type_traits>
+
+#include "array2d.h"
+#include "simd_tools.h"
+
+
+/**
+ * @brief Non-owning view on a rectangular region of an array with two dimensions
+ * @details The element (j,i) of the view is at the address data() + j*row_stride() +
+ * i*column_stride(). The strides are given in elements and can be any positive values, so that
+ * a view describes a block of an #Array2d of any layout, a row, a column, every k-th row, or a
+ * transposed array. T is const for a read-only view.
+ *
+ * The reductions use the kernels of #Simd_kernels when the rows (column_stride() == 1) or the
+ * columns (row_stride() == 1) of the view are contiguous, and scalar loops otherwise.
+ */
+template <class T>
+class Array2d_view
+{
+ public:
+  typedef typename std::remove_const<T>::type value_type; /**< @brief Type of the elements */
+
+  /** @brief Constructor of an empty view */
+  inline Array2d_view();
+
+  /**
+   * @brief Constructor
+   * @param[in] iData Pointer on the element (0,0)
+   * @param[in] iP Number of rows
+   * @param[in] iN Number of columns
+   * @param[in] iRowStride Distance (in elements) between two consecutive rows
+   * @param[in] iColumnStride Distance (in elements) between two consecutive columns
+   */
+  inline Array2d_view(T* iData, int iP, int iN, int iRowStride, int iColumnStride);
+
+  /**
+   * @brief Constructor of a view on a whole array
+   * @param[in] iArray2d Viewed array (for a constant array, T must be const)
+   */
+  template <class U, class Layout, class Alloc>
+  inline Array2d_view(Array2d<U,Layout,Alloc> & iArray2d);
+
+  /** @brief Constructor of a read-only view on a whole array */
+  template <class U, class Layout, class Alloc>
+  inline Array2d_view(const Array2d<U,Layout,Alloc> & iArray2d);
+
+  /** @brief Conversion of a view to a read-only view */
+  template <class U>
+  inline Array2d_view(const Array2d_view<U> & iView);
+
+  /** @brief Return the number of rows of the view */
+  inline int nb_rows() const;
+
+  /** @brief Return the number of columns of the view */
+  inline int nb_columns() const;
+
+  /** @brief Return true if the view has no element */
+  inline bool empty() const;
+
+  /** @brief Return the distance (in elements) between two consecutive rows */
+  inline int row_stride() const;
+
+  /** @brief Return the distance (in elements) between two consecutive columns */
+  inline int column_stride() const;
+
+  /** @brief Return a pointer on the element (0,0) */
+  inline T* data() const;
+
+  /**
+   * @brief Access to coefficients of the view
+   * @details The indexes are checked only in debug builds (that is, if NDEBUG is not defined).
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   */
+  inline T& operator()(int iJ, int iI) const;
+
+  /**
+   * @brief Access to coefficients of the view without bounds checking
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   */
+  inline T& unchecked(int iJ, int iI) const;
+
+  /**
+   * @brief Return the view on a block of this view
+   * @param[in] iJ Index of the first row of the block
+   * @param[in] iI Index of the first column of the block
+   * @param[in] iP Number of rows of the block
+   * @param[in] iN Number of columns of the block
+   */
+  inline Array2d_view block(int iJ, int iI, int iP, int iN) const;
+
+  /**
+   * @brief Return the view on one row of each iRowStep rows and one column of each iColumnStep
+   * columns of a block
+   * @param[in] iJ Index of the first row
+   * @param[in] iI Index of the first column
+   * @param[in] iP Number of rows of the result
+   * @param[in] iN Number of columns of the result
+   * @param[in] iRowStep Step between two selected rows (positive)
+   * @param[in] iColumnStep Step between two selected columns (positive)
+   */
+  inline Array2d_view strided(int iJ, int iI, int iP, int iN, int iRowStep, int iColumnStep) const;
+
+  /**
+   * @brief Return the view on a row (1 x nb_columns())
+   * @param[in] iJ Index of the row
+   */
+  inline Array2d_view row(int iJ) const;
+
+  /**
+   * @brief Return the view on a column (nb_rows() x 1)
+   * @param[in] iI Index of the column
+   */
+  inline Array2d_view column(int iI) const;
+
+  /** @brief Return the view on the transpose (the strides are exchanged) */
+  inline Array2d_view transpose() const;
+
+  /** @brief Return the sum of the elements of the view */
+  inline value_type sum() const;
+
+  /**
+   * @brief Return the minimal element of the view
+   * @warning The view must not be empty.
+   */
+  inline value_type min() const;
+
+  /**
+   * @brief Return the maximal element of the view
+   * @warning The view must not be empty.
+   */
+  inline value_type max() const;
+
+  /** @brief Return the sum of the squares of the elements of the view */
+  inline value_type norm2() const;
+
+  /**
+   * @brief Return the dot product between this view and the argument view
+   * @param[in] iView View with the same size
+   */
+  template <class U>
+  inline value_type dot_product(const Array2d_view<U> & iView) const;
+
+  /**
+   * @brief Assign a value to all the elements of the view
+   * @param[in] iVal New value of the elements
+   */
+  inline void fill(const value_type& iVal) const;
+
+  /**
+   * @brief Replace each element x of the view by F(x)
+   * @param[in] iF Function or functor taking a T and returning a T
+   */
+  template <class F>
+  inline void transform(F iF) const;
+
+  /**
+   * @brief Copy the elements of a view with the same size into the elements of this view
+   * @param[in] iView Copied view (which must not overlap this view)
+   */
+  template <class U>
+  inline void copy(const Array2d_view<U> & iView) const;
+
+  /**
+   * @brief Copy the elements of the view into an array
+   * @param[out] oArray2d Array (resized to nb_rows() x nb_columns())
+   */
+  template <class Layout, class Alloc>
+  inline void copy_to(Array2d<value_type,Layout,Alloc> & oArray2d) const;
+
+ protected:
+  /**
+   * @brief Describe the view as lines of contiguous elements
+   * @param[out] oNbLines Number of lines
+   * @param[out] oLineSize Number of elements of a line
+   * @param[out] oLineStride Distance between two consecutive lines
+   * @return False if neither the rows nor the columns are contiguous
+   */
+  inline bool contiguous_lines(int& oNbLines, int& oLineSize, int& oLineStride) const;
+
+  /** @brief Print a warning and return false if the block is out of the view */
+  inline bool check_block(int iJ, int iI, int iP, int iN, const char* iFunction) const;
+
+  /** @brief Check the indexes of an element */
+  inline void check_range(int iJ, int iI) const;
+
+  T* _data;           /**< @brief Pointer on the element (0,0) */
+  int _nb_rows;       /**< @brief Number of rows */
+  int _nb_columns;    /**< @brief Number of columns */
+  int _row_stride;    /**< @brief Distance between two consecutive rows */
+  int _column_stride; /**< @brief Distance between two consecutive columns */
+
+  template <class U> friend class Array2d_view;
+};
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+
+template <class T>
+inline Array2d_view<T>::Array2d_view():
+  _data(0),
+  _nb_rows(0),
+  _nb_columns(0),
+  _row_stride(0),
+  _column_stride(0)
+{
+}
+
+template <class T>
+inline Array2d_view<T>::Array2d_view(T* iData, int iP, int iN, int iRowStride, int iColumnStride):
+  _data(iData),
+  _nb_rows(iP),
+  _nb_columns(iN),
+  _row_stride(iRowStride),
+  _column_stride(iColumnStride)
+{
+}
+
+template <class T>
+template <class U, class Layout, class Alloc>
+inline Array2d_view<T>::Array2d_view(Array2d<U,Layout,Alloc> & iArray2d):
+  _data(iArray2d.line_data(0)),
+  _nb_rows(iArray2d.nb_rows()),
+  _nb_columns(iArray2d.nb_columns()),
+  _row_stride(Layout::is_row_major ? iArray2d.stride() : 1),
+  _column_stride(Layout::is_row_major ? 1 : iArray2d.stride())
+{
+}
+
+template <class T>
+template <class U, class Layout, class Alloc>
+inline Array2d_view<T>::Array2d_view(const Array2d<U,Layout,Alloc> & iArray2d):
+  _data(iArray2d.line_data(0)),
+  _nb_rows(iArray2d.nb_rows()),
+  _nb_columns(iArray2d.nb_columns()),
+  _row_stride(Layout::is_row_major ? iArray2d.stride() : 1),
+  _column_stride(Layout::is_row_major ? 1 : iArray2d.stride())
+{
+}
+
+template <class T>
+template <class U>
+inline Array2d_view<T>::Array2d_view(const Array2d_view<U> & iView):
+  _data(iView._data),
+  _nb_rows(iView._nb_rows),
+  _nb_columns(iView._nb_columns),
+  _row_stride(iView._row_stride),
+  _column_stride(iView._column_stride)
+{
+}
+
+template <class T>
+inline int Array2d_view<T>::nb_rows() const
+{
+  return _nb_rows;
+}
+
+template <class T>
+inline int Array2d_view<T>::nb_columns() const
+{
+  return _nb_columns;
+}
+
+template <class T>
+inline bool Array2d_view<T>::empty() const
+{
+  return _nb_rows == 0 || _nb_columns == 0;
+}
+
+template <class T>
+inline int Array2d_view<T>::row_stride() const
+{
+  return _row_stride;
+}
+
+template <class T>
+inline int Array2d_view<T>::column_stride() const
+{
+  return _column_stride;
+}
+
+template <class T>
+inline T* Array2d_view<T>::data() const
+{
+  return _data;
+}
+
+template <class T>
+inline T& Array2d_view<T>::operator()(int iJ, int iI) const
+{
+#ifndef NDEBUG
+  check_range(iJ, iI);
+#endif
+  return _data[(ptrdiff_t)iJ*_row_stride + (ptrdiff_t)iI*_column_stride];
+}
+
+template <class T>
+inline T& Array2d_view<T>::unchecked(int iJ, int iI) const
+{
+  return _data[(ptrdiff_t)iJ*_row_stride + (ptrdiff_t)iI*_column_stride];
+}
+
+template <class T>
+inline Array2d_view<T> Array2d_view<T>::block(int iJ, int iI, int iP, int iN) const
+{
+  if (!check_block(iJ, iI, iP, iN, "Array2d_view<T>::block(int,int,int,int)"))
+    return Array2d_view();
+  return Array2d_view(&unchecked(iJ, iI), iP, iN, _row_stride, _column_stride);
+}
+
+template <class T>
+inline Array2d_view<T> Array2d_view<T>::strided(int iJ, int iI, int iP, int iN, int iRowStep, int iColumnStep) const
+{
+  if (iRowStep <= 0 || iColumnStep <= 0
+      || !check_block(iJ, iI, iP > 0 ? (iP-1)*iRowStep+1 : 0, iN > 0 ? (iN-1)*iColumnStep+1 : 0,
+                      "Array2d_view<T>::strided(int,int,int,int,int,int)"))
+    return Array2d_view();
+  return Array2d_view(&unchecked(iJ, iI), iP, iN, iRowStep*_row_stride, iColumnStep*_column_stride);
+}
+
+template <class T>
+inline Array2d_view<T> Array2d_view<T>::row(int iJ) const
+{
+  return block(iJ, 0, 1, _nb_columns);
+}
+
+template <class T>
+inline Array2d_view<T> Array2d_view<T>::column(int iI) const
+{
+  return block(0, iI, _nb_rows, 1);
+}
+
+template <class T>
+inline Array2d_view<T> Array2d_view<T>::transpose() const
+{
+  return Array2d_view(_data, _nb_columns, _nb_rows, _column_stride, _row_stride);
+}
+
+template <class T>
+inline typename Array2d_view<T>::value_type Array2d_view<T>::sum() const
+{
+  value_type s = value_type();
+  int nb_lines, line_size, line_stride;
+  if (contiguous_lines(nb_lines, line_size, line_stride)) {
+    for (int k = 0; k < nb_lines; k++)
+      s += Simd_kernels<value_type>::sum(_data + (ptrdiff_t)k*line_stride, line_size);
+  }
+  else {
+    for (int j = 0; j < _nb_rows; j++)
+      for (int i = 0; i < _nb_columns; i++)
+        s += unchecked(j, i);
+  }
+  return s;
+}
+
+template <class T>
+inline typename Array2d_view<T>::value_type Array2d_view<T>::min() const
+{
+  if (empty()) {
+    std::cerr << "[WARNING] T Array2d_view<T>::min()" << std::endl
+              << "The view is empty." << std::endl;
+    assert(false);
+    return value_type();
+  }
+  value_type m = _data[0];
+  int nb_lines, line_size, line_stride;
+  if (contiguous_lines(nb_lines, line_size, line_stride)) {
+    for (int k = 0; k < nb_lines; k++)
+      m = std::min(m, Simd_kernels<value_type>::min(_data + (ptrdiff_t)k*line_stride, line_size));
+  }
+  else {
+    for (int j = 0; j < _nb_rows; j++)
+      for (int i = 0; i < _nb_columns; i++)
+        m = std::min(m, unchecked(j, i));
+  }
+  return m;
+}
+
+template <class T>
+inline typename Array2d_view<T>::value_type Array2d_view<T>::max() const
+{
+  if (empty()) {
+    std::cerr << "[WARNING] T Array2d_view<T>::max()" << std::endl
+              << "The view is empty." << std::endl;
+    assert(false);
+    return value_type();
+  }
+  value_type m = _data[0];
+  int nb_lines, line_size, line_stride;
+  if (contiguous_lines(nb_lines, line_size, line_stride)) {
+    for (int k = 0; k < nb_lines; k++)
+      m = std::max(m, Simd_kernels<value_type>::max(_data + (ptrdiff_t)k*line_stride, line_size));
+  }
+  else {
+    for (int j = 0; j < _nb_rows; j++)
+      for (int i = 0; i < _nb_columns; i++)
+        m = std::max(m, unchecked(j, i));
+  }
+  return m;
+}
+
+template <class T>
+inline typename Array2d_view<T>::value_type Array2d_view<T>::norm2() const
+{
+  return dot_product(*this);
+}
+
+template <class T>
+template <class U>
+inline typename Array2d_view<T>::value_type Array2d_view<T>::dot_product(const Array2d_view<U> & iView) const
+{
+  if (_nb_rows != iView._nb_rows || _nb_columns != iView._nb_columns) {
+    std::cerr << "[ERROR] T Array2d_view<T>::dot_product(const Array2d_view<U>&)" << std::endl
+              << "The two views have not the same size." << std::endl;
+    return value_type();
+  }
+  value_type dot_prod = value_type();
+  if (empty())
+    return dot_prod;
+  if (_column_stride == 1 && iView._column_stride == 1) {
+    for (int j = 0; j < _nb_rows; j++)
+      dot_prod += Simd_kernels<value_type>::dot(&unchecked(j, 0), &iView.unchecked(j, 0), _nb_columns);
+  }
+  else if (_row_stride == 1 && iView._row_stride == 1) {
+    for (int i = 0; i < _nb_columns; i++)
+      dot_prod += Simd_kernels<value_type>::dot(&unchecked(0, i), &iView.unchecked(0, i), _nb_rows);
+  }
+  else {
+    for (int j = 0; j < _nb_rows; j++)
+      for (int i = 0; i < _nb_columns; i++)
+        dot_prod += unchecked(j, i) * iView.unchecked(j, i);
+  }
+  return dot_prod;
+}
+
+template <class T>
+inline void Array2d_view<T>::fill(const value_type& iVal) const
+{
+  int nb_lines, line_size, line_stride;
+  if (contiguous_lines(nb_lines, line_size, line_stride)) {
+    for (int k = 0; k < nb_lines; k++)
+      std::fill_n(_data + (ptrdiff_t)k*line_stride, line_size, iVal);
+  }
+  else {
+    for (int j = 0; j < _nb_rows; j++)
+      for (int i = 0; i < _nb_columns; i++)
+        unchecked(j, i) = iVal;
+  }
+}
+
+template <class T>
+template <class F>
+inline void Array2d_view<T>::transform(F iF) const
+{
+  for (int j = 0; j < _nb_rows; j++)
+    for (int i = 0; i < _nb_columns; i++)
+      unchecked(j, i) = iF(unchecked(j, i));
+}
+
+template <class T>
+template <class U>
+inline void Array2d_view<T>::copy(const Array2d_view<U> & iView) const
+{
+  if (_nb_rows != iView._nb_rows || _nb_columns != iView._nb_columns) {
+    std::cerr << "[WARNING] void Array2d_view<T>::copy(const Array2d_view<U>&)" << std::endl
+              << "The two views have not the same size. No element copied." << std::endl;
+    assert(false);
+    return;
+  }
+  if (_column_stride == 1 && iView._column_stride == 1) {
+    for (int j = 0; j < _nb_rows; j++)
+      std::copy(&iView.unchecked(j, 0), &iView.unchecked(j, 0) + _nb_columns, &unchecked(j, 0));
+  }
+  else {
+    for (int j = 0; j < _nb_rows; j++)
+      for (int i = 0; i < _nb_columns; i++)
+        unchecked(j, i) = iView.unchecked(j, i);
+  }
+}
+
+template <class T>
+template <class Layout, class Alloc>
+inline void Array2d_view<T>::copy_to(Array2d<value_type,Layout,Alloc> & oArray2d) const
+{
+  oArray2d.resize(_nb_rows, _nb_columns);
+  Array2d_view<value_type>(oArray2d).copy(*this);
+}
+
+template <class T>
+inline bool Array2d_view<T>::contiguous_lines(int& oNbLines, int& oLineSize, int& oLineStride) const
+{
+  if (_column_stride == 1) {
+    oNbLines = _nb_columns ? _nb_rows : 0;
+    oLineSize = _nb_columns;
+    oLineStride = _row_stride;
+    return true;
+  }
+  if (_row_stride == 1) {
+    oNbLines = _nb_rows ? _nb_columns : 0;
+    oLineSize = _nb_rows;
+    oLineStride = _column_stride;
+    return true;
+  }
+  return false;
+}
+
+template <class T>
+inline bool Array2d_view<T>::check_block(int iJ, int iI, int iP, int iN, const char* iFunction) const
+{
+  if (iP < 0 || iN < 0 || iJ < 0 || iI < 0 || iJ+iP > _nb_rows || iI+iN > _nb_columns) {
+    std::cerr << "[WARNING] Array2d_view<T> " << iFunction << std::endl
+              << "Block out of the view. Empty view returned." << std::endl;
+    assert(false);
+    return false;
+  }
+  return true;
+}
+
+template <class T>
+inline void Array2d_view<T>::check_range(int iJ, int iI) const
+{
+  if (iJ < 0 || iJ >= _nb_rows) {
+    std::cerr << "[WARNING] T& Array2d_view<T>::operator()(int,int)" << std::endl
+              << "Row index out of range." << std::endl;
+    assert(false);
+  }
+  else if (iI < 0 || iI >= _nb_columns) {
+    std::cerr << "[WARNING] T& Array2d_view<T>::operator()(int,int)" << std::endl
+              << "Column index out of range." << std::endl;
+    assert(false);
+  }
+}
+
+
+#endif // ARRAY2D_VIEW_H
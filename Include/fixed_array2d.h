@@ -0,0 +1,571 @@
+/**
+ * @file fixed_array2d.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Implementation of a template for array with two dimensions known at compile time.
+ */
+
+
+#ifndef FIXED_ARRAY2D_H
+#define FIXED_ARRAY2D_H
+
+#include <algorithm>
+#include <assert.h>
+#include <initializer_list>
+#include <iostream>
+
+#include "array2d.h"
+
+
+/**
+ * @brief Loop of N iterations unrolled at compile time
+ * @details apply(f) calls f(Offset), f(Offset+1), ..., f(Offset+N-1) without loop, so that the
+ * compiler sees independent statements even without optimization of the loops. The range is
+ * split in halves, so that the depth of the template instantiations is log2(N) and large arrays
+ * do not reach the limit of the compiler.
+ */
+template <int N, int Offset = 0>
+struct Fixed_array2d_unroll
+{
+  /** @brief Call iF(k) for k in [Offset, Offset+N[ */
+  template <class F>
+  static inline void apply(F& iF)
+  {
+    Fixed_array2d_unroll<N/2, Offset>::apply(iF);
+    Fixed_array2d_unroll<N-N/2, Offset+N/2>::apply(iF);
+  }
+};
+
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+template <int Offset>
+struct Fixed_array2d_unroll<1, Offset>
+{
+  template <class F>
+  static inline void apply(F& iF) { iF(Offset); }
+};
+
+template <int Offset>
+struct Fixed_array2d_unroll<0, Offset>
+{
+  template <class F>
+  static inline void apply(F&) {}
+};
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief Template for array with R rows and C columns, R and C being known at compile time.
+ * @details The R*C elements are stored row after row inside the object: creating, copying or
+ * destroying a Fixed_array2d never allocates memory, and all the loops of the methods are
+ * unrolled (see #Fixed_array2d_unroll). The methods have the same names and the same
+ * arguments as the methods of #Array2d, except those which change the size of the array.
+ *
+ * A minimal example is given by the following code:
+ * @code{cpp}
+ * #include "fixed_array2d.h"
+ *
+ * Fixed_array2d<double, 3, 3> R = { 0., -1., 0.,
+ *                                   1.,  0., 0.,
+ *                                   0.,  0., 1. };  // Rotation of 90 degrees
+ * Fixed_array2d<double, 3, 1> p = { 1., 2., 3. };
+ * Fixed_array2d<double, 3, 1> q = R.multiply(p);     // q = (-2, 1, 3)
+ * @endcode
+ */
+template <class T, int R, int C>
+class Fixed_array2d
+{
+ public:
+  static_assert(R > 0 && C > 0, "The dimensions of Fixed_array2d must be positive");
+
+  /** @brief Constructor (all the elements are constructed with the default constructor) */
+  inline Fixed_array2d();
+
+  /**
+   * @brief Constructor
+   * @param[in] iVal Value of all the elements
+   */
+  inline explicit Fixed_array2d(const T& iVal);
+
+  /**
+   * @brief Constructor from the list of the elements, row after row
+   * @param[in] iL List of R*C elements (the missing elements are constructed with the default
+   * constructor)
+   */
+  inline Fixed_array2d(std::initializer_list<T> iL);
+
+  /**
+   * @brief Constructor from a dynamic array
+   * @param[in] iArray2d Array with R rows and C columns
+   */
+  template <class Layout, class Alloc>
+  inline explicit Fixed_array2d(const Array2d<T,Layout,Alloc> & iArray2d);
+
+  /** @brief Return the number of rows of the array */
+  static constexpr int nb_rows() { return R; }
+
+  /** @brief Return the number of columns of the array */
+  static constexpr int nb_columns() { return C; }
+
+  /**
+   * @brief Write access to coefficients of the array
+   * @details The indexes are checked only in debug builds (that is, if NDEBUG is not defined).
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   */
+  inline T& operator()(int iJ, int iI);
+
+  /**
+   * @brief Read access to coefficients of the array
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   */
+  inline const T& operator()(int iJ, int iI)const;
+
+  /**
+   * @brief Write access to coefficients of the array without bounds checking
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   */
+  inline T& unchecked(int iJ, int iI);
+
+  /**
+   * @brief Read access to coefficients of the array without bounds checking
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   */
+  inline const T& unchecked(int iJ, int iI)const;
+
+  /**
+   * @brief Return a pointer on the first element of a row
+   * @param[in] iJ Index of the row
+   */
+  inline T* row_data(int iJ);
+
+  /**
+   * @brief Return a constant pointer on the first element of a row
+   * @param[in] iJ Index of the row
+   */
+  inline const T* row_data(int iJ)const;
+
+  /** @brief Return a pointer on the R*C elements, row after row */
+  inline T* data();
+
+  /** @brief Return a constant pointer on the R*C elements, row after row */
+  inline const T* data()const;
+
+  typedef T* iterator;             /**< @brief Iterator on all the elements */
+  typedef const T* const_iterator; /**< @brief Constant iterator on all the elements */
+
+  /** @brief Return an iterator on the first element of the array */
+  inline iterator begin();
+
+  /** @brief Return a constant iterator on the first element of the array */
+  inline const_iterator begin()const;
+
+  /** @brief Return an iterator past the last element of the array */
+  inline iterator end();
+
+  /** @brief Return a constant iterator past the last element of the array */
+  inline const_iterator end()const;
+
+  /** @brief Exchange the values of the columns i and j */
+  inline void swap_column(int i, int j);
+
+  /** @brief Exchange the values of the rows i and j */
+  inline void swap_row(int i, int j);
+
+  /** @brief Print the array on the standard output */
+  inline void print() const;
+
+  /**
+   * @brief Return the dot product between this array and the argument array
+   * @param[in] A Array with the same size
+   */
+  inline T dot_product(const Fixed_array2d& A) const;
+
+  /** @brief Return the sum of the elements of the array */
+  inline T sum() const;
+
+  /** @brief Return the minimal element of the array */
+  inline T min() const;
+
+  /** @brief Return the maximal element of the array */
+  inline T max() const;
+
+  /** @brief Return the squared Frobenius norm of the array (sum of the squares of its elements) */
+  inline T norm2() const;
+
+  /**
+   * @brief Compute this = a*X + this
+   * @param[in] iA Scalar a
+   * @param[in] iX Array X with the same size
+   */
+  inline void axpy(T iA, const Fixed_array2d& iX);
+
+  /**
+   * @brief Assign a value to all the elements of the array
+   * @param[in] iVal New value of the elements
+   */
+  inline void fill(const T& iVal);
+
+  /**
+   * @brief Replace each element x of the array by F(x)
+   * @param[in] iF Function or functor taking a T and returning a T
+   */
+  template <class F>
+  inline void transform(F iF);
+
+  /** @brief Return the transpose of the array */
+  inline Fixed_array2d<T,C,R> transpose() const;
+
+  /**
+   * @brief Compute the transpose of the array
+   * @param[out] oT Transpose of the array
+   */
+  inline void transpose(Fixed_array2d<T,C,R>& oT) const;
+
+  /**
+   * @brief Transpose the array
+   * @warning Only available for square arrays.
+   */
+  inline void transpose_in_place();
+
+  /**
+   * @brief Return the matrix product this * B
+   * @param[in] iB Array with C rows
+   */
+  template <int K>
+  inline Fixed_array2d<T,R,K> multiply(const Fixed_array2d<T,C,K>& iB) const;
+
+  /**
+   * @brief Compute the matrix product C = this * B
+   * @param[in] iB Array with C rows
+   * @param[out] oC Product. It must not be this array or iB.
+   */
+  template <int K>
+  inline void multiply(const Fixed_array2d<T,C,K>& iB, Fixed_array2d<T,R,K>& oC) const;
+
+  /**
+   * @brief Copy the elements into a dynamic array
+   * @param[out] oArray2d Array (resized to R x C)
+   */
+  template <class Layout, class Alloc>
+  inline void copy_to(Array2d<T,Layout,Alloc> & oArray2d) const;
+
+ protected:
+  /** @brief Check the indexes of an element */
+  inline void check_range(int iJ, int iI)const;
+
+  T _aT[R*C]; /**< @brief Elements, row after row */
+};
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+
+template <class T, int R, int C>
+inline Fixed_array2d<T,R,C>::Fixed_array2d():
+  _aT()
+{
+}
+
+template <class T, int R, int C>
+inline Fixed_array2d<T,R,C>::Fixed_array2d(const T& iVal)
+{
+  fill(iVal);
+}
+
+template <class T, int R, int C>
+inline Fixed_array2d<T,R,C>::Fixed_array2d(std::initializer_list<T> iL):
+  _aT()
+{
+  if (iL.size() > (size_t)(R*C)) {
+    std::cerr << "[WARNING] Fixed_array2d<T,R,C>::Fixed_array2d(std::initializer_list<T>)" << std::endl
+              << "Too many elements. The last elements are ignored." << std::endl;
+    assert(false);
+  }
+  std::copy(iL.begin(), iL.begin() + std::min(iL.size(), (size_t)(R*C)), _aT);
+}
+
+template <class T, int R, int C>
+template <class Layout, class Alloc>
+inline Fixed_array2d<T,R,C>::Fixed_array2d(const Array2d<T,Layout,Alloc> & iArray2d):
+  _aT()
+{
+  if (iArray2d.nb_rows() != R || iArray2d.nb_columns() != C) {
+    std::cerr << "[WARNING] Fixed_array2d<T,R,C>::Fixed_array2d(const Array2d<T>&)" << std::endl
+              << "The array has not R rows and C columns. No element copied." << std::endl;
+    assert(false);
+    return;
+  }
+  for (int j = 0; j < R; j++)
+    for (int i = 0; i < C; i++)
+      _aT[j*C+i] = iArray2d.unchecked(j, i);
+}
+
+template <class T, int R, int C>
+inline T& Fixed_array2d<T,R,C>::operator()(int iJ, int iI)
+{
+#ifndef NDEBUG
+  check_range(iJ, iI);
+#endif
+  return _aT[iJ*C+iI];
+}
+
+template <class T, int R, int C>
+inline const T& Fixed_array2d<T,R,C>::operator()(int iJ, int iI)const
+{
+#ifndef NDEBUG
+  check_range(iJ, iI);
+#endif
+  return _aT[iJ*C+iI];
+}
+
+template <class T, int R, int C>
+inline T& Fixed_array2d<T,R,C>::unchecked(int iJ, int iI)
+{
+  return _aT[iJ*C+iI];
+}
+
+template <class T, int R, int C>
+inline const T& Fixed_array2d<T,R,C>::unchecked(int iJ, int iI)const
+{
+  return _aT[iJ*C+iI];
+}
+
+template <class T, int R, int C>
+inline T* Fixed_array2d<T,R,C>::row_data(int iJ)
+{
+  return _aT + iJ*C;
+}
+
+template <class T, int R, int C>
+inline const T* Fixed_array2d<T,R,C>::row_data(int iJ)const
+{
+  return _aT + iJ*C;
+}
+
+template <class T, int R, int C>
+inline T* Fixed_array2d<T,R,C>::data()
+{
+  return _aT;
+}
+
+template <class T, int R, int C>
+inline const T* Fixed_array2d<T,R,C>::data()const
+{
+  return _aT;
+}
+
+template <class T, int R, int C>
+inline typename Fixed_array2d<T,R,C>::iterator Fixed_array2d<T,R,C>::begin()
+{
+  return _aT;
+}
+
+template <class T, int R, int C>
+inline typename Fixed_array2d<T,R,C>::const_iterator Fixed_array2d<T,R,C>::begin()const
+{
+  return _aT;
+}
+
+template <class T, int R, int C>
+inline typename Fixed_array2d<T,R,C>::iterator Fixed_array2d<T,R,C>::end()
+{
+  return _aT + R*C;
+}
+
+template <class T, int R, int C>
+inline typename Fixed_array2d<T,R,C>::const_iterator Fixed_array2d<T,R,C>::end()const
+{
+  return _aT + R*C;
+}
+
+template <class T, int R, int C>
+inline void Fixed_array2d<T,R,C>::swap_column(int i, int j)
+{
+  if (0 <= i && i < C && 0 <= j && j < C) {
+    for (int k = 0; k < R; k++)
+      std::swap(_aT[k*C+i], _aT[k*C+j]);
+  }
+  else {
+    std::cerr << "[WARNING] void Fixed_array2d<T,R,C>::swap_column(int,int)" << std::endl
+              << "Column index out of range. No column swapped." << std::endl;
+    assert(false);
+  }
+}
+
+template <class T, int R, int C>
+inline void Fixed_array2d<T,R,C>::swap_row(int i, int j)
+{
+  if (0 <= i && i < R && 0 <= j && j < R) {
+    for (int k = 0; k < C; k++)
+      std::swap(_aT[i*C+k], _aT[j*C+k]);
+  }
+  else {
+    std::cerr << "[WARNING] void Fixed_array2d<T,R,C>::swap_row(int,int)" << std::endl
+              << "Row index out of range. No row swapped." << std::endl;
+    assert(false);
+  }
+}
+
+template <class T, int R, int C>
+inline void Fixed_array2d<T,R,C>::print() const
+{
+  for (int j = 0; j < R; j++) {
+    for (int i = 0; i < C; i++)
+      std::cout << _aT[j*C+i] << "\t";
+    std::cout << '\n';  // No flush for each row
+  }
+  std::cout.flush();
+}
+
+template <class T, int R, int C>
+inline T Fixed_array2d<T,R,C>::dot_product(const Fixed_array2d& A) const
+{
+  T s = T();
+  auto f = [this, &A, &s](int k) { s += _aT[k] * A._aT[k]; };
+  Fixed_array2d_unroll<R*C>::apply(f);
+  return s;
+}
+
+template <class T, int R, int C>
+inline T Fixed_array2d<T,R,C>::sum() const
+{
+  T s = T();
+  auto f = [this, &s](int k) { s += _aT[k]; };
+  Fixed_array2d_unroll<R*C>::apply(f);
+  return s;
+}
+
+template <class T, int R, int C>
+inline T Fixed_array2d<T,R,C>::min() const
+{
+  T m = _aT[0];
+  auto f = [this, &m](int k) { if (_aT[k] < m) m = _aT[k]; };
+  Fixed_array2d_unroll<R*C>::apply(f);
+  return m;
+}
+
+template <class T, int R, int C>
+inline T Fixed_array2d<T,R,C>::max() const
+{
+  T m = _aT[0];
+  auto f = [this, &m](int k) { if (m < _aT[k]) m = _aT[k]; };
+  Fixed_array2d_unroll<R*C>::apply(f);
+  return m;
+}
+
+template <class T, int R, int C>
+inline T Fixed_array2d<T,R,C>::norm2() const
+{
+  return dot_product(*this);
+}
+
+template <class T, int R, int C>
+inline void Fixed_array2d<T,R,C>::axpy(T iA, const Fixed_array2d& iX)
+{
+  auto f = [this, iA, &iX](int k) { _aT[k] += iA * iX._aT[k]; };
+  Fixed_array2d_unroll<R*C>::apply(f);
+}
+
+template <class T, int R, int C>
+inline void Fixed_array2d<T,R,C>::fill(const T& iVal)
+{
+  auto f = [this, &iVal](int k) { _aT[k] = iVal; };
+  Fixed_array2d_unroll<R*C>::apply(f);
+}
+
+template <class T, int R, int C>
+template <class F>
+inline void Fixed_array2d<T,R,C>::transform(F iF)
+{
+  auto f = [this, &iF](int k) { _aT[k] = iF(_aT[k]); };
+  Fixed_array2d_unroll<R*C>::apply(f);
+}
+
+template <class T, int R, int C>
+inline Fixed_array2d<T,C,R> Fixed_array2d<T,R,C>::transpose() const
+{
+  Fixed_array2d<T,C,R> t;
+  transpose(t);
+  return t;
+}
+
+template <class T, int R, int C>
+inline void Fixed_array2d<T,R,C>::transpose(Fixed_array2d<T,C,R>& oT) const
+{
+  T* t = oT.data();
+  auto f = [this, t](int k) { t[(k%C)*R + k/C] = _aT[k]; };
+  Fixed_array2d_unroll<R*C>::apply(f);
+}
+
+template <class T, int R, int C>
+inline void Fixed_array2d<T,R,C>::transpose_in_place()
+{
+  static_assert(R == C, "Fixed_array2d::transpose_in_place() requires a square array");
+  auto f = [this](int k) {
+    if (k/C < k%C)
+      std::swap(_aT[k], _aT[(k%C)*C + k/C]);
+  };
+  Fixed_array2d_unroll<R*C>::apply(f);
+}
+
+template <class T, int R, int C>
+template <int K>
+inline Fixed_array2d<T,R,K> Fixed_array2d<T,R,C>::multiply(const Fixed_array2d<T,C,K>& iB) const
+{
+  Fixed_array2d<T,R,K> c;
+  multiply(iB, c);
+  return c;
+}
+
+template <class T, int R, int C>
+template <int K>
+inline void Fixed_array2d<T,R,C>::multiply(const Fixed_array2d<T,C,K>& iB, Fixed_array2d<T,R,K>& oC) const
+{
+  const T* b = iB.data();
+  T* c = oC.data();
+  // One unrolled dot product per element of the result
+  auto f = [this, b, c](int k) {
+    const int j = k/K, i = k%K;
+    T s = T();
+    auto g = [this, b, j, i, &s](int l) { s += _aT[j*C+l] * b[l*K+i]; };
+    Fixed_array2d_unroll<C>::apply(g);
+    c[k] = s;
+  };
+  Fixed_array2d_unroll<R*K>::apply(f);
+}
+
+template <class T, int R, int C>
+template <class Layout, class Alloc>
+inline void Fixed_array2d<T,R,C>::copy_to(Array2d<T,Layout,Alloc> & oArray2d) const
+{
+  oArray2d.resize(R, C);
+  for (int j = 0; j < R; j++)
+    for (int i = 0; i < C; i++)
+      oArray2d.unchecked(j, i) = _aT[j*C+i];
+}
+
+template <class T, int R, int C>
+inline void Fixed_array2d<T,R,C>::check_range(int iJ, int iI)const
+{
+  if (iJ < 0 || iJ >= R) {
+    std::cerr << "[WARNING] T& Fixed_array2d<T,R,C>::operator()(int,int)" << std::endl
+              << "Row index out of range." << std::endl;
+    assert(false);
+  }
+  else if (iI < 0 || iI >= C) {
+    std::cerr << "[WARNING] T& Fixed_array2d<T,R,C>::operator()(int,int)" << std::endl
+              << "Column index out of range." << std::endl;
+    assert(false);
+  }
+}
+
+
+#endif // FIXED_ARRAY2D_H
@@ -12,6 +12,7 @@
 
 #include <assert.h>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 
@@ -27,22 +28,30 @@
  *   <tr><td>(1,0)<td>(1,1)<td>(1,2)
  *   <tr><td>(2,0)<td>(2,1)<td>(2,2)
  * </table>
+ *
+ * The vector of indexes is allocated with Alloc (for example a
+ * std::pmr::polymorphic_allocator on an arena). #Hcube_iterator uses the default allocator.
  */
-class Hcube_iterator
+template <class Alloc = std::allocator<unsigned int> >
+class Basic_Hcube_iterator
 {
 public:
-  /** @brief Default constructor */
-  inline Hcube_iterator();
+  /**
+   * @brief Default constructor
+   * @param[in] iAlloc Allocator of the vector of indexes
+   */
+  inline Basic_Hcube_iterator(const Alloc& iAlloc = Alloc());
   
   /**
    * @brief Constructor
    * @param[in] iN dimension of the hypercube
    * @param[in] iK number of subdivision of the hypercube
+   * @param[in] iAlloc Allocator of the vector of indexes
    */
-  inline Hcube_iterator(unsigned int iN, unsigned int iK);
+  inline Basic_Hcube_iterator(unsigned int iN, unsigned int iK, const Alloc& iAlloc = Alloc());
   
   /** @brief Destructor */
-  inline ~Hcube_iterator();
+  inline ~Basic_Hcube_iterator();
   
   /** @brief Iterator on the set of k-combinations from a set of n elements */
   inline void operator++();
@@ -66,37 +75,46 @@ public:
 private:
   unsigned int _n;               /**< dimension of the hypercube */
   unsigned int _k;               /**< number of subdivision of the hypercube */
-  std::vector<unsigned int> _v;  /**< Vector of indexes of current vertex */
+  std::vector<unsigned int, Alloc> _v;  /**< Vector of indexes of current vertex */
 };
 
 
+/** @brief Iterator on the subdivision of an hypercube using the default allocator */
+typedef Basic_Hcube_iterator<> Hcube_iterator;
+
+
 //==============================================================================
 // Implementation of inline methods
 //==============================================================================
 
 
-inline Hcube_iterator::Hcube_iterator():
+template <class Alloc>
+inline Basic_Hcube_iterator<Alloc>::Basic_Hcube_iterator(const Alloc& iAlloc):
   _n(0),
-  _k(0)
+  _k(0),
+  _v(iAlloc)
 {
 }
 
 
-inline Hcube_iterator::Hcube_iterator(unsigned int iN, unsigned int iK):
+template <class Alloc>
+inline Basic_Hcube_iterator<Alloc>::Basic_Hcube_iterator(unsigned int iN, unsigned int iK, const Alloc& iAlloc):
   _n(iN),
   _k(iK),
-  _v(iN+1, 1)
+  _v(iN+1, 1, iAlloc)
 {
   _v[0]=0;
 }
 
 
-inline Hcube_iterator::~Hcube_iterator()
+template <class Alloc>
+inline Basic_Hcube_iterator<Alloc>::~Basic_Hcube_iterator()
 {
 }
 
 
-inline void Hcube_iterator::operator++()
+template <class Alloc>
+inline void Basic_Hcube_iterator<Alloc>::operator++()
 {
   int l=_n;
   _v[l]++;
@@ -109,7 +127,8 @@ inline void Hcube_iterator::operator++()
 }
 
 
-inline void Hcube_iterator::print()
+template <class Alloc>
+inline void Basic_Hcube_iterator<Alloc>::print()
 {
   for(unsigned int i = 0; i < _n; i++)
     std::cout << operator()(i) << " ";
@@ -117,19 +136,22 @@ inline void Hcube_iterator::print()
 }
 
 
-inline void Hcube_iterator::reset()
+template <class Alloc>
+inline void Basic_Hcube_iterator<Alloc>::reset()
 {
   _v.assign(_n+1,1);
   _v[0]=0;
 }
 
 
-inline bool Hcube_iterator::is_ended() {
+template <class Alloc>
+inline bool Basic_Hcube_iterator<Alloc>::is_ended() {
   return _v[0] > 0;
 }
 
 
-inline unsigned int Hcube_iterator::operator()(unsigned int iIdx) {
+template <class Alloc>
+inline unsigned int Basic_Hcube_iterator<Alloc>::operator()(unsigned int iIdx) {
   assert(iIdx < _n+1);
   return _v[iIdx+1]-1;
 }
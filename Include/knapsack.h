@@ -10,8 +10,34 @@
 
 #include <vector>
 #include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <stdint.h>
 #include <stdio.h>
 
+#include "parallel_tools.h"
+#include "simd_tools.h"
+
+
+#ifndef KNAPSACK_MIN_SIMD_WEIGHT
+/** @brief Minimal weight of an item for which a single row is updated by the SIMD kernels */
+#define KNAPSACK_MIN_SIMD_WEIGHT 32
+#endif
+
+
+/**
+ * @brief Storage of the dynamic programming table of #Knapsack
+ */
+enum Knapsack_table_mode
+{
+  KNAPSACK_FULL_TABLE,  /**< @brief Table of (n+1) x (W+1) values (default) */
+  KNAPSACK_ROLLING_ROW, /**< @brief Single row of W+1 values, the chosen items are rebuilt by divide and conquer */
+  KNAPSACK_BIT_TABLE    /**< @brief Two rows of W+1 values and a table of n x (W+1) bits "item taken" */
+};
+
 
 /**
  * @brief Template functor to solve the Knapsack problem using dynamic programming.
@@ -54,23 +80,67 @@
  * Affectation in the knapsack: 1 0 1 0 
  * @endcode
  *
+ * The internal vectors and the dynamic programming table are allocated with Alloc (rebound to
+ * the needed types), for example a std::pmr::polymorphic_allocator on an arena.
+ *
+ * By default, the whole table of (n+1) x (W+1) values is kept to rebuild the chosen items. For
+ * large instances, the mode #KNAPSACK_ROLLING_ROW (see set_table_mode()) only keeps rows of
+ * W+1 values: each item updates the row in place, from the largest weight to the smallest. The
+ * chosen items are then rebuilt as in the algorithm of Hirschberg: the items are split in two
+ * halves, a row is computed for each half, the capacity is split where the sum of the two rows
+ * is maximal, and each half is solved recursively. The memory is O(n + W) and the time
+ * O(n W log n). If only the optimal value is needed, set_value_only() skips the rebuilding.
+ *
+ * The mode #KNAPSACK_BIT_TABLE keeps the time O(n W) of the full table with much less memory:
+ * for each item and each weight, a single bit tells if the item improves the row (that is,
+ * if it is taken), and the chosen items are rebuilt from these bits. The memory is n (W+1) / 8
+ * bytes plus two rows of W+1 values, instead of (n+1) (W+1) values.
+ *
+ * With several threads (see set_parallel_policy()), the capacity axis is split in blocks of
+ * grain size weights: for each item, the threads update the blocks of the new row from the
+ * previous row, then wait for each other before the next item. The rolling row mode then
+ * uses two rows of W+1 values.
+ *
+ * With set_preprocessing(), the items are reduced before the dynamic programming: the items
+ * heavier than the knapsack or without positive value are never taken, the items without weight
+ * and with a positive value are always taken. The other items are sorted by value density and
+ * the break item b (the first one which does not fit in the greedy order) gives the bound of
+ * Dantzig. An item before b is always taken if the bound without it (the freed capacity filled
+ * at the density of b) is lower than the value of the greedy solution; an item after b is never
+ * taken if the bound with it is lower than this value (for arithmetic types T only: the bounds
+ * are computed with doubles, and the other types only get the first reductions). The remaining
+ * items, the "core" around
+ * the break item, are solved by dynamic programming with the capacity left by the fixed items,
+ * and the solution is mapped back to the original indices. The optimal value is unchanged.
+ *
+ * For the same items and many capacities, the table does not depend on the capacity: it is
+ * built once for the largest capacity with solve_all_capacities() (or solve_batch()), then the
+ * optimal value and the chosen items of each capacity are read from it in O(1) and O(n):
+ * @code{cpp}
+ * Knapsack<int> knapsack(1000, wt, val);
+ * knapsack.solve_all_capacities();               // Table of the capacities 0 to 1000
+ * int opt = knapsack.get_optimal_value(420);     // Optimal value for the capacity 420
+ * knapsack.get_chosen_objects(420, Solution);    // Chosen items for the capacity 420
+ * @endcode
  */
-template< class T >
+template< class T, class Alloc = std::allocator<T> >
 class Knapsack
 {
 public:
   /**
    * @brief Default constructor
+   * @param[in] iAlloc Allocator of the internal vectors
    */
-  inline Knapsack();
+  inline Knapsack(const Alloc& iAlloc = Alloc());
 
   /**
    * @brief Constructor
    * @param[in] iW Weight limit of the knapsack
    * @param[in] iWt Vector of item weights
    * @param[in] iVal Vector of item values
+   * @param[in] iAlloc Allocator of the internal vectors
    */
-  inline Knapsack(const unsigned int iW, const std::vector<unsigned int> iWt, const typename std::vector<T> iVal);
+  inline Knapsack(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const Alloc& iAlloc = Alloc());
 
   /**
    * @brief Destructor
@@ -91,7 +161,19 @@ public:
    * @param[in] iVal Vector of item values
    * @return Optimal value of the knapsack
    */
-  inline T operator()(const unsigned int iW, const std::vector<unsigned int> iWt, const typename std::vector<T> iVal);
+  inline T operator()(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal);
+
+  /**
+   * @brief Solve the knapsack problem with the items of contiguous arrays (for example spans)
+   * @details This method modifies the attribute of the fonctor. The arrays are copied in the
+   * internal vectors, whose memory is reused from one call to the next.
+   * @param[in] iW Weight limit of the knapsack
+   * @param[in] iWt Array of iNbItems item weights
+   * @param[in] iVal Array of iNbItems item values
+   * @param[in] iNbItems Number of items
+   * @return Optimal value of the knapsack
+   */
+  inline T operator()(const unsigned int iW, const unsigned int* iWt, const T* iVal, size_t iNbItems);
 
   /**
    * @brief Return the optimal value of the knapsack
@@ -108,18 +190,230 @@ public:
    */
   inline void get_chosen_objects(std::vector<bool> & oSolution);
 
+  /**
+   * @brief Solve the knapsack problem for all the capacities up to the weight limit
+   * @details The last row of the table and the bits "item taken" of all the items are kept, so
+   * that get_optimal_value(unsigned int) and get_chosen_objects(unsigned int, std::vector<bool>&)
+   * answer for any capacity lower or equal to the weight limit. The memory is the one of
+   * #KNAPSACK_BIT_TABLE; the table mode and the preprocessing are not used. The solution of the
+   * weight limit is also set, as with operator()().
+   * @return Optimal value of the knapsack
+   */
+  inline T solve_all_capacities();
+
+  /**
+   * @brief Solve the knapsack problem for several capacities with a single table
+   * @details The weight limit is set to the largest capacity and solve_all_capacities() is called.
+   * @param[in] iCapacities Capacities of the knapsack
+   * @param[out] oValues Optimal value of each capacity
+   * @param[out] oSolutions Chosen elements of each capacity
+   */
+  inline void solve_batch(const std::vector<unsigned int> & iCapacities, std::vector<T> & oValues, std::vector< std::vector<bool> > & oSolutions);
+
+  /**
+   * @brief Solve the knapsack problem for several capacities with a single row
+   * @details Only the optimal values are computed, with a single row of max(iCapacities)+1
+   * values (as with set_value_only()).
+   * @param[in] iCapacities Capacities of the knapsack
+   * @param[out] oValues Optimal value of each capacity
+   */
+  inline void solve_batch(const std::vector<unsigned int> & iCapacities, std::vector<T> & oValues);
+
+  /**
+   * @brief Return the optimal value of the knapsack for a capacity
+   * @param[in] iW Capacity, lower or equal to the weight limit
+   * @warning The user must solve the knapsack calling solve_all_capacities()
+   */
+  inline T get_optimal_value(unsigned int iW) const;
+
+  /**
+   * @brief Return a vector representing the chosen elements for a capacity
+   * @param[in] iW Capacity, lower or equal to the weight limit
+   * @param[out] oSolution Vector representing the chosen elements
+   * @warning The user must solve the knapsack calling solve_all_capacities()
+   */
+  inline void get_chosen_objects(unsigned int iW, std::vector<bool> & oSolution) const;
+
+  /**
+   * @brief Set the storage of the dynamic programming table
+   * @param[in] iMode #KNAPSACK_FULL_TABLE (default), #KNAPSACK_ROLLING_ROW or #KNAPSACK_BIT_TABLE
+   */
+  inline void set_table_mode(Knapsack_table_mode iMode);
+
+  /** @brief Return the storage of the dynamic programming table */
+  inline Knapsack_table_mode get_table_mode() const;
+
+  /**
+   * @brief Set if only the optimal value is computed
+   * @param[in] iValueOnly If true, the chosen objects are not computed (get_chosen_objects()
+   * returns no chosen object) and a single row of W+1 values is used, whatever the table mode.
+   */
+  inline void set_value_only(bool iValueOnly);
+
+  /** @brief Return true if only the optimal value is computed */
+  inline bool is_value_only() const;
+
+  /**
+   * @brief Set the parameters of the multithreading
+   * @param[in] iPolicy Number of threads and number of weights of the blocks of a row (grain
+   * size). The rows are split among the threads if they have more than one block.
+   */
+  inline void set_parallel_policy(const Parallel_policy& iPolicy);
+
+  /** @brief Return the parameters of the multithreading */
+  inline const Parallel_policy& get_parallel_policy() const;
+
+  /**
+   * @brief Set if the items are reduced before the dynamic programming
+   * @param[in] iPreprocessing If true, the items which are never or always in an optimal
+   * solution are fixed, and only the other ones (the core) are in the table.
+   */
+  inline void set_preprocessing(bool iPreprocessing);
+
+  /** @brief Return true if the items are reduced before the dynamic programming */
+  inline bool is_preprocessing() const;
+
+  /**
+   * @brief Return the number of items of the table of the last resolution
+   * @details Without preprocessing, it is the number of items.
+   */
+  inline size_t get_nb_core_items() const;
+
 protected:
+  /** @brief Vector of T allocated with Alloc */
+  typedef std::vector<T, Alloc> Value_vector;
+  /** @brief Vector of U allocated with Alloc rebound to U */
+  template <class U> struct Rebind { typedef std::vector<U, typename std::allocator_traits<Alloc>::template rebind_alloc<U> > vector; };
+
   /**
    * @brief Solve the knapsack problem with the parameters stored in the attribute of the fonctor
    */
   inline void solve();
 
+  /** @brief Solve the knapsack problem with the table mode, without preprocessing */
+  inline void solve_table();
+
+  /** @brief Fix the items which are never or always chosen, then solve the core by solve_table() */
+  inline void solve_reduced();
+
+  /**
+   * @brief Find the items which are always chosen and the items of the core
+   * @param[out] oCore Indexes of the items which are neither always nor never chosen (increasing)
+   * @param[out] oFixedValue Value of the items which are always chosen
+   * @param[out] oFixedWeight Weight of the items which are always chosen
+   * @details The items which are always chosen are set in _Solution.
+   */
+  inline void reduce(std::vector<size_t> & oCore, T & oFixedValue, unsigned int & oFixedWeight);
+
+  /**
+   * @brief Fix the items which are always or never chosen with the bounds of Dantzig (arithmetic T)
+   * @param[in,out] ioOrder Items with a positive value and weight, which fit in the knapsack
+   * (sorted by decreasing density)
+   * @param[out] oCore Indexes of the items which are not fixed (increasing)
+   * @param[in,out] ioFixedValue Value of the items which are always chosen
+   * @param[in,out] ioFixedWeight Weight of the items which are always chosen
+   */
+  inline void reduce_by_bounds(std::vector<size_t> & ioOrder, std::vector<size_t> & oCore, T & ioFixedValue, unsigned int & ioFixedWeight, std::true_type);
+
+  /** @brief Without conversion to double, all the items of ioOrder are in the core */
+  inline void reduce_by_bounds(std::vector<size_t> & ioOrder, std::vector<size_t> & oCore, T & ioFixedValue, unsigned int & ioFixedWeight, std::false_type);
+
+  /** @brief Solve the knapsack problem keeping the whole table */
+  inline void solve_full_table();
+
+  /** @brief Solve the knapsack problem with rows of W+1 values */
+  inline void solve_rolling_row();
+
+  /** @brief Solve the knapsack problem with two rows of W+1 values and a table of bits */
+  inline void solve_bit_table();
+
+  /**
+   * @brief Compute the last row of the table and the bits "item taken" (in _row and _taken)
+   * @details _row[w] is the optimal value for the capacity w, and the bit w%64 of the word
+   * i*_nb_words + w/64 of _taken is set if the item i improves the row i for the weight w.
+   */
+  inline void compute_bit_table();
+
+  /**
+   * @brief Rebuild the chosen items of a capacity from the bits "item taken"
+   * @param[in] iW Capacity, lower or equal to the weight limit
+   * @param[out] oSolution Chosen items (of size the number of items)
+   */
+  template <class Vector>
+  inline void choose_objects_from_bits(unsigned int iW, Vector & oSolution) const;
+
+  /** @brief Check that the table of all the capacities is computed for a capacity */
+  inline bool check_capacity(unsigned int iW, const char* iFunction) const;
+
+  /**
+   * @brief Compute the best values of the items [iBegin, iEnd[ for all the capacities up to iW
+   * @param[in] iBegin Index of the first item
+   * @param[in] iEnd Index of the last item (excluded)
+   * @param[in] iW Maximal capacity
+   * @param[out] oK Row of iW+1 values: oK[w] is the best value with a weight lower or equal to w
+   */
+  inline void compute_row(size_t iBegin, size_t iEnd, unsigned int iW, Value_vector & oK) const;
+
+  /**
+   * @brief Add an item to a row: ioK[w] = max(ioK[w], ioK[w-iWt] + iVal) for w from iW to iWt
+   * @details The row is updated with the kernel Simd_kernels::max_add() (vectorized for float,
+   * double, int and the 64-bit integers).
+   * @param[in,out] ioK Row of iW+1 values
+   * @param[in] iW Maximal capacity
+   * @param[in] iWt Weight of the item
+   * @param[in] iVal Value of the item
+   */
+  static inline void add_to_row(T* ioK, unsigned int iW, unsigned int iWt, const T& iVal);
+
+  /**
+   * @brief Compute the weights [iBegin, iEnd[ of the row obtained by adding an item to a row
+   * @param[in] iPrev Row without the item
+   * @param[out] oCur Row with the item: oCur[w] = max(iPrev[w], iPrev[w-iWt] + iVal)
+   * @param[in] iWt Weight of the item
+   * @param[in] iVal Value of the item
+   * @param[in] iBegin First weight
+   * @param[in] iEnd Last weight (excluded)
+   */
+  static inline void add_to_row(const T* iPrev, T* oCur, unsigned int iWt, const T& iVal, size_t iBegin, size_t iEnd);
+
+  /**
+   * @brief Set the bits of the weights [iBegin, iEnd[ for which an item improves the row
+   * @param[in] iPrev Row without the item
+   * @param[in] iCur Row with the item
+   * @param[in] iBegin First weight (multiple of 64)
+   * @param[in] iEnd Last weight (excluded)
+   * @param[out] oTaken Bits of the item (bit w%64 of the word w/64 for the weight w)
+   */
+  static inline void mark_taken(const T* iPrev, const T* iCur, size_t iBegin, size_t iEnd, uint64_t* oTaken);
+
+  /** @brief Return the number of blocks of weights of a row of iW+1 values */
+  inline long nb_row_blocks(unsigned int iW) const;
+
+  /**
+   * @brief Choose the items [iBegin, iEnd[ for the capacity iW (divide and conquer)
+   * @param[in] iBegin Index of the first item
+   * @param[in] iEnd Index of the last item (excluded)
+   * @param[in] iW Capacity available for these items
+   */
+  inline void choose_objects(size_t iBegin, size_t iEnd, unsigned int iW);
+
   unsigned int _W; /**< @brief [input] Total weight of the knapsack */
-  std::vector<unsigned int> _Wt; /**< @brief [input] Vector of item weights */
-  typename std::vector<T> _Val; /**< @brief [input] Vector of item values */
+  typename Rebind<unsigned int>::vector _Wt; /**< @brief [input] Vector of item weights */
+  Value_vector _Val; /**< @brief [input] Vector of item values */
 
   T _opt_value; /**< @brief [output] Optimal value of the knapsack */
-  std::vector<bool> _Solution; /**< @brief [output] Array of the chosen elements */
+  typename Rebind<bool>::vector _Solution; /**< @brief [output] Array of the chosen elements */
+
+  Knapsack_table_mode _table_mode; /**< @brief Storage of the dynamic programming table */
+  bool _value_only;                /**< @brief If true, the chosen elements are not computed */
+  Parallel_policy _policy;         /**< @brief Parameters of the multithreading */
+  bool _preprocessing;             /**< @brief If true, the items are reduced before the table */
+  size_t _nb_core_items;           /**< @brief Number of items of the table of the last resolution */
+
+  Value_vector _row;                        /**< @brief Last row of the table (see solve_all_capacities()) */
+  typename Rebind<uint64_t>::vector _taken; /**< @brief Bits "item taken" (see solve_all_capacities()) */
+  size_t _nb_words;                         /**< @brief Number of words of the bits of an item */
+  bool _all_capacities;                     /**< @brief True if _row and _taken are those of the current items */
 };
 
 
@@ -128,23 +422,41 @@ protected:
 //==============================================================================
 
 
-template< class T >
-inline Knapsack<T>::Knapsack()
+template< class T, class Alloc >
+inline Knapsack<T,Alloc>::Knapsack(const Alloc& iAlloc)
 : _W(0),
-  _Wt(),
-  _Val(),
+  _Wt(iAlloc),
+  _Val(iAlloc),
   _opt_value(),
-  _Solution()
+  _Solution(iAlloc),
+  _table_mode(KNAPSACK_FULL_TABLE),
+  _value_only(false),
+  _policy(1),
+  _preprocessing(false),
+  _nb_core_items(0),
+  _row(iAlloc),
+  _taken(iAlloc),
+  _nb_words(0),
+  _all_capacities(false)
 {}
 
 
-template< class T >
-inline Knapsack<T>::Knapsack(const unsigned int iW, const std::vector<unsigned int> iWt, const typename std::vector<T> iVal)
+template< class T, class Alloc >
+inline Knapsack<T,Alloc>::Knapsack(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const Alloc& iAlloc)
 : _W(iW),
-  _Wt(iWt),
-  _Val(iVal),
+  _Wt(iWt.begin(), iWt.end(), iAlloc),
+  _Val(iVal.begin(), iVal.end(), iAlloc),
   _opt_value(),
-  _Solution()
+  _Solution(iAlloc),
+  _table_mode(KNAPSACK_FULL_TABLE),
+  _value_only(false),
+  _policy(1),
+  _preprocessing(false),
+  _nb_core_items(0),
+  _row(iAlloc),
+  _taken(iAlloc),
+  _nb_words(0),
+  _all_capacities(false)
 {
   // Assert that the sizes are equal
   size_t nb_objects = std::min(iWt.size(), iVal.size());
@@ -155,15 +467,15 @@ inline Knapsack<T>::Knapsack(const unsigned int iW, const std::vector<unsigned i
 
 
 
-template< class T >
-inline Knapsack<T>::~Knapsack()
+template< class T, class Alloc >
+inline Knapsack<T,Alloc>::~Knapsack()
 {
 }
 
 
 
-template< class T >
-inline T Knapsack<T>::operator()()
+template< class T, class Alloc >
+inline T Knapsack<T,Alloc>::operator()()
 {
   solve();
   return _opt_value;
@@ -171,19 +483,22 @@ inline T Knapsack<T>::operator()()
 
 
 
-template< class T >
-inline T Knapsack<T>::operator()(const unsigned int iW, const std::vector<unsigned int> iWt, const typename std::vector<T> iVal)
+template< class T, class Alloc >
+inline T Knapsack<T,Alloc>::operator()(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal)
+{
+  // Assert that the sizes are equal
+  return (*this)(iW, iWt.data(), iVal.data(), std::min(iWt.size(), iVal.size()));
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack<T,Alloc>::operator()(const unsigned int iW, const unsigned int* iWt, const T* iVal, size_t iNbItems)
 {
   // Reassignment
   _W = iW;
-  _Wt.assign(iWt.begin(), iWt.end());
-  _Val.assign(iVal.begin(), iVal.end());
-
-  // Assert that the sizes are equal
-  size_t nb_objects = std::min(iWt.size(), iVal.size());
-  _Wt.resize(nb_objects);
-  _Val.resize(nb_objects);
-  _Solution.assign(nb_objects, false);
+  _Wt.assign(iWt, iWt + iNbItems);
+  _Val.assign(iVal, iVal + iNbItems);
+  _Solution.assign(iNbItems, false);
 
   // Solve the knapsack
   solve();
@@ -191,57 +506,534 @@ inline T Knapsack<T>::operator()(const unsigned int iW, const std::vector<unsign
 }
 
 
-template <class T>
-inline T Knapsack<T>::get_optimal_value() {
+template< class T, class Alloc >
+inline T Knapsack<T,Alloc>::get_optimal_value() {
   return _opt_value;
 }
 
 
-template< class T >
-inline void Knapsack<T>::get_chosen_objects(std::vector<bool> & oSolution)
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::get_chosen_objects(std::vector<bool> & oSolution)
 {
   oSolution.assign(_Solution.begin(),_Solution.end());
 }
 
 
-template< class T >
-inline void Knapsack<T>::solve()
+template< class T, class Alloc >
+inline T Knapsack<T,Alloc>::solve_all_capacities()
+{
+  compute_bit_table();
+  _all_capacities = true;
+  _nb_core_items = _Wt.size();
+  _opt_value = _row[_W];
+  choose_objects_from_bits(_W, _Solution);
+  return _opt_value;
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::solve_batch(const std::vector<unsigned int> & iCapacities, std::vector<T> & oValues, std::vector< std::vector<bool> > & oSolutions)
+{
+  _W = iCapacities.empty() ? 0 : *std::max_element(iCapacities.begin(), iCapacities.end());
+  solve_all_capacities();
+  oValues.resize(iCapacities.size());
+  oSolutions.resize(iCapacities.size());
+  for (size_t k = 0; k < iCapacities.size(); k++) {
+    oValues[k] = _row[iCapacities[k]];
+    choose_objects_from_bits(iCapacities[k], oSolutions[k]);
+  }
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::solve_batch(const std::vector<unsigned int> & iCapacities, std::vector<T> & oValues)
+{
+  _W = iCapacities.empty() ? 0 : *std::max_element(iCapacities.begin(), iCapacities.end());
+  _all_capacities = false;
+  _nb_core_items = _Wt.size();
+  Value_vector K(_Val.get_allocator());
+  compute_row(0, _Wt.size(), _W, K);
+  _opt_value = K[_W];
+  _Solution.assign(_Wt.size(), false);
+  oValues.resize(iCapacities.size());
+  for (size_t k = 0; k < iCapacities.size(); k++)
+    oValues[k] = K[iCapacities[k]];
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack<T,Alloc>::get_optimal_value(unsigned int iW) const
+{
+  if (!check_capacity(iW, "T Knapsack<T>::get_optimal_value(unsigned int) const"))
+    return T();
+  return _row[iW];
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::get_chosen_objects(unsigned int iW, std::vector<bool> & oSolution) const
+{
+  if (!check_capacity(iW, "void Knapsack<T>::get_chosen_objects(unsigned int, std::vector<bool>&) const")) {
+    oSolution.assign(_Wt.size(), false);
+    return;
+  }
+  choose_objects_from_bits(iW, oSolution);
+}
+
+
+template< class T, class Alloc >
+inline bool Knapsack<T,Alloc>::check_capacity(unsigned int iW, const char* iFunction) const
+{
+  if (!_all_capacities || iW > _W) {
+    std::cerr << "[ERROR] " << iFunction << std::endl
+              << "The table of the capacity " << iW << " is not computed. Call solve_all_capacities() first." << std::endl;
+    assert(false);
+    return false;
+  }
+  return true;
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::set_table_mode(Knapsack_table_mode iMode)
+{
+  _table_mode = iMode;
+}
+
+
+template< class T, class Alloc >
+inline Knapsack_table_mode Knapsack<T,Alloc>::get_table_mode() const
+{
+  return _table_mode;
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::set_value_only(bool iValueOnly)
+{
+  _value_only = iValueOnly;
+}
+
+
+template< class T, class Alloc >
+inline bool Knapsack<T,Alloc>::is_value_only() const
+{
+  return _value_only;
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::set_parallel_policy(const Parallel_policy& iPolicy)
+{
+  _policy = iPolicy;
+}
+
+
+template< class T, class Alloc >
+inline const Parallel_policy& Knapsack<T,Alloc>::get_parallel_policy() const
+{
+  return _policy;
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::set_preprocessing(bool iPreprocessing)
+{
+  _preprocessing = iPreprocessing;
+}
+
+
+template< class T, class Alloc >
+inline bool Knapsack<T,Alloc>::is_preprocessing() const
+{
+  return _preprocessing;
+}
+
+
+template< class T, class Alloc >
+inline size_t Knapsack<T,Alloc>::get_nb_core_items() const
+{
+  return _nb_core_items;
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::solve()
+{
+  _all_capacities = false;
+  _Solution.assign(_Wt.size(), false);
+  _nb_core_items = _Wt.size();
+  if (_preprocessing)
+    solve_reduced();
+  else
+    solve_table();
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::solve_table()
+{
+  if (_table_mode == KNAPSACK_ROLLING_ROW || _value_only)
+    solve_rolling_row();
+  else if (_table_mode == KNAPSACK_BIT_TABLE)
+    solve_bit_table();
+  else
+    solve_full_table();
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::solve_reduced()
+{
+  std::vector<size_t> core;
+  T fixed_value = T();
+  unsigned int fixed_weight = 0;
+  reduce(core, fixed_value, fixed_weight);
+  _nb_core_items = core.size();
+
+  // Solve the core in place of the whole problem
+  typename Rebind<unsigned int>::vector Wt(_Wt.get_allocator());
+  Value_vector Val(_Val.get_allocator());
+  Wt.reserve(core.size());
+  Val.reserve(core.size());
+  for (size_t k = 0; k < core.size(); k++) {
+    Wt.push_back(_Wt[core[k]]);
+    Val.push_back(_Val[core[k]]);
+  }
+  typename Rebind<bool>::vector Solution(core.size(), false, _Solution.get_allocator());
+  const unsigned int W = _W;
+  _W -= fixed_weight;
+  _Wt.swap(Wt);
+  _Val.swap(Val);
+  _Solution.swap(Solution);
+  solve_table();
+
+  // Back to the original items
+  _W = W;
+  _Wt.swap(Wt);
+  _Val.swap(Val);
+  _Solution.swap(Solution);
+  for (size_t k = 0; k < core.size(); k++)
+    _Solution[core[k]] = Solution[k];
+  _opt_value = fixed_value + _opt_value;
+  if (_value_only)
+    _Solution.assign(_Wt.size(), false);
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::reduce(std::vector<size_t> & oCore, T & oFixedValue, unsigned int & oFixedWeight)
+{
+  oCore.clear();
+  oFixedValue = T();
+  oFixedWeight = 0;
+
+  // Items never chosen (too heavy or without positive value) and always chosen (without weight)
+  std::vector<size_t> order;
+  for (size_t i = 0; i < _Wt.size(); i++) {
+    if (!(T() < _Val[i]) || _Wt[i] > _W)
+      continue;
+    if (_Wt[i] == 0) {
+      _Solution[i] = true;
+      oFixedValue = oFixedValue + _Val[i];
+    }
+    else
+      order.push_back(i);
+  }
+  reduce_by_bounds(order, oCore, oFixedValue, oFixedWeight, typename std::is_arithmetic<T>::type());
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::reduce_by_bounds(std::vector<size_t> & ioOrder, std::vector<size_t> & oCore, T &, unsigned int &, std::false_type)
+{
+  oCore.swap(ioOrder);
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::reduce_by_bounds(std::vector<size_t> & ioOrder, std::vector<size_t> & oCore, T & ioFixedValue, unsigned int & ioFixedWeight, std::true_type)
+{
+  std::vector<size_t> & order = ioOrder;
+  std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+      return (double)_Val[a] * _Wt[b] > (double)_Val[b] * _Wt[a];
+    });
+
+  // Break item, and greedy solution with the items after it which still fit
+  size_t b = 0;
+  unsigned long long weight = 0;
+  T value = T();
+  while (b < order.size() && weight + _Wt[order[b]] <= _W) {
+    weight += _Wt[order[b]];
+    value = value + _Val[order[b]];
+    b++;
+  }
+  if (b == order.size()) {
+    // All the items fit
+    for (size_t k = 0; k < order.size(); k++)
+      _Solution[order[k]] = true;
+    ioFixedValue = ioFixedValue + value;
+    ioFixedWeight = (unsigned int)weight;
+    return;
+  }
+  const double residual = (double)(_W - weight);
+  const double density = (double)_Val[order[b]] / _Wt[order[b]];
+  T lower = value;
+  unsigned long long greedy_weight = weight;
+  for (size_t k = b+1; k < order.size(); k++)
+    if (greedy_weight + _Wt[order[k]] <= _W) {
+      greedy_weight += _Wt[order[k]];
+      lower = lower + _Val[order[k]];
+    }
+
+  // Bounds of Dantzig when the choice of the greedy solution is changed for an item: the
+  // capacity freed (or missing) is valued at the density of the break item
+  const double bound_lower = (double)lower;
+  const double tolerance = std::is_integral<T>::value ? 0. : 1e-9 * std::max(1., std::fabs(bound_lower));
+  for (size_t k = 0; k < order.size(); k++) {
+    const size_t i = order[k];
+    if (k == b) {
+      oCore.push_back(i);
+      continue;
+    }
+    double upper = (double)value + residual * density;
+    if (k < b)
+      upper += -(double)_Val[i] + _Wt[i] * density;
+    else
+      upper += (double)_Val[i] - _Wt[i] * density;
+    if (std::is_integral<T>::value)
+      upper = std::floor(upper + 1e-9);
+    if (!(upper < bound_lower - tolerance))
+      oCore.push_back(i);
+    else if (k < b) {
+      _Solution[i] = true;
+      ioFixedValue = ioFixedValue + _Val[i];
+      ioFixedWeight += _Wt[i];
+    }
+  }
+  std::sort(oCore.begin(), oCore.end());
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::solve_full_table()
 {
   size_t nb_obj = _Wt.size(); // number of objects
-  std::vector< std::vector<T> > K(nb_obj+1, std::vector<T>(_W+1,0));
+  typedef typename Rebind<Value_vector>::vector Table;
+  Table K(nb_obj+1, Value_vector((size_t)_W+1, T(), _Val.get_allocator()), _Val.get_allocator());
  
-  // Build table K[][] in bottom up mainner
-  for (size_t i = 0; i <= nb_obj; i++)
+  // Build table K[][] in bottom up mainner: the row i is the row i-1, improved by the item i-1
+  // for the weights greater or equal to its weight. The blocks of a row are shared among the
+  // threads, which wait for each other at the end of each row.
+  const long nb_blocks = nb_row_blocks(_W);
+  const size_t block_size = _policy.get_grain_size();
+  PARALLEL_TOOLS_OMP(parallel num_threads(_policy.get_nb_threads()) if(nb_blocks > 1))
+  for (size_t i = 1; i <= nb_obj; i++)
   {
-    for (unsigned int w = 0; w <= _W; w++)
-    {
-      if (i==0 || w==0)
-        K[i][w] = 0;
-      else if (_Wt[i-1] <= w)
-        K[i][w] = std::max(_Val[i-1]+K[i-1][w-_Wt[i-1]],  K[i-1][w]);
-      else
-        K[i][w] = K[i-1][w];
-    }
+    PARALLEL_TOOLS_OMP(for schedule(static))
+    for (long b = 0; b < nb_blocks; b++)
+      add_to_row(K[i-1].data(), K[i].data(), _Wt[i-1], _Val[i-1],
+                 b*block_size, std::min((size_t)_W+1, (b+1)*block_size));
   }
   _opt_value = K[nb_obj][_W];
 
-  // Create the object list
-  size_t i = nb_obj; unsigned int w = _W;
-  while (w > 0 && K[i][w]==K[i][w-1])
-    w--;
-  while (w > 0)
+  // Create the object list: the item i-1 is chosen if it changes the value of the table
+  unsigned int w = _W;
+  for (size_t i = nb_obj; i > 0; i--)
   {
-    while (i > 0 && K[i][w]==K[i-1][w]) {
+    if (K[i][w] == K[i-1][w])
       _Solution[i-1] = false;
-      i--;
+    else {
+      _Solution[i-1] = true;
+      w -= _Wt[i-1];
     }
-    w -= _Wt[i-1];
-    _Solution[i-1] = true;
-    i--;
   }
 }
 
 
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::solve_rolling_row()
+{
+  Value_vector K(_Val.get_allocator());
+  compute_row(0, _Wt.size(), _W, K);
+  _opt_value = K[_W];
+  if (!_value_only) {
+    Value_vector(_Val.get_allocator()).swap(K);
+    choose_objects(0, _Wt.size(), _W);
+  }
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::solve_bit_table()
+{
+  compute_bit_table();
+  _opt_value = _row[_W];
+  choose_objects_from_bits(_W, _Solution);
+  Value_vector(_Val.get_allocator()).swap(_row);
+  typename Rebind<uint64_t>::vector(_Val.get_allocator()).swap(_taken);
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::compute_bit_table()
+{
+  const size_t nb_obj = _Wt.size();
+  _nb_words = (size_t)_W/64 + 1;
+  _taken.assign(nb_obj*_nb_words, 0);
+  _row.assign((size_t)_W+1, T());
+  Value_vector other(_row, _Val.get_allocator());
+  T* rows[2] = { _row.data(), other.data() };
+
+  // Blocks of a multiple of 64 weights, so that each word of bits is written by one thread
+  const size_t block_size = (_policy.get_grain_size() + 63) / 64 * 64;
+  const long nb_blocks = ((long)_W + block_size) / block_size;
+  PARALLEL_TOOLS_OMP(parallel num_threads(_policy.get_nb_threads()) if(nb_blocks > 1))
+  for (size_t i = 0; i < nb_obj; i++)
+  {
+    const T* prev = rows[i % 2];
+    T* cur = rows[(i+1) % 2];
+    PARALLEL_TOOLS_OMP(for schedule(static))
+    for (long b = 0; b < nb_blocks; b++) {
+      const size_t end = std::min((size_t)_W+1, (b+1)*block_size);
+      add_to_row(prev, cur, _Wt[i], _Val[i], b*block_size, end);
+      mark_taken(prev, cur, b*block_size, end, _taken.data() + i*_nb_words);
+    }
+  }
+  if (nb_obj % 2 == 1)
+    _row.swap(other);
+}
+
+
+template< class T, class Alloc >
+template <class Vector>
+inline void Knapsack<T,Alloc>::choose_objects_from_bits(unsigned int iW, Vector & oSolution) const
+{
+  // Create the object list from the last item
+  oSolution.assign(_Wt.size(), false);
+  unsigned int w = iW;
+  for (size_t i = _Wt.size(); i > 0; i--)
+    if ((_taken[(i-1)*_nb_words + w/64] >> (w%64)) & 1) {
+      oSolution[i-1] = true;
+      w -= _Wt[i-1];
+    }
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::compute_row(size_t iBegin, size_t iEnd, unsigned int iW, Value_vector & oK) const
+{
+  oK.assign((size_t)iW+1, T());
+  const long nb_blocks = nb_row_blocks(iW);
+  if (nb_blocks <= 1 || _policy.get_nb_threads() <= 1) {
+    for (size_t i = iBegin; i < iEnd; i++)
+      add_to_row(oK.data(), iW, _Wt[i], _Val[i]);
+    return;
+  }
+
+  // Two rows: the threads read the previous row and write the blocks of the new one
+  Value_vector other(oK, _Val.get_allocator());
+  T* rows[2] = { oK.data(), other.data() };
+  const size_t block_size = _policy.get_grain_size();
+  PARALLEL_TOOLS_OMP(parallel num_threads(_policy.get_nb_threads()))
+  for (size_t i = iBegin; i < iEnd; i++)
+  {
+    const T* prev = rows[(i-iBegin) % 2];
+    T* cur = rows[(i-iBegin+1) % 2];
+    PARALLEL_TOOLS_OMP(for schedule(static))
+    for (long b = 0; b < nb_blocks; b++)
+      add_to_row(prev, cur, _Wt[i], _Val[i], b*block_size, std::min((size_t)iW+1, (b+1)*block_size));
+  }
+  if ((iEnd-iBegin) % 2 == 1)
+    oK.swap(other);
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::add_to_row(T* ioK, unsigned int iW, unsigned int iWt, const T& iVal)
+{
+  if (iWt > iW)
+    return;
+  if (iWt == 0) {
+    Simd_kernels<T>::max_add(iVal, ioK, ioK, (size_t)iW+1);
+    return;
+  }
+  if (iWt < KNAPSACK_MIN_SIMD_WEIGHT) {
+    // From the largest weight, so that ioK[w-iWt] does not contain the item yet
+    for (size_t w = (size_t)iW+1; w-- > iWt; )
+      ioK[w] = std::max(iVal+ioK[w-iWt], ioK[w]);
+    return;
+  }
+  // Blocks of iWt weights from the largest ones: a block only reads the elements below it,
+  // which are not updated yet, so each block is a shifted vector maximum without overlap
+  size_t end = (size_t)iW+1;
+  while (end > iWt) {
+    const size_t begin = std::max((size_t)iWt, end - iWt);
+    Simd_kernels<T>::max_add(iVal, ioK+begin-iWt, ioK+begin, end-begin);
+    end = begin;
+  }
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::add_to_row(const T* iPrev, T* oCur, unsigned int iWt, const T& iVal, size_t iBegin, size_t iEnd)
+{
+  std::copy(iPrev+iBegin, iPrev+iEnd, oCur+iBegin);
+  const size_t begin = std::max(iBegin, (size_t)iWt);
+  if (begin < iEnd)
+    Simd_kernels<T>::max_add(iVal, iPrev+begin-iWt, oCur+begin, iEnd-begin);
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::mark_taken(const T* iPrev, const T* iCur, size_t iBegin, size_t iEnd, uint64_t* oTaken)
+{
+  for (size_t w0 = iBegin; w0 < iEnd; w0 += 64) {
+    const size_t w1 = std::min(iEnd, w0 + 64);
+    uint64_t word = 0;
+    for (size_t w = w0; w < w1; w++)
+      word |= (uint64_t)(iPrev[w] < iCur[w]) << (w - w0);
+    oTaken[w0/64] = word;
+  }
+}
+
+
+template< class T, class Alloc >
+inline long Knapsack<T,Alloc>::nb_row_blocks(unsigned int iW) const
+{
+  return ((long)iW + _policy.get_grain_size()) / _policy.get_grain_size();
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack<T,Alloc>::choose_objects(size_t iBegin, size_t iEnd, unsigned int iW)
+{
+  if (iEnd - iBegin == 1) {
+    _Solution[iBegin] = _Wt[iBegin] <= iW && T() < _Val[iBegin];
+    return;
+  }
+  if (iEnd == iBegin)
+    return;
+
+  // Best split of the capacity between the two halves
+  const size_t middle = iBegin + (iEnd - iBegin) / 2;
+  unsigned int w_first = 0;
+  {
+    Value_vector first(_Val.get_allocator()), second(_Val.get_allocator());
+    compute_row(iBegin, middle, iW, first);
+    compute_row(middle, iEnd, iW, second);
+    T best = first[0] + second[iW];
+    for (unsigned int w = 1; w <= iW; w++)
+      if (best < first[w] + second[iW-w]) {
+        best = first[w] + second[iW-w];
+        w_first = w;
+      }
+  }
+  choose_objects(iBegin, middle, w_first);
+  choose_objects(middle, iEnd, iW - w_first);
+}
+
+
 
 #endif // KNAPSACK_H
 
@@ -0,0 +1,299 @@
+/**
+ * @file knapsack_bounded.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Template functor to solve the bounded Knapsack problem (several copies of each item).
+ */
+
+#ifndef KNAPSACK_BOUNDED_H
+#define KNAPSACK_BOUNDED_H
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+#include "knapsack.h"
+
+
+/**
+ * @brief Template functor to solve the bounded Knapsack problem: up to iCount[i] copies of the
+ * item i can be chosen.
+ * @details WARNING! T must be a class with:
+ * - a default constructor
+ * - an operator +
+ * - an operator <
+ *
+ * The copies of an item are split in groups of 1, 2, 4, ..., 2^(k-1) copies and a last group of
+ * the remaining copies (binary splitting): any number of copies up to the count is a sum of
+ * distinct groups, so the groups are solved as a 0/1 problem by #Knapsack with O(log count)
+ * items per item instead of count items. The counts are first limited to the number of copies
+ * which fit in the knapsack.
+ *
+ * The table of the 0/1 problem is #KNAPSACK_BIT_TABLE by default (see set_table_mode()).
+ *
+ * A minimal example is given by the following code:
+ * @code{cpp}
+ * std::vector<unsigned int> wt(2);    wt[0] = 3;  wt[1] = 5;
+ * std::vector<int> val(2);            val[0] = 4; val[1] = 7;
+ * std::vector<unsigned int> count(2); count[0] = 10; count[1] = 1;
+ * Knapsack_bounded<int> knapsack(12, wt, val, count);
+ * int opt = knapsack();                    // 16: 4 copies of item 0
+ * std::vector<unsigned int> Solution;
+ * knapsack.get_chosen_objects(Solution);   // 4 0
+ * @endcode
+ */
+template< class T, class Alloc = std::allocator<T> >
+class Knapsack_bounded
+{
+public:
+  /**
+   * @brief Default constructor
+   * @param[in] iAlloc Allocator of the internal vectors
+   */
+  inline Knapsack_bounded(const Alloc& iAlloc = Alloc());
+
+  /**
+   * @brief Constructor
+   * @param[in] iW Weight limit of the knapsack
+   * @param[in] iWt Vector of item weights
+   * @param[in] iVal Vector of item values
+   * @param[in] iCount Vector of the numbers of copies of the items
+   * @param[in] iAlloc Allocator of the internal vectors
+   */
+  inline Knapsack_bounded(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const std::vector<unsigned int> & iCount, const Alloc& iAlloc = Alloc());
+
+  /** @brief Destructor */
+  inline ~Knapsack_bounded();
+
+  /**
+   * @brief Solve the knapsack problem with the parameters stored in the attribute of the fonctor
+   * @return Optimal value of the knapsack
+   */
+  inline T operator()();
+
+  /**
+   * @brief Solve the knapsack problem with the parameters in argument
+   * @details This method modifies the attribute of the fonctor
+   * @param[in] iW Weight limit of the knapsack
+   * @param[in] iWt Vector of item weights
+   * @param[in] iVal Vector of item values
+   * @param[in] iCount Vector of the numbers of copies of the items
+   * @return Optimal value of the knapsack
+   */
+  inline T operator()(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const std::vector<unsigned int> & iCount);
+
+  /**
+   * @brief Return the optimal value of the knapsack
+   * @warning The user must solve the knapsack calling the operator operator()()
+   */
+  inline T get_optimal_value();
+
+  /**
+   * @brief Return the number of chosen copies of each item
+   * @param[out] oSolution Number of chosen copies of each item
+   * @warning The user must solve the knapsack calling the operator operator()()
+   */
+  inline void get_chosen_objects(std::vector<unsigned int> & oSolution);
+
+  /**
+   * @brief Set the storage of the dynamic programming table of the 0/1 problem
+   * @param[in] iMode #KNAPSACK_FULL_TABLE, #KNAPSACK_ROLLING_ROW or #KNAPSACK_BIT_TABLE (default)
+   */
+  inline void set_table_mode(Knapsack_table_mode iMode);
+
+  /** @brief Return the storage of the dynamic programming table of the 0/1 problem */
+  inline Knapsack_table_mode get_table_mode() const;
+
+  /** @brief Return the number of items of the 0/1 problem of the last resolution */
+  inline size_t get_nb_split_items() const;
+
+protected:
+  /** @brief Vector of T allocated with Alloc */
+  typedef std::vector<T, Alloc> Value_vector;
+  /** @brief Vector of U allocated with Alloc rebound to U */
+  template <class U> struct Rebind { typedef std::vector<U, typename std::allocator_traits<Alloc>::template rebind_alloc<U> > vector; };
+
+  /** @brief Return iK copies of the value iVal (by doubling, with the operator + only) */
+  static inline T multiple(const T& iVal, unsigned int iK);
+
+  /** @brief Solve the knapsack problem with the parameters stored in the attribute of the fonctor */
+  inline void solve();
+
+  unsigned int _W; /**< @brief [input] Total weight of the knapsack */
+  typename Rebind<unsigned int>::vector _Wt; /**< @brief [input] Vector of item weights */
+  Value_vector _Val; /**< @brief [input] Vector of item values */
+  typename Rebind<unsigned int>::vector _Count; /**< @brief [input] Vector of the numbers of copies */
+
+  Knapsack<T,Alloc> _knapsack; /**< @brief 0/1 problem of the groups of copies */
+  typename Rebind<unsigned int>::vector _Item; /**< @brief Item of each group of copies */
+  typename Rebind<unsigned int>::vector _Copies; /**< @brief Number of copies of each group */
+  typename Rebind<unsigned int>::vector _split_wt; /**< @brief Weight of each group of copies */
+  Value_vector _split_val; /**< @brief Value of each group of copies */
+
+  T _opt_value; /**< @brief [output] Optimal value of the knapsack */
+  typename Rebind<unsigned int>::vector _Solution; /**< @brief [output] Number of chosen copies of each item */
+};
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+
+template< class T, class Alloc >
+inline Knapsack_bounded<T,Alloc>::Knapsack_bounded(const Alloc& iAlloc)
+: _W(0),
+  _Wt(iAlloc),
+  _Val(iAlloc),
+  _Count(iAlloc),
+  _knapsack(iAlloc),
+  _Item(iAlloc),
+  _Copies(iAlloc),
+  _split_wt(iAlloc),
+  _split_val(iAlloc),
+  _opt_value(),
+  _Solution(iAlloc)
+{
+  _knapsack.set_table_mode(KNAPSACK_BIT_TABLE);
+}
+
+
+template< class T, class Alloc >
+inline Knapsack_bounded<T,Alloc>::Knapsack_bounded(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const std::vector<unsigned int> & iCount, const Alloc& iAlloc)
+: _W(iW),
+  _Wt(iWt.begin(), iWt.end(), iAlloc),
+  _Val(iVal.begin(), iVal.end(), iAlloc),
+  _Count(iCount.begin(), iCount.end(), iAlloc),
+  _knapsack(iAlloc),
+  _Item(iAlloc),
+  _Copies(iAlloc),
+  _split_wt(iAlloc),
+  _split_val(iAlloc),
+  _opt_value(),
+  _Solution(iAlloc)
+{
+  _knapsack.set_table_mode(KNAPSACK_BIT_TABLE);
+  // Assert that the sizes are equal
+  size_t nb_objects = std::min(std::min(iWt.size(), iVal.size()), iCount.size());
+  _Wt.resize(nb_objects);
+  _Val.resize(nb_objects);
+  _Count.resize(nb_objects);
+  _Solution.assign(nb_objects, 0);
+}
+
+
+template< class T, class Alloc >
+inline Knapsack_bounded<T,Alloc>::~Knapsack_bounded()
+{
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_bounded<T,Alloc>::operator()()
+{
+  solve();
+  return _opt_value;
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_bounded<T,Alloc>::operator()(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const std::vector<unsigned int> & iCount)
+{
+  _W = iW;
+  size_t nb_objects = std::min(std::min(iWt.size(), iVal.size()), iCount.size());
+  _Wt.assign(iWt.begin(), iWt.begin() + nb_objects);
+  _Val.assign(iVal.begin(), iVal.begin() + nb_objects);
+  _Count.assign(iCount.begin(), iCount.begin() + nb_objects);
+
+  solve();
+  return _opt_value;
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_bounded<T,Alloc>::get_optimal_value()
+{
+  return _opt_value;
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_bounded<T,Alloc>::get_chosen_objects(std::vector<unsigned int> & oSolution)
+{
+  oSolution.assign(_Solution.begin(), _Solution.end());
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_bounded<T,Alloc>::set_table_mode(Knapsack_table_mode iMode)
+{
+  _knapsack.set_table_mode(iMode);
+}
+
+
+template< class T, class Alloc >
+inline Knapsack_table_mode Knapsack_bounded<T,Alloc>::get_table_mode() const
+{
+  return _knapsack.get_table_mode();
+}
+
+
+template< class T, class Alloc >
+inline size_t Knapsack_bounded<T,Alloc>::get_nb_split_items() const
+{
+  return _Item.size();
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_bounded<T,Alloc>::multiple(const T& iVal, unsigned int iK)
+{
+  T result = T();
+  T power = iVal;
+  for (; iK > 0; iK >>= 1) {
+    if (iK & 1)
+      result = result + power;
+    if (iK > 1)
+      power = power + power;
+  }
+  return result;
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_bounded<T,Alloc>::solve()
+{
+  const size_t nb_obj = _Wt.size();
+  _Solution.assign(nb_obj, 0);
+  _Item.clear();
+  _Copies.clear();
+  _split_wt.clear();
+  _split_val.clear();
+
+  // Groups of 1, 2, 4, ... copies, then the remaining copies
+  for (size_t i = 0; i < nb_obj; i++) {
+    if (!(T() < _Val[i]) || _Wt[i] > _W)
+      continue;
+    unsigned int count = _Count[i];
+    if (_Wt[i] > 0)
+      count = std::min(count, _W / _Wt[i]);
+    for (unsigned int copies = 1; count > 0; copies *= 2) {
+      const unsigned int k = std::min(copies, count);
+      _Item.push_back((unsigned int)i);
+      _Copies.push_back(k);
+      _split_wt.push_back(k * _Wt[i]);
+      _split_val.push_back(multiple(_Val[i], k));
+      count -= k;
+    }
+  }
+
+  _opt_value = _knapsack(_W, _split_wt.data(), _split_val.data(), _split_wt.size());
+  std::vector<bool> chosen;
+  _knapsack.get_chosen_objects(chosen);
+  for (size_t k = 0; k < chosen.size(); k++)
+    if (chosen[k])
+      _Solution[_Item[k]] += _Copies[k];
+}
+
+
+#endif // KNAPSACK_BOUNDED_H
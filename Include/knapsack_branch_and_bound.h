@@ -0,0 +1,397 @@
+/**
+ * @file knapsack_branch_and_bound.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Template functor to solve the Knapsack problem by branch and bound.
+ */
+
+#ifndef KNAPSACK_BRANCH_AND_BOUND_H
+#define KNAPSACK_BRANCH_AND_BOUND_H
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <type_traits>
+#include <vector>
+
+
+/**
+ * @brief Template functor to solve the Knapsack problem by best-first branch and bound.
+ * @details Unlike #Knapsack, whose time and memory grow with the capacity, the time of the
+ * branch and bound only depends on the items and on how far the greedy solution is from the
+ * optimum: it suits instances with a huge capacity (for example 1e12) or with real weights,
+ * and a few hundred items.
+ *
+ * The items are sorted by decreasing value density (value / weight). The nodes of the search
+ * tree fix the items in this order, and are explored by decreasing upper bound. The upper
+ * bound of a node is the bound of Dantzig: the optimal value of the linear relaxation, that
+ * is, the free items are added by decreasing density while they fit, and the first item which
+ * does not fit (the break item) is added fractionally. The bound is found in O(log n) with
+ * prefix sums. A node is discarded when its bound is not greater than the best known solution,
+ * which starts at the greedy solution.
+ *
+ * WARNING! T must be convertible to double (for the bounds) and have:
+ * - a default constructor (zero)
+ * - an operator +
+ * - an operator <
+ *
+ * Weight is the type of the weights and of the capacity (double by default, or an integer type
+ * such as unsigned long long).
+ *
+ * The interface is the one of #Knapsack:
+ * @code{cpp}
+ * std::vector<double> wt(3);  wt[0] = 4e11; wt[1] = 6e11; wt[2] = 5e11;
+ * std::vector<int> val(3);    val[0] = 40;  val[1] = 50;  val[2] = 45;
+ * Knapsack_branch_and_bound<int> knapsack(1e12, wt, val);
+ * int opt = knapsack();                    // 90 (items 0 and 1)
+ * std::vector<bool> Solution;
+ * knapsack.get_chosen_objects(Solution);   // 1 1 0
+ * @endcode
+ */
+template <class T, class Weight = double>
+class Knapsack_branch_and_bound
+{
+public:
+  /** @brief Default constructor */
+  inline Knapsack_branch_and_bound();
+
+  /**
+   * @brief Constructor
+   * @param[in] iW Weight limit of the knapsack
+   * @param[in] iWt Vector of item weights
+   * @param[in] iVal Vector of item values
+   */
+  inline Knapsack_branch_and_bound(const Weight iW, const std::vector<Weight> & iWt, const std::vector<T> & iVal);
+
+  /** @brief Destructor */
+  inline ~Knapsack_branch_and_bound();
+
+  /**
+   * @brief Solve the knapsack problem with the parameters stored in the attribute of the fonctor
+   * @return Optimal value of the knapsack
+   */
+  inline T operator()();
+
+  /**
+   * @brief Solve the knapsack problem with the parameters in argument
+   * @details This method modifies the attribute of the fonctor
+   * @param[in] iW Weight limit of the knapsack
+   * @param[in] iWt Vector of item weights
+   * @param[in] iVal Vector of item values
+   * @return Optimal value of the knapsack
+   */
+  inline T operator()(const Weight iW, const std::vector<Weight> & iWt, const std::vector<T> & iVal);
+
+  /**
+   * @brief Return the optimal value of the knapsack
+   * @warning The user must solve the knapsack calling the operator operator()()
+   */
+  inline T get_optimal_value();
+
+  /**
+   * @brief Return a vector representing the chosen elements
+   * @param[out] oSolution Vector representing the chosen elements. If coordinate i is true,
+   * the i-th element is chosen, otherwise, it is not.
+   * @warning The user must solve the knapsack calling the operator operator()()
+   */
+  inline void get_chosen_objects(std::vector<bool> & oSolution);
+
+  /**
+   * @brief Set the maximal number of nodes of the search tree
+   * @param[in] iMaxNodes Maximal number of nodes (0 for no limit, the default). When the limit is
+   * reached, the search stops with the best solution found, which may not be optimal.
+   */
+  inline void set_max_nodes(size_t iMaxNodes);
+
+  /** @brief Return true if the last resolution proved the optimality of the solution */
+  inline bool is_optimal() const;
+
+  /** @brief Return the number of nodes created by the last resolution */
+  inline size_t get_nb_nodes() const;
+
+protected:
+  /** @brief Node of the search tree, kept to rebuild the chosen items */
+  struct Node
+  {
+    int _parent; /**< @brief Index of the parent node (-1 for the root) */
+    bool _taken; /**< @brief True if the item of the level of the parent is taken */
+  };
+
+  /** @brief Open node of the search tree */
+  struct Open_node
+  {
+    double _bound;   /**< @brief Upper bound of the node */
+    T _value;        /**< @brief Value of the fixed items */
+    Weight _weight;  /**< @brief Weight of the fixed items */
+    size_t _level;   /**< @brief Number of fixed items (in the sorted order) */
+    int _node;       /**< @brief Index of the node in the tree */
+
+    /** @brief Order of the priority queue: the greatest bound first */
+    inline bool operator<(const Open_node& iNode) const { return _bound < iNode._bound; }
+  };
+
+  /** @brief Solve the knapsack problem with the parameters stored in the attribute of the fonctor */
+  inline void solve();
+
+  /**
+   * @brief Return the bound of Dantzig of a node
+   * @param[in] iLevel Number of fixed items
+   * @param[in] iValue Value of the fixed items
+   * @param[in] iWeight Weight of the fixed items
+   * @param[out] oIsExact True if all the free items fit (the bound is then reached)
+   */
+  inline double bound(size_t iLevel, const T& iValue, const Weight& iWeight, bool& oIsExact) const;
+
+  /**
+   * @brief Set the best solution: the items of the tree path of a node, then the free items
+   * which fit in the greedy order if iFillGreedily is true
+   * @return Value of the chosen items among the candidates
+   */
+  inline T set_best(int iNode, size_t iLevel, Weight iWeight, bool iFillGreedily);
+
+  Weight _W;                  /**< @brief [input] Total weight of the knapsack */
+  std::vector<Weight> _Wt;    /**< @brief [input] Vector of item weights */
+  std::vector<T> _Val;        /**< @brief [input] Vector of item values */
+  size_t _max_nodes;          /**< @brief [input] Maximal number of nodes (0 for no limit) */
+
+  std::vector<size_t> _order;      /**< @brief Candidate items by decreasing density */
+  std::vector<Weight> _sum_weight; /**< @brief Prefix sums of the weights in the order */
+  std::vector<T> _sum_value;       /**< @brief Prefix sums of the values in the order */
+  std::vector<Node> _tree;         /**< @brief Nodes of the search tree */
+
+  T _opt_value;                 /**< @brief [output] Optimal value of the knapsack */
+  std::vector<bool> _Solution;  /**< @brief [output] Array of the chosen elements */
+  bool _is_optimal;             /**< @brief [output] True if the optimality was proved */
+};
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+
+template <class T, class Weight>
+inline Knapsack_branch_and_bound<T,Weight>::Knapsack_branch_and_bound()
+: _W(),
+  _max_nodes(0),
+  _opt_value(),
+  _is_optimal(false)
+{}
+
+
+template <class T, class Weight>
+inline Knapsack_branch_and_bound<T,Weight>::Knapsack_branch_and_bound(const Weight iW, const std::vector<Weight> & iWt, const std::vector<T> & iVal)
+: _W(iW),
+  _Wt(iWt),
+  _Val(iVal),
+  _max_nodes(0),
+  _opt_value(),
+  _is_optimal(false)
+{
+  // Assert that the sizes are equal
+  size_t nb_objects = std::min(iWt.size(), iVal.size());
+  _Wt.resize(nb_objects);
+  _Val.resize(nb_objects);
+  _Solution.assign(nb_objects, false);
+}
+
+
+template <class T, class Weight>
+inline Knapsack_branch_and_bound<T,Weight>::~Knapsack_branch_and_bound()
+{
+}
+
+
+template <class T, class Weight>
+inline T Knapsack_branch_and_bound<T,Weight>::operator()()
+{
+  solve();
+  return _opt_value;
+}
+
+
+template <class T, class Weight>
+inline T Knapsack_branch_and_bound<T,Weight>::operator()(const Weight iW, const std::vector<Weight> & iWt, const std::vector<T> & iVal)
+{
+  _W = iW;
+  _Wt = iWt;
+  _Val = iVal;
+  size_t nb_objects = std::min(iWt.size(), iVal.size());
+  _Wt.resize(nb_objects);
+  _Val.resize(nb_objects);
+
+  solve();
+  return _opt_value;
+}
+
+
+template <class T, class Weight>
+inline T Knapsack_branch_and_bound<T,Weight>::get_optimal_value()
+{
+  return _opt_value;
+}
+
+
+template <class T, class Weight>
+inline void Knapsack_branch_and_bound<T,Weight>::get_chosen_objects(std::vector<bool> & oSolution)
+{
+  oSolution = _Solution;
+}
+
+
+template <class T, class Weight>
+inline void Knapsack_branch_and_bound<T,Weight>::set_max_nodes(size_t iMaxNodes)
+{
+  _max_nodes = iMaxNodes;
+}
+
+
+template <class T, class Weight>
+inline bool Knapsack_branch_and_bound<T,Weight>::is_optimal() const
+{
+  return _is_optimal;
+}
+
+
+template <class T, class Weight>
+inline size_t Knapsack_branch_and_bound<T,Weight>::get_nb_nodes() const
+{
+  return _tree.size();
+}
+
+
+template <class T, class Weight>
+inline void Knapsack_branch_and_bound<T,Weight>::solve()
+{
+  const size_t nb_obj = _Wt.size();
+  _Solution.assign(nb_obj, false);
+  _opt_value = T();
+  _tree.clear();
+
+  // Items without weight and with a positive value are always taken, items without positive
+  // value or heavier than the knapsack are never taken
+  _order.clear();
+  for (size_t i = 0; i < nb_obj; i++) {
+    if (!(T() < _Val[i]) || _W < _Wt[i])
+      continue;
+    if (!(Weight() < _Wt[i])) {
+      _Solution[i] = true;
+      _opt_value = _opt_value + _Val[i];
+    }
+    else
+      _order.push_back(i);
+  }
+  std::sort(_order.begin(), _order.end(), [this](size_t a, size_t b) {
+      return (double)_Val[a] * (double)_Wt[b] > (double)_Val[b] * (double)_Wt[a];
+    });
+  const size_t n = _order.size();
+  _sum_weight.assign(n+1, Weight());
+  _sum_value.assign(n+1, T());
+  for (size_t k = 0; k < n; k++) {
+    _sum_weight[k+1] = _sum_weight[k] + _Wt[_order[k]];
+    _sum_value[k+1] = _sum_value[k] + _Val[_order[k]];
+  }
+
+  // The greedy solution is the first incumbent
+  const T fixed_value = _opt_value;
+  Node root = { -1, false };
+  _tree.push_back(root);
+  T best_value = set_best(0, 0, Weight(), true);
+
+  std::priority_queue<Open_node> open;
+  bool is_exact;
+  Open_node start = { bound(0, T(), Weight(), is_exact), T(), Weight(), 0, 0 };
+  if (!is_exact && (double)best_value < start._bound)
+    open.push(start);
+  _is_optimal = true;
+
+  while (!open.empty()) {
+    const Open_node node = open.top();
+    open.pop();
+    if (node._bound <= (double)best_value)
+      break;  // All the other nodes have a smaller bound
+    if (_max_nodes > 0 && _tree.size() + 2 > _max_nodes) {
+      _is_optimal = false;
+      break;
+    }
+
+    // Children: the item of the level is taken (if it fits) or not
+    const size_t item = _order[node._level];
+    for (int taken = 1; taken >= 0; taken--) {
+      Open_node child = node;
+      child._level = node._level + 1;
+      if (taken) {
+        if (_W - node._weight < _Wt[item])
+          continue;
+        child._value = node._value + _Val[item];
+        child._weight = node._weight + _Wt[item];
+      }
+      child._bound = bound(child._level, child._value, child._weight, is_exact);
+      if (child._bound <= (double)best_value)
+        continue;
+      Node tree_node = { node._node, taken == 1 };
+      _tree.push_back(tree_node);
+      child._node = (int)_tree.size() - 1;
+
+      // The node is a solution, and all its free items fit or are fixed: its bound is reached
+      if (best_value < child._value) {
+        best_value = set_best(child._node, child._level, child._weight, false);
+      }
+      if (is_exact || child._level == n) {
+        T value = child._value + (_sum_value[n] - _sum_value[child._level]);
+        if (best_value < value)
+          best_value = set_best(child._node, child._level, child._weight, true);
+        continue;
+      }
+      open.push(child);
+    }
+  }
+  _opt_value = fixed_value + best_value;
+}
+
+
+template <class T, class Weight>
+inline double Knapsack_branch_and_bound<T,Weight>::bound(size_t iLevel, const T& iValue, const Weight& iWeight, bool& oIsExact) const
+{
+  const size_t n = _order.size();
+  // Last item b such that the items [iLevel, b[ fit in the remaining capacity
+  const Weight capacity = _W - iWeight + _sum_weight[iLevel];
+  const size_t b = std::upper_bound(_sum_weight.begin()+iLevel, _sum_weight.end(), capacity) - _sum_weight.begin() - 1;
+  double value = (double)(iValue + (_sum_value[b] - _sum_value[iLevel]));
+  oIsExact = (b == n);
+  if (b < n) {
+    const size_t item = _order[b];
+    value += (double)(capacity - _sum_weight[b]) * (double)_Val[item] / (double)_Wt[item];
+    if (std::is_integral<T>::value)
+      value = std::floor(value + 1e-9);
+  }
+  return value;
+}
+
+
+template <class T, class Weight>
+inline T Knapsack_branch_and_bound<T,Weight>::set_best(int iNode, size_t iLevel, Weight iWeight, bool iFillGreedily)
+{
+  for (size_t k = 0; k < _order.size(); k++)
+    _Solution[_order[k]] = false;
+  // Fixed items, from the node to the root
+  size_t level = iLevel;
+  for (int node = iNode; node > 0; node = _tree[node]._parent) {
+    level--;
+    _Solution[_order[level]] = _tree[node]._taken;
+  }
+  if (iFillGreedily)
+    for (size_t k = iLevel; k < _order.size(); k++)
+      if (!(_W - iWeight < _Wt[_order[k]])) {
+        _Solution[_order[k]] = true;
+        iWeight = iWeight + _Wt[_order[k]];
+      }
+  T value = T();
+  for (size_t k = 0; k < _order.size(); k++)
+    if (_Solution[_order[k]])
+      value = value + _Val[_order[k]];
+  return value;
+}
+
+
+#endif // KNAPSACK_BRANCH_AND_BOUND_H
@@ -0,0 +1,329 @@
+/**
+ * @file knapsack_incremental.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Template class to maintain the solution of a Knapsack problem when items are added and removed.
+ */
+
+#ifndef KNAPSACK_INCREMENTAL_H
+#define KNAPSACK_INCREMENTAL_H
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <memory>
+
+#include "simd_tools.h"
+
+
+/**
+ * @brief Template class to maintain the optimum of a Knapsack problem under additions and
+ * removals of items.
+ * @details WARNING! T must be a class with:
+ * - a default constructor
+ * - an operator +
+ * - an operator <
+ *
+ * The items are split at an index s in two stacks of rows of W+1 values, as in a queue made of
+ * two stacks:
+ * - the back stack: its row j is the best value of the items [s, s+j[ for each capacity,
+ * - the front stack: its row j is the best value of the items [s-j, s[ for each capacity.
+ *
+ * add_item() pushes a row on the back stack in O(W). remove_item() pops the rows containing the
+ * item from the stack of the item, then pushes again the rows of the following items of this
+ * stack: removing the first or the last item costs O(1), and removing the item i costs
+ * O(min(i, n-i) W) once the stacks are balanced (they are rebuilt around the middle when a
+ * removal would cost more than n/2 rows). The optimal value is the maximum over w of the sum
+ * of the tops of the two stacks for w and W-w, in O(W).
+ *
+ * The memory is (n+2) (W+1) values, as the full table of #Knapsack.
+ *
+ * A minimal example is given by the following code:
+ * @code{cpp}
+ * Knapsack_incremental<int> knapsack(50);  // Knapsack of weight limit 50, without item
+ * knapsack.add_item(20, 100);              // Item 0
+ * knapsack.add_item(20, 60);               // Item 1
+ * knapsack.add_item(30, 120);              // Item 2
+ * int opt = knapsack();                    // 220 (items 0 and 2)
+ * knapsack.remove_item(0);                 // The items 1 and 2 are now the items 0 and 1
+ * opt = knapsack();                        // 180
+ * std::vector<bool> Solution;
+ * knapsack.get_chosen_objects(Solution);   // 1 1
+ * @endcode
+ */
+template< class T, class Alloc = std::allocator<T> >
+class Knapsack_incremental
+{
+public:
+  /**
+   * @brief Constructor of a knapsack without item
+   * @param[in] iW Weight limit of the knapsack
+   * @param[in] iAlloc Allocator of the internal vectors
+   */
+  inline Knapsack_incremental(const unsigned int iW = 0, const Alloc& iAlloc = Alloc());
+
+  /**
+   * @brief Constructor
+   * @param[in] iW Weight limit of the knapsack
+   * @param[in] iWt Vector of item weights
+   * @param[in] iVal Vector of item values
+   * @param[in] iAlloc Allocator of the internal vectors
+   */
+  inline Knapsack_incremental(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const Alloc& iAlloc = Alloc());
+
+  /** @brief Destructor */
+  inline ~Knapsack_incremental();
+
+  /** @brief Return the number of items */
+  inline size_t nb_items() const;
+
+  /**
+   * @brief Add an item after the last one, in O(W)
+   * @param[in] iWt Weight of the item
+   * @param[in] iVal Value of the item
+   */
+  inline void add_item(unsigned int iWt, const T& iVal);
+
+  /**
+   * @brief Remove an item
+   * @details The indices of the following items are decreased by one.
+   * @param[in] iIndex Index of the item
+   */
+  inline void remove_item(size_t iIndex);
+
+  /**
+   * @brief Return the optimal value of the knapsack with the current items, in O(W)
+   */
+  inline T operator()();
+
+  /**
+   * @brief Return the optimal value of the knapsack with the current items, in O(W)
+   */
+  inline T get_optimal_value();
+
+  /**
+   * @brief Return a vector representing the chosen elements, in O(W + n)
+   * @param[out] oSolution Vector representing the chosen elements. If coordinate i is true,
+   * the i-th element is chosen, otherwise, it is not.
+   */
+  inline void get_chosen_objects(std::vector<bool> & oSolution);
+
+protected:
+  /** @brief Vector of T allocated with Alloc */
+  typedef std::vector<T, Alloc> Value_vector;
+
+  /** @brief Return the row j of a stack */
+  inline const T* row(const Value_vector& iStack, size_t iJ) const;
+
+  /**
+   * @brief Push on a stack the row of its top improved by an item
+   * @param[in,out] ioStack Stack of rows
+   * @param[in] iItem Index of the item
+   */
+  inline void push_row(Value_vector& ioStack, size_t iItem);
+
+  /**
+   * @brief Rebuild the two stacks with the split index iSplit
+   * @param[in] iSplit Number of items of the front stack
+   */
+  inline void rebuild(size_t iSplit);
+
+  /** @brief Find the best capacity of the front stack: its top for w plus the top of the back stack for W-w */
+  inline unsigned int best_split(T& oValue) const;
+
+  unsigned int _W; /**< @brief Total weight of the knapsack */
+  std::vector<unsigned int, typename std::allocator_traits<Alloc>::template rebind_alloc<unsigned int> > _Wt; /**< @brief Vector of item weights */
+  Value_vector _Val; /**< @brief Vector of item values */
+  size_t _split; /**< @brief Number of items of the front stack */
+  Value_vector _front; /**< @brief Front stack: _split+1 rows of W+1 values */
+  Value_vector _back;  /**< @brief Back stack: n-_split+1 rows of W+1 values */
+};
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+
+template< class T, class Alloc >
+inline Knapsack_incremental<T,Alloc>::Knapsack_incremental(const unsigned int iW, const Alloc& iAlloc)
+: _W(iW),
+  _Wt(iAlloc),
+  _Val(iAlloc),
+  _split(0),
+  _front((size_t)iW+1, T(), iAlloc),
+  _back((size_t)iW+1, T(), iAlloc)
+{}
+
+
+template< class T, class Alloc >
+inline Knapsack_incremental<T,Alloc>::Knapsack_incremental(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const Alloc& iAlloc)
+: _W(iW),
+  _Wt(iAlloc),
+  _Val(iAlloc),
+  _split(0),
+  _front((size_t)iW+1, T(), iAlloc),
+  _back(iAlloc)
+{
+  // Assert that the sizes are equal
+  const size_t nb_objects = std::min(iWt.size(), iVal.size());
+  _Wt.assign(iWt.begin(), iWt.begin() + nb_objects);
+  _Val.assign(iVal.begin(), iVal.begin() + nb_objects);
+  _back.reserve((nb_objects+1) * ((size_t)iW+1));
+  _back.assign((size_t)iW+1, T());
+  for (size_t i = 0; i < nb_objects; i++)
+    push_row(_back, i);
+}
+
+
+template< class T, class Alloc >
+inline Knapsack_incremental<T,Alloc>::~Knapsack_incremental()
+{
+}
+
+
+template< class T, class Alloc >
+inline size_t Knapsack_incremental<T,Alloc>::nb_items() const
+{
+  return _Wt.size();
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_incremental<T,Alloc>::add_item(unsigned int iWt, const T& iVal)
+{
+  _Wt.push_back(iWt);
+  _Val.push_back(iVal);
+  push_row(_back, _Wt.size()-1);
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_incremental<T,Alloc>::remove_item(size_t iIndex)
+{
+  const size_t n = _Wt.size();
+  if (iIndex >= n) {
+    std::cerr << "[WARNING] void Knapsack_incremental<T>::remove_item(size_t)" << std::endl
+              << "Item index out of range. No item removed." << std::endl;
+    assert(false);
+    return;
+  }
+
+  // Number of rows to push again after the removal, with the current stacks
+  const size_t cost = iIndex < _split ? iIndex : n-1 - iIndex;
+  if (cost > n/2)
+    rebuild(n/2 + (iIndex >= n/2 ? 1 : 0));
+
+  const size_t row_size = (size_t)_W+1;
+  _Wt.erase(_Wt.begin() + iIndex);
+  _Val.erase(_Val.begin() + iIndex);
+  if (iIndex < _split) {
+    // The rows [0, _split-iIndex-1] of the front stack do not contain the item
+    _front.resize((_split - iIndex) * row_size);
+    _split--;
+    for (size_t i = iIndex; i > 0; i--)
+      push_row(_front, i-1);
+  }
+  else {
+    // The rows [0, iIndex-_split] of the back stack do not contain the item
+    _back.resize((iIndex - _split + 1) * row_size);
+    for (size_t i = iIndex; i < n-1; i++)
+      push_row(_back, i);
+  }
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_incremental<T,Alloc>::operator()()
+{
+  return get_optimal_value();
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_incremental<T,Alloc>::get_optimal_value()
+{
+  T value;
+  best_split(value);
+  return value;
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_incremental<T,Alloc>::get_chosen_objects(std::vector<bool> & oSolution)
+{
+  const size_t n = _Wt.size();
+  oSolution.assign(n, false);
+  T value;
+  const unsigned int w_split = best_split(value);
+  unsigned int w_front = w_split;
+  unsigned int w_back = _W - w_split;
+
+  // Each stack: the item of the row j is chosen if it improves the value of the row j-1 (a row
+  // is never lower than the previous one, so only the operator < is needed)
+  for (size_t j = _split; j > 0; j--)
+    if (row(_front, j-1)[w_front] < row(_front, j)[w_front]) {
+      oSolution[_split-j] = true;
+      w_front -= _Wt[_split-j];
+    }
+  for (size_t j = n - _split; j > 0; j--)
+    if (row(_back, j-1)[w_back] < row(_back, j)[w_back]) {
+      oSolution[_split+j-1] = true;
+      w_back -= _Wt[_split+j-1];
+    }
+}
+
+
+template< class T, class Alloc >
+inline const T* Knapsack_incremental<T,Alloc>::row(const Value_vector& iStack, size_t iJ) const
+{
+  return iStack.data() + iJ*((size_t)_W+1);
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_incremental<T,Alloc>::push_row(Value_vector& ioStack, size_t iItem)
+{
+  const size_t row_size = (size_t)_W+1;
+  ioStack.resize(ioStack.size() + row_size);
+  const T* prev = ioStack.data() + ioStack.size() - 2*row_size;
+  T* cur = ioStack.data() + ioStack.size() - row_size;
+  std::copy(prev, prev + row_size, cur);
+  const unsigned int wt = _Wt[iItem];
+  if (wt <= _W)
+    Simd_kernels<T>::max_add(_Val[iItem], prev, cur + wt, row_size - wt);
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_incremental<T,Alloc>::rebuild(size_t iSplit)
+{
+  const size_t row_size = (size_t)_W+1;
+  _split = iSplit;
+  _front.assign(row_size, T());
+  for (size_t i = iSplit; i > 0; i--)
+    push_row(_front, i-1);
+  _back.assign(row_size, T());
+  for (size_t i = iSplit; i < _Wt.size(); i++)
+    push_row(_back, i);
+}
+
+
+template< class T, class Alloc >
+inline unsigned int Knapsack_incremental<T,Alloc>::best_split(T& oValue) const
+{
+  const T* front = row(_front, _split);
+  const T* back = row(_back, _Wt.size() - _split);
+  unsigned int best = 0;
+  oValue = front[0] + back[_W];
+  for (unsigned int w = 1; w <= _W; w++)
+    if (oValue < front[w] + back[_W-w]) {
+      oValue = front[w] + back[_W-w];
+      best = w;
+    }
+  return best;
+}
+
+
+#endif // KNAPSACK_INCREMENTAL_H
@@ -0,0 +1,256 @@
+/**
+ * @file knapsack_multiple_choice.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Template functor to solve the multiple-choice Knapsack problem (at most one item per group).
+ */
+
+#ifndef KNAPSACK_MULTIPLE_CHOICE_H
+#define KNAPSACK_MULTIPLE_CHOICE_H
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <stdint.h>
+
+#include "simd_tools.h"
+
+
+/**
+ * @brief Template functor to solve the multiple-choice Knapsack problem: the items are in
+ * groups, and at most one item of each group can be chosen.
+ * @details WARNING! T must be a class with:
+ * - a default constructor
+ * - an operator +
+ * - an operator <
+ * - an operator ==
+ *
+ * The table is the one of #KNAPSACK_BIT_TABLE for #Knapsack: each group updates a row of W+1
+ * values from the row of the previous groups, cur[w] = max(prev[w], prev[w-wt]+val) for all
+ * the items of the group (with the kernel Simd_kernels::max_add()), and a bit per item and per
+ * weight tells if the item gives the new value. The time is O(n W) and the memory two rows of
+ * W+1 values plus n (W+1) bits.
+ *
+ * A minimal example is given by the following code:
+ * @code{cpp}
+ * std::vector<unsigned int> wt(4);    wt[0] = 2; wt[1] = 4; wt[2] = 3; wt[3] = 5;
+ * std::vector<int> val(4);            val[0] = 3; val[1] = 6; val[2] = 4; val[3] = 8;
+ * std::vector<unsigned int> group(4); group[0] = 0; group[1] = 0; group[2] = 1; group[3] = 1;
+ * Knapsack_multiple_choice<int> knapsack(8, wt, val, group);
+ * int opt = knapsack();                    // 11: items 0 and 3
+ * std::vector<bool> Solution;
+ * knapsack.get_chosen_objects(Solution);   // 1 0 0 1
+ * @endcode
+ */
+template< class T, class Alloc = std::allocator<T> >
+class Knapsack_multiple_choice
+{
+public:
+  /**
+   * @brief Default constructor
+   * @param[in] iAlloc Allocator of the internal vectors
+   */
+  inline Knapsack_multiple_choice(const Alloc& iAlloc = Alloc());
+
+  /**
+   * @brief Constructor
+   * @param[in] iW Weight limit of the knapsack
+   * @param[in] iWt Vector of item weights
+   * @param[in] iVal Vector of item values
+   * @param[in] iGroup Vector of the groups of the items (any identifiers)
+   * @param[in] iAlloc Allocator of the internal vectors
+   */
+  inline Knapsack_multiple_choice(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const std::vector<unsigned int> & iGroup, const Alloc& iAlloc = Alloc());
+
+  /** @brief Destructor */
+  inline ~Knapsack_multiple_choice();
+
+  /**
+   * @brief Solve the knapsack problem with the parameters stored in the attribute of the fonctor
+   * @return Optimal value of the knapsack
+   */
+  inline T operator()();
+
+  /**
+   * @brief Solve the knapsack problem with the parameters in argument
+   * @details This method modifies the attribute of the fonctor
+   * @param[in] iW Weight limit of the knapsack
+   * @param[in] iWt Vector of item weights
+   * @param[in] iVal Vector of item values
+   * @param[in] iGroup Vector of the groups of the items (any identifiers)
+   * @return Optimal value of the knapsack
+   */
+  inline T operator()(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const std::vector<unsigned int> & iGroup);
+
+  /**
+   * @brief Return the optimal value of the knapsack
+   * @warning The user must solve the knapsack calling the operator operator()()
+   */
+  inline T get_optimal_value();
+
+  /**
+   * @brief Return a vector representing the chosen elements
+   * @param[out] oSolution Vector representing the chosen elements. If coordinate i is true,
+   * the i-th element is chosen, otherwise, it is not.
+   * @warning The user must solve the knapsack calling the operator operator()()
+   */
+  inline void get_chosen_objects(std::vector<bool> & oSolution);
+
+protected:
+  /** @brief Vector of T allocated with Alloc */
+  typedef std::vector<T, Alloc> Value_vector;
+  /** @brief Vector of U allocated with Alloc rebound to U */
+  template <class U> struct Rebind { typedef std::vector<U, typename std::allocator_traits<Alloc>::template rebind_alloc<U> > vector; };
+
+  /** @brief Solve the knapsack problem with the parameters stored in the attribute of the fonctor */
+  inline void solve();
+
+  unsigned int _W; /**< @brief [input] Total weight of the knapsack */
+  typename Rebind<unsigned int>::vector _Wt; /**< @brief [input] Vector of item weights */
+  Value_vector _Val; /**< @brief [input] Vector of item values */
+  typename Rebind<unsigned int>::vector _Group; /**< @brief [input] Vector of the groups of the items */
+
+  T _opt_value; /**< @brief [output] Optimal value of the knapsack */
+  typename Rebind<bool>::vector _Solution; /**< @brief [output] Array of the chosen elements */
+};
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+
+template< class T, class Alloc >
+inline Knapsack_multiple_choice<T,Alloc>::Knapsack_multiple_choice(const Alloc& iAlloc)
+: _W(0),
+  _Wt(iAlloc),
+  _Val(iAlloc),
+  _Group(iAlloc),
+  _opt_value(),
+  _Solution(iAlloc)
+{}
+
+
+template< class T, class Alloc >
+inline Knapsack_multiple_choice<T,Alloc>::Knapsack_multiple_choice(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const std::vector<unsigned int> & iGroup, const Alloc& iAlloc)
+: _W(iW),
+  _Wt(iWt.begin(), iWt.end(), iAlloc),
+  _Val(iVal.begin(), iVal.end(), iAlloc),
+  _Group(iGroup.begin(), iGroup.end(), iAlloc),
+  _opt_value(),
+  _Solution(iAlloc)
+{
+  // Assert that the sizes are equal
+  size_t nb_objects = std::min(std::min(iWt.size(), iVal.size()), iGroup.size());
+  _Wt.resize(nb_objects);
+  _Val.resize(nb_objects);
+  _Group.resize(nb_objects);
+  _Solution.assign(nb_objects, false);
+}
+
+
+template< class T, class Alloc >
+inline Knapsack_multiple_choice<T,Alloc>::~Knapsack_multiple_choice()
+{
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_multiple_choice<T,Alloc>::operator()()
+{
+  solve();
+  return _opt_value;
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_multiple_choice<T,Alloc>::operator()(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const std::vector<unsigned int> & iGroup)
+{
+  _W = iW;
+  size_t nb_objects = std::min(std::min(iWt.size(), iVal.size()), iGroup.size());
+  _Wt.assign(iWt.begin(), iWt.begin() + nb_objects);
+  _Val.assign(iVal.begin(), iVal.begin() + nb_objects);
+  _Group.assign(iGroup.begin(), iGroup.begin() + nb_objects);
+
+  solve();
+  return _opt_value;
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_multiple_choice<T,Alloc>::get_optimal_value()
+{
+  return _opt_value;
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_multiple_choice<T,Alloc>::get_chosen_objects(std::vector<bool> & oSolution)
+{
+  oSolution.assign(_Solution.begin(), _Solution.end());
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_multiple_choice<T,Alloc>::solve()
+{
+  const size_t nb_obj = _Wt.size();
+  _Solution.assign(nb_obj, false);
+
+  // Items sorted by group
+  typename Rebind<size_t>::vector order(nb_obj, 0, _Val.get_allocator());
+  for (size_t k = 0; k < nb_obj; k++)
+    order[k] = k;
+  std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return _Group[a] < _Group[b]; });
+
+  const size_t nb_words = (size_t)_W/64 + 1;
+  typename Rebind<uint64_t>::vector taken(nb_obj*nb_words, 0, _Val.get_allocator());
+  typename Rebind<uint64_t>::vector claimed(nb_words, 0, _Val.get_allocator());
+  Value_vector prev((size_t)_W+1, T(), _Val.get_allocator()), cur(prev, _Val.get_allocator());
+
+  typename Rebind<size_t>::vector groups(_Val.get_allocator()); // First item of each group in order
+  for (size_t k = 0; k < nb_obj; k++) {
+    if (k == 0 || _Group[order[k]] != _Group[order[k-1]])
+      groups.push_back(k);
+  }
+  groups.push_back(nb_obj);
+
+  for (size_t g = 0; g+1 < groups.size(); g++) {
+    // Best item of the group for each weight, from the row of the previous groups
+    std::copy(prev.begin(), prev.end(), cur.begin());
+    for (size_t k = groups[g]; k < groups[g+1]; k++) {
+      const unsigned int wt = _Wt[order[k]];
+      if (wt <= _W)
+        Simd_kernels<T>::max_add(_Val[order[k]], prev.data(), cur.data() + wt, (size_t)_W+1 - wt);
+    }
+
+    // Bits of the first item of the group giving each improved value
+    std::fill(claimed.begin(), claimed.end(), 0);
+    for (size_t k = groups[g]; k < groups[g+1]; k++) {
+      const size_t i = order[k];
+      const unsigned int wt = _Wt[i];
+      for (size_t w = wt; w <= _W; w++)
+        if (prev[w] < cur[w] && cur[w] == prev[w-wt] + _Val[i] && !((claimed[w/64] >> (w%64)) & 1)) {
+          claimed[w/64] |= (uint64_t)1 << (w%64);
+          taken[i*nb_words + w/64] |= (uint64_t)1 << (w%64);
+        }
+    }
+    prev.swap(cur);
+  }
+  _opt_value = prev[_W];
+
+  // Create the object list from the last group
+  unsigned int w = _W;
+  for (size_t g = groups.size()-1; g > 0; g--)
+    for (size_t k = groups[g-1]; k < groups[g]; k++) {
+      const size_t i = order[k];
+      if ((taken[i*nb_words + w/64] >> (w%64)) & 1) {
+        _Solution[i] = true;
+        w -= _Wt[i];
+        break;
+      }
+    }
+}
+
+
+#endif // KNAPSACK_MULTIPLE_CHOICE_H
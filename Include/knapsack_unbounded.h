@@ -0,0 +1,221 @@
+/**
+ * @file knapsack_unbounded.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Template functor to solve the unbounded Knapsack problem (any number of copies of each item).
+ */
+
+#ifndef KNAPSACK_UNBOUNDED_H
+#define KNAPSACK_UNBOUNDED_H
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <memory>
+
+
+/**
+ * @brief Template functor to solve the unbounded Knapsack problem: any number of copies of each
+ * item can be chosen.
+ * @details WARNING! T must be a class with:
+ * - a default constructor
+ * - an operator +
+ * - an operator <
+ *
+ * A single row of W+1 values is updated by each item from the smallest weight to the largest
+ * one, so that K[w-wt] already contains the copies of the item (single forward pass): the time
+ * is O(n W). The chosen items are rebuilt from the last item which improved each weight, in a
+ * row of W+1 indexes: the memory is O(n + W), whatever the number of items.
+ *
+ * The items without weight and with a positive value would make the value infinite: they are
+ * ignored, with a warning.
+ *
+ * A minimal example is given by the following code:
+ * @code{cpp}
+ * std::vector<unsigned int> wt(2);  wt[0] = 3;  wt[1] = 5;
+ * std::vector<int> val(2);          val[0] = 4; val[1] = 7;
+ * Knapsack_unbounded<int> knapsack(13, wt, val);
+ * int opt = knapsack();                    // 18: 1 copy of item 0 and 2 copies of item 1
+ * std::vector<unsigned int> Solution;
+ * knapsack.get_chosen_objects(Solution);   // 1 2
+ * @endcode
+ */
+template< class T, class Alloc = std::allocator<T> >
+class Knapsack_unbounded
+{
+public:
+  /**
+   * @brief Default constructor
+   * @param[in] iAlloc Allocator of the internal vectors
+   */
+  inline Knapsack_unbounded(const Alloc& iAlloc = Alloc());
+
+  /**
+   * @brief Constructor
+   * @param[in] iW Weight limit of the knapsack
+   * @param[in] iWt Vector of item weights
+   * @param[in] iVal Vector of item values
+   * @param[in] iAlloc Allocator of the internal vectors
+   */
+  inline Knapsack_unbounded(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const Alloc& iAlloc = Alloc());
+
+  /** @brief Destructor */
+  inline ~Knapsack_unbounded();
+
+  /**
+   * @brief Solve the knapsack problem with the parameters stored in the attribute of the fonctor
+   * @return Optimal value of the knapsack
+   */
+  inline T operator()();
+
+  /**
+   * @brief Solve the knapsack problem with the parameters in argument
+   * @details This method modifies the attribute of the fonctor
+   * @param[in] iW Weight limit of the knapsack
+   * @param[in] iWt Vector of item weights
+   * @param[in] iVal Vector of item values
+   * @return Optimal value of the knapsack
+   */
+  inline T operator()(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal);
+
+  /**
+   * @brief Return the optimal value of the knapsack
+   * @warning The user must solve the knapsack calling the operator operator()()
+   */
+  inline T get_optimal_value();
+
+  /**
+   * @brief Return the number of chosen copies of each item
+   * @param[out] oSolution Number of chosen copies of each item
+   * @warning The user must solve the knapsack calling the operator operator()()
+   */
+  inline void get_chosen_objects(std::vector<unsigned int> & oSolution);
+
+protected:
+  /** @brief Vector of T allocated with Alloc */
+  typedef std::vector<T, Alloc> Value_vector;
+  /** @brief Vector of U allocated with Alloc rebound to U */
+  template <class U> struct Rebind { typedef std::vector<U, typename std::allocator_traits<Alloc>::template rebind_alloc<U> > vector; };
+
+  /** @brief Solve the knapsack problem with the parameters stored in the attribute of the fonctor */
+  inline void solve();
+
+  unsigned int _W; /**< @brief [input] Total weight of the knapsack */
+  typename Rebind<unsigned int>::vector _Wt; /**< @brief [input] Vector of item weights */
+  Value_vector _Val; /**< @brief [input] Vector of item values */
+
+  T _opt_value; /**< @brief [output] Optimal value of the knapsack */
+  typename Rebind<unsigned int>::vector _Solution; /**< @brief [output] Number of chosen copies of each item */
+};
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+
+template< class T, class Alloc >
+inline Knapsack_unbounded<T,Alloc>::Knapsack_unbounded(const Alloc& iAlloc)
+: _W(0),
+  _Wt(iAlloc),
+  _Val(iAlloc),
+  _opt_value(),
+  _Solution(iAlloc)
+{}
+
+
+template< class T, class Alloc >
+inline Knapsack_unbounded<T,Alloc>::Knapsack_unbounded(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal, const Alloc& iAlloc)
+: _W(iW),
+  _Wt(iWt.begin(), iWt.end(), iAlloc),
+  _Val(iVal.begin(), iVal.end(), iAlloc),
+  _opt_value(),
+  _Solution(iAlloc)
+{
+  // Assert that the sizes are equal
+  size_t nb_objects = std::min(iWt.size(), iVal.size());
+  _Wt.resize(nb_objects);
+  _Val.resize(nb_objects);
+  _Solution.assign(nb_objects, 0);
+}
+
+
+template< class T, class Alloc >
+inline Knapsack_unbounded<T,Alloc>::~Knapsack_unbounded()
+{
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_unbounded<T,Alloc>::operator()()
+{
+  solve();
+  return _opt_value;
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_unbounded<T,Alloc>::operator()(const unsigned int iW, const std::vector<unsigned int> & iWt, const std::vector<T> & iVal)
+{
+  _W = iW;
+  size_t nb_objects = std::min(iWt.size(), iVal.size());
+  _Wt.assign(iWt.begin(), iWt.begin() + nb_objects);
+  _Val.assign(iVal.begin(), iVal.begin() + nb_objects);
+
+  solve();
+  return _opt_value;
+}
+
+
+template< class T, class Alloc >
+inline T Knapsack_unbounded<T,Alloc>::get_optimal_value()
+{
+  return _opt_value;
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_unbounded<T,Alloc>::get_chosen_objects(std::vector<unsigned int> & oSolution)
+{
+  oSolution.assign(_Solution.begin(), _Solution.end());
+}
+
+
+template< class T, class Alloc >
+inline void Knapsack_unbounded<T,Alloc>::solve()
+{
+  const size_t nb_obj = _Wt.size();
+  _Solution.assign(nb_obj, 0);
+  Value_vector K((size_t)_W+1, T(), _Val.get_allocator());
+  // Last item which improved each weight (nb_obj if none: the value is T())
+  typename Rebind<unsigned int>::vector last((size_t)_W+1, (unsigned int)nb_obj, _Val.get_allocator());
+
+  for (size_t i = 0; i < nb_obj; i++) {
+    const unsigned int wt = _Wt[i];
+    if (wt == 0 && T() < _Val[i]) {
+      std::cerr << "[WARNING] void Knapsack_unbounded<T>::solve()" << std::endl
+                << "Item " << i << " has no weight and a positive value. It is ignored." << std::endl;
+      continue;
+    }
+    if (wt == 0 || wt > _W)
+      continue;
+    // From the smallest weight, so that K[w-wt] may already contain copies of the item
+    for (size_t w = wt; w <= _W; w++)
+      if (K[w] < K[w-wt] + _Val[i]) {
+        K[w] = K[w-wt] + _Val[i];
+        last[w] = (unsigned int)i;
+      }
+  }
+  _opt_value = K[_W];
+
+  // Create the object list: K[w] is the value of its last item plus K[w - weight of the item]
+  size_t w = _W;
+  while (last[w] < nb_obj) {
+    _Solution[last[w]]++;
+    w -= _Wt[last[w]];
+  }
+}
+
+
+#endif // KNAPSACK_UNBOUNDED_H
@@ -11,6 +11,7 @@
 
 #include <assert.h>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 /**
@@ -22,22 +23,31 @@
  *   <tr><td>     <td>(1,2)<td>(1,3)
  *   <tr><td>     <td>     <td>(2,3)
  * </table>
+ *
+ * The vector of indexes is allocated with Alloc (for example a
+ * std::pmr::polymorphic_allocator on an arena). #N_choose_K_iterator uses the default
+ * allocator.
  */
-class N_choose_K_iterator
+template <class Alloc = std::allocator<unsigned int> >
+class Basic_N_choose_K_iterator
 {
 public:
-  /** @brief Default constructor */
-  inline N_choose_K_iterator();
+  /**
+   * @brief Default constructor
+   * @param[in] iAlloc Allocator of the vector of indexes
+   */
+  inline Basic_N_choose_K_iterator(const Alloc& iAlloc = Alloc());
   
   /**
    * @brief Constructor
    * @param[in] iN number of elements in the set
    * @param[in] iK number of elements to chose
+   * @param[in] iAlloc Allocator of the vector of indexes
    */
-  inline N_choose_K_iterator(unsigned int iN, unsigned int iK);
+  inline Basic_N_choose_K_iterator(unsigned int iN, unsigned int iK, const Alloc& iAlloc = Alloc());
   
   /** @brief Destructor */
-  inline ~N_choose_K_iterator();
+  inline ~Basic_N_choose_K_iterator();
   
   /** @brief Iterator on the set of k-combinations from a set of n elements */
   inline void operator++();
@@ -65,38 +75,47 @@ public:
 private:
   unsigned int _n;               /**< Number of elements in the set */
   unsigned int _k;               /**< Number of elements to chose */
-  std::vector<unsigned int> _v;  /**< Vector of indexes of current chosen elements */
+  std::vector<unsigned int, Alloc> _v;  /**< Vector of indexes of current chosen elements */
 };
 
 
+/** @brief Iterator on the k-combinations from a set of n elements using the default allocator */
+typedef Basic_N_choose_K_iterator<> N_choose_K_iterator;
+
+
 //==============================================================================
 // Implementation of methods
 //==============================================================================
 
 
-inline N_choose_K_iterator::N_choose_K_iterator():
+template <class Alloc>
+inline Basic_N_choose_K_iterator<Alloc>::Basic_N_choose_K_iterator(const Alloc& iAlloc):
   _n(0),
-  _k(0)
+  _k(0),
+  _v(iAlloc)
 {
 }
 
 
-inline N_choose_K_iterator::N_choose_K_iterator(unsigned int iN, unsigned int iK):
+template <class Alloc>
+inline Basic_N_choose_K_iterator<Alloc>::Basic_N_choose_K_iterator(unsigned int iN, unsigned int iK, const Alloc& iAlloc):
   _n(iN),
   _k(iK),
-  _v(iK+1,iN+1)
+  _v(iK+1,iN+1,iAlloc)
 {
   for (unsigned int i = 0; i < iK+1; i++)
     _v[i]=i;
 }
 
 
-inline N_choose_K_iterator::~N_choose_K_iterator()
+template <class Alloc>
+inline Basic_N_choose_K_iterator<Alloc>::~Basic_N_choose_K_iterator()
 {
 }
 
 
-inline void N_choose_K_iterator::operator++()
+template <class Alloc>
+inline void Basic_N_choose_K_iterator<Alloc>::operator++()
 {
   unsigned int l=_k;
   _v[l]++;
@@ -114,13 +133,15 @@ inline void N_choose_K_iterator::operator++()
 }
 
 
-inline unsigned int N_choose_K_iterator::operator()(unsigned int iIdx) {
+template <class Alloc>
+inline unsigned int Basic_N_choose_K_iterator<Alloc>::operator()(unsigned int iIdx) {
   assert(iIdx < _k);
   return _v[iIdx+1]-1;
 }
 
 
-inline void N_choose_K_iterator::print()
+template <class Alloc>
+inline void Basic_N_choose_K_iterator<Alloc>::print()
 {
   for(unsigned int i = 0; i < _k; i++)
     std::cout << operator()(i) << " ";
@@ -128,12 +149,14 @@ inline void N_choose_K_iterator::print()
 }
 
 
-inline bool N_choose_K_iterator::is_ended() {
+template <class Alloc>
+inline bool Basic_N_choose_K_iterator<Alloc>::is_ended() {
   return _v[0] > 0;
 }
 
 
-inline void N_choose_K_iterator::reset(bool iEnd)
+template <class Alloc>
+inline void Basic_N_choose_K_iterator<Alloc>::reset(bool iEnd)
 {
   _v[0] = iEnd ? -1 : 0;
   for (unsigned int i = 1; i < _k+1; i++)
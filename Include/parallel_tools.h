@@ -0,0 +1,166 @@
+/**
+ * @file parallel_tools.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Parameters of the multithreaded algorithms.
+ * @details The multithreaded algorithms use OpenMP: they run in parallel only if the code is
+ * compiled with the option -fopenmp. Otherwise, they run on a single thread.
+ */
+
+
+#ifndef PARALLEL_TOOLS_H
+#define PARALLEL_TOOLS_H
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+
+/* OpenMP directive which is ignored (without warning) when OpenMP is disabled */
+#ifdef _OPENMP
+#define PARALLEL_TOOLS_OMP(directive) _Pragma(PARALLEL_TOOLS_STRINGIFY(omp directive))
+#define PARALLEL_TOOLS_STRINGIFY(x) #x
+#else
+#define PARALLEL_TOOLS_OMP(directive)
+#endif
+
+#endif // DOXYGEN_SHOULD_SKIP_THIS
+
+
+/**
+ * @brief Parameters of the multithreaded algorithms
+ * @details The work is split in blocks of (approximatively) grain size elements, and the
+ * blocks are distributed among the threads. If the work is smaller than the grain size, it is
+ * done on the calling thread.
+ *
+ * If the policy is deterministic, the blocks only depend on the grain size, and the partial
+ * results of the reductions are combined in the order of the blocks. Thus, the result does not
+ * depend on the number of threads nor on their scheduling. Otherwise, the partial results are
+ * combined in the order in which the threads finish, which can change the rounding errors of
+ * floating point reductions from one run to another.
+ */
+class Parallel_policy
+{
+public:
+  /**
+   * @brief Constructor
+   * @param[in] iNbThreads Number of threads. If 0, the default number of threads of OpenMP is
+   * used.
+   * @param[in] iGrainSize Minimal number of elements processed by a block
+   * @param[in] iDeterministic If true, the result of the reductions do not depend on the
+   * number of threads
+   */
+  inline Parallel_policy(int iNbThreads = 0, long iGrainSize = 32768, bool iDeterministic = true);
+
+  /** @brief Destructor */
+  inline ~Parallel_policy();
+
+  /** @brief Return the number of threads which will be used (1 without OpenMP) */
+  inline int get_nb_threads() const;
+
+  /** @brief Return the minimal number of elements processed by a block */
+  inline long get_grain_size() const;
+
+  /** @brief Return true if the reductions do not depend on the number of threads */
+  inline bool is_deterministic() const;
+
+  /**
+   * @brief Set the number of threads
+   * @param[in] iNbThreads Number of threads. If 0, the default number of threads of OpenMP is
+   * used.
+   */
+  inline void set_nb_threads(int iNbThreads);
+
+  /**
+   * @brief Set the minimal number of elements processed by a block
+   * @param[in] iGrainSize Grain size (at least 1)
+   */
+  inline void set_grain_size(long iGrainSize);
+
+  /**
+   * @brief Set if the reductions must be deterministic
+   * @param[in] iDeterministic If true, the result of the reductions do not depend on the
+   * number of threads
+   */
+  inline void set_deterministic(bool iDeterministic);
+
+  /**
+   * @brief Return the number of items of a block
+   * @param[in] iItemSize Number of elements of an item (for example, a row)
+   * @return Number of items (at least 1) such that a block contains about grain size elements
+   */
+  inline long items_per_block(long iItemSize) const;
+
+protected:
+  int _nb_threads;     /**< @brief Number of threads (0 for the OpenMP default) */
+  long _grain_size;    /**< @brief Minimal number of elements processed by a block */
+  bool _deterministic; /**< @brief If true, the reductions do not depend on the threads */
+};
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+
+inline Parallel_policy::Parallel_policy(int iNbThreads, long iGrainSize, bool iDeterministic)
+: _nb_threads(iNbThreads > 0 ? iNbThreads : 0),
+  _grain_size(iGrainSize > 0 ? iGrainSize : 1),
+  _deterministic(iDeterministic)
+{}
+
+
+inline Parallel_policy::~Parallel_policy()
+{}
+
+
+inline int Parallel_policy::get_nb_threads() const
+{
+#ifdef _OPENMP
+  return _nb_threads > 0 ? _nb_threads : omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+
+inline long Parallel_policy::get_grain_size() const
+{
+  return _grain_size;
+}
+
+
+inline bool Parallel_policy::is_deterministic() const
+{
+  return _deterministic;
+}
+
+
+inline void Parallel_policy::set_nb_threads(int iNbThreads)
+{
+  _nb_threads = iNbThreads > 0 ? iNbThreads : 0;
+}
+
+
+inline void Parallel_policy::set_grain_size(long iGrainSize)
+{
+  _grain_size = iGrainSize > 0 ? iGrainSize : 1;
+}
+
+
+inline void Parallel_policy::set_deterministic(bool iDeterministic)
+{
+  _deterministic = iDeterministic;
+}
+
+
+inline long Parallel_policy::items_per_block(long iItemSize) const
+{
+  long nb_items = iItemSize > 0 ? _grain_size / iItemSize : _grain_size;
+  return nb_items > 0 ? nb_items : 1;
+}
+
+
+#endif // PARALLEL_TOOLS_H
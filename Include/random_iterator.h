@@ -10,6 +10,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 
@@ -18,18 +19,23 @@
  * @details N represent the number of element of the set.
  *
  * WARNING! Random must be initialize in the main function!
+ *
+ * The vector of the elements is allocated with Alloc (for example a
+ * std::pmr::polymorphic_allocator on an arena). #Random_iterator uses the default allocator.
  */
-class Random_iterator
+template <class Alloc = std::allocator<unsigned int> >
+class Basic_Random_iterator
 {
 public:
   /**
    * @brief Constructor
    * @param[in] iN Number of elements in the set. (Default value: 0)
+   * @param[in] iAlloc Allocator of the vector of the elements
    */
-  inline Random_iterator(unsigned int iN = 0);
+  inline Basic_Random_iterator(unsigned int iN = 0, const Alloc& iAlloc = Alloc());
   
   /** @brief Destructor */
-  inline ~Random_iterator();
+  inline ~Basic_Random_iterator();
   
   /** @brief Reset the operator */
   inline void reset();
@@ -44,20 +50,25 @@ public:
   inline int operator()();
   
 protected:
-  unsigned int _n;                         /**< @brief Number of elements (N) */
-  std::vector<unsigned int> _v;            /**< @brief Vector of N elements */
-  std::vector<unsigned int>::iterator _it; /**< @brief Iterator on the elements of the vector */
+  unsigned int _n;                     /**< @brief Number of elements (N) */
+  std::vector<unsigned int, Alloc> _v; /**< @brief Vector of N elements */
+  typename std::vector<unsigned int, Alloc>::iterator _it; /**< @brief Iterator on the elements of the vector */
 };
 
 
+/** @brief Random iterator on the set {0,...,N-1} using the default allocator */
+typedef Basic_Random_iterator<> Random_iterator;
+
+
 //==============================================================================
 // Implementation of methods
 //==============================================================================
 
 
-inline Random_iterator::Random_iterator(unsigned int iN):
+template <class Alloc>
+inline Basic_Random_iterator<Alloc>::Basic_Random_iterator(unsigned int iN, const Alloc& iAlloc):
   _n(iN),
-  _v(iN, 0),
+  _v(iN, 0, iAlloc),
   _it(_v.begin())
 {
   for (unsigned int i = 0; i < _n; i++)
@@ -66,29 +77,34 @@ inline Random_iterator::Random_iterator(unsigned int iN):
 }
 
 
-inline Random_iterator::~Random_iterator()
+template <class Alloc>
+inline Basic_Random_iterator<Alloc>::~Basic_Random_iterator()
 {
 }
 
 
-inline void Random_iterator::reset()
+template <class Alloc>
+inline void Basic_Random_iterator<Alloc>::reset()
 {
   std::random_shuffle(_v.begin(), _v.end());
   _it = _v.begin();
 }
 
 
-inline void Random_iterator::operator++() {
+template <class Alloc>
+inline void Basic_Random_iterator<Alloc>::operator++() {
   ++_it;
 }
 
 
-inline bool Random_iterator::is_ended() {
+template <class Alloc>
+inline bool Basic_Random_iterator<Alloc>::is_ended() {
   return (_it == _v.end());
 }
 
 
-inline int Random_iterator::operator()() {
+template <class Alloc>
+inline int Basic_Random_iterator<Alloc>::operator()() {
   return *_it;
 }
 
@@ -0,0 +1,889 @@
+/**
+ * @file simd_tools.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Vectorized kernels on contiguous arrays with runtime dispatch.
+ * @details The template class #Simd_kernels gives reductions (dot product, sum, minimum,
+ * maximum, squared norm), the axpy operation and the update of the knapsack rows (max_add)
+ * on contiguous arrays. For float, double and int, the kernels use AVX2 or SSE2 instructions
+ * when the processor supports them (tested at runtime); max_add also uses AVX-512 and supports
+ * the 64-bit integers. Otherwise, and for the other types, a scalar version with several
+ * accumulators is used.
+ *
+ * The SIMD kernels are only compiled with gcc or clang on x86 processors. They can be disabled
+ * by defining SIMD_TOOLS_NO_SIMD.
+ */
+
+
+#ifndef SIMD_TOOLS_H
+#define SIMD_TOOLS_H
+
+#include <algorithm>
+#include <cstddef>
+
+#if !defined(SIMD_TOOLS_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) \
+  && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_TOOLS_X86
+#include <immintrin.h>
+#endif
+
+
+//==============================================================================
+// Declaration of functions
+//==============================================================================
+
+
+/** @brief Return true if the processor supports the SSE2 instructions */
+inline bool simd_has_sse2();
+
+/** @brief Return true if the processor supports the AVX2 instructions */
+inline bool simd_has_avx2();
+
+/** @brief Return true if the processor supports the AVX-512 foundation instructions */
+inline bool simd_has_avx512();
+
+
+/**
+ * @brief Template for kernels on contiguous arrays.
+ * @details The generic version is scalar and only requires T to have a default constructor
+ * (which must be the neutral element of the addition), an operator +, an operator * and an
+ * operator <. The class is specialized with SIMD instructions for float, double and int.
+ *
+ * The reductions are computed with several partial accumulators: for floating types, the
+ * result can slightly differ from a sequential summation.
+ *
+ * @warning The methods min() and max() require at least one element.
+ */
+template <class T>
+class Simd_kernels
+{
+public:
+  /**
+   * @brief Return the dot product of two arrays
+   * @param[in] iX First array
+   * @param[in] iY Second array
+   * @param[in] iN Number of elements of the arrays
+   */
+  static inline T dot(const T* iX, const T* iY, size_t iN);
+
+  /**
+   * @brief Return the sum of the elements of an array
+   * @param[in] iX Array
+   * @param[in] iN Number of elements of the array
+   */
+  static inline T sum(const T* iX, size_t iN);
+
+  /**
+   * @brief Return the minimal element of an array
+   * @param[in] iX Array
+   * @param[in] iN Number of elements of the array (at least 1)
+   */
+  static inline T min(const T* iX, size_t iN);
+
+  /**
+   * @brief Return the maximal element of an array
+   * @param[in] iX Array
+   * @param[in] iN Number of elements of the array (at least 1)
+   */
+  static inline T max(const T* iX, size_t iN);
+
+  /**
+   * @brief Return the squared euclidean norm of an array (sum of the squares of its elements)
+   * @param[in] iX Array
+   * @param[in] iN Number of elements of the array
+   */
+  static inline T norm2(const T* iX, size_t iN);
+
+  /**
+   * @brief Compute Y = a*X + Y
+   * @param[in] iA Scalar a
+   * @param[in] iX Array X
+   * @param[in,out] ioY Array Y
+   * @param[in] iN Number of elements of the arrays
+   */
+  static inline void axpy(T iA, const T* iX, T* ioY, size_t iN);
+
+  /**
+   * @brief Compute Y = max(Y, X + a) element by element
+   * @details This is the update of a row of the dynamic programming of the knapsack problem by
+   * an item of value a.
+   * @param[in] iA Scalar a
+   * @param[in] iX Array X (which must not overlap Y, except if it is Y)
+   * @param[in,out] ioY Array Y
+   * @param[in] iN Number of elements of the arrays
+   */
+  static inline void max_add(T iA, const T* iX, T* ioY, size_t iN);
+
+protected:
+  /** @brief Scalar version of dot() */
+  static inline T dot_scalar(const T* iX, const T* iY, size_t iN);
+
+  /** @brief Scalar version of sum() */
+  static inline T sum_scalar(const T* iX, size_t iN);
+
+  /** @brief Scalar version of min() */
+  static inline T min_scalar(const T* iX, size_t iN);
+
+  /** @brief Scalar version of max() */
+  static inline T max_scalar(const T* iX, size_t iN);
+
+  /** @brief Scalar version of axpy() */
+  static inline void axpy_scalar(T iA, const T* iX, T* ioY, size_t iN);
+
+  /** @brief Scalar version of max_add() */
+  static inline void max_add_scalar(T iA, const T* iX, T* ioY, size_t iN);
+};
+
+
+
+//==============================================================================
+// Implementation of functions
+//==============================================================================
+
+
+#ifdef SIMD_TOOLS_X86
+
+inline bool simd_has_sse2()
+{
+  static const bool has_sse2 = __builtin_cpu_supports("sse2");
+  return has_sse2;
+}
+
+inline bool simd_has_avx2()
+{
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2;
+}
+
+inline bool simd_has_avx512()
+{
+  static const bool has_avx512 = __builtin_cpu_supports("avx512f");
+  return has_avx512;
+}
+
+#else
+
+inline bool simd_has_sse2() { return false; }
+
+inline bool simd_has_avx2() { return false; }
+
+inline bool simd_has_avx512() { return false; }
+
+#endif // SIMD_TOOLS_X86
+
+
+template <class T>
+inline T Simd_kernels<T>::dot(const T* iX, const T* iY, size_t iN)
+{
+  return dot_scalar(iX, iY, iN);
+}
+
+template <class T>
+inline T Simd_kernels<T>::sum(const T* iX, size_t iN)
+{
+  return sum_scalar(iX, iN);
+}
+
+template <class T>
+inline T Simd_kernels<T>::min(const T* iX, size_t iN)
+{
+  return min_scalar(iX, iN);
+}
+
+template <class T>
+inline T Simd_kernels<T>::max(const T* iX, size_t iN)
+{
+  return max_scalar(iX, iN);
+}
+
+template <class T>
+inline T Simd_kernels<T>::norm2(const T* iX, size_t iN)
+{
+  return dot(iX, iX, iN);
+}
+
+template <class T>
+inline void Simd_kernels<T>::axpy(T iA, const T* iX, T* ioY, size_t iN)
+{
+  axpy_scalar(iA, iX, ioY, iN);
+}
+
+template <class T>
+inline void Simd_kernels<T>::max_add(T iA, const T* iX, T* ioY, size_t iN)
+{
+  max_add_scalar(iA, iX, ioY, iN);
+}
+
+template <class T>
+inline T Simd_kernels<T>::dot_scalar(const T* iX, const T* iY, size_t iN)
+{
+  T s0 = T(), s1 = T(), s2 = T(), s3 = T();
+  size_t i = 0;
+  for (; i + 4 <= iN; i += 4) {
+    s0 += iX[i]   * iY[i];
+    s1 += iX[i+1] * iY[i+1];
+    s2 += iX[i+2] * iY[i+2];
+    s3 += iX[i+3] * iY[i+3];
+  }
+  for (; i < iN; i++)
+    s0 += iX[i] * iY[i];
+  return (s0 + s1) + (s2 + s3);
+}
+
+template <class T>
+inline T Simd_kernels<T>::sum_scalar(const T* iX, size_t iN)
+{
+  T s0 = T(), s1 = T(), s2 = T(), s3 = T();
+  size_t i = 0;
+  for (; i + 4 <= iN; i += 4) {
+    s0 += iX[i];
+    s1 += iX[i+1];
+    s2 += iX[i+2];
+    s3 += iX[i+3];
+  }
+  for (; i < iN; i++)
+    s0 += iX[i];
+  return (s0 + s1) + (s2 + s3);
+}
+
+template <class T>
+inline T Simd_kernels<T>::min_scalar(const T* iX, size_t iN)
+{
+  T m = iX[0];
+  for (size_t i = 1; i < iN; i++)
+    if (iX[i] < m)
+      m = iX[i];
+  return m;
+}
+
+template <class T>
+inline T Simd_kernels<T>::max_scalar(const T* iX, size_t iN)
+{
+  T m = iX[0];
+  for (size_t i = 1; i < iN; i++)
+    if (m < iX[i])
+      m = iX[i];
+  return m;
+}
+
+template <class T>
+inline void Simd_kernels<T>::axpy_scalar(T iA, const T* iX, T* ioY, size_t iN)
+{
+  for (size_t i = 0; i < iN; i++)
+    ioY[i] += iA * iX[i];
+}
+
+template <class T>
+inline void Simd_kernels<T>::max_add_scalar(T iA, const T* iX, T* ioY, size_t iN)
+{
+  for (size_t i = 0; i < iN; i++) {
+    const T x = iX[i] + iA;
+    if (ioY[i] < x)
+      ioY[i] = x;
+  }
+}
+
+
+
+#if defined(SIMD_TOOLS_X86) && !defined(DOXYGEN_SHOULD_SKIP_THIS)
+
+//------------------------------------------------------------------------------
+// SSE2 kernels
+//------------------------------------------------------------------------------
+
+__attribute__((target("sse2")))
+inline float simd_hsum_sse2(__m128 iV)
+{
+  __m128 v = _mm_add_ps(iV, _mm_movehl_ps(iV, iV));
+  v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+  return _mm_cvtss_f32(v);
+}
+
+__attribute__((target("sse2")))
+inline double simd_hsum_sse2(__m128d iV)
+{
+  return _mm_cvtsd_f64(_mm_add_sd(iV, _mm_unpackhi_pd(iV, iV)));
+}
+
+__attribute__((target("sse2")))
+inline float simd_dot_sse2(const float* iX, const float* iY, size_t iN)
+{
+  __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= iN; i += 8) {
+    s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(iX+i),   _mm_loadu_ps(iY+i)));
+    s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(iX+i+4), _mm_loadu_ps(iY+i+4)));
+  }
+  float s = simd_hsum_sse2(_mm_add_ps(s0, s1));
+  for (; i < iN; i++)
+    s += iX[i] * iY[i];
+  return s;
+}
+
+__attribute__((target("sse2")))
+inline double simd_dot_sse2(const double* iX, const double* iY, size_t iN)
+{
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= iN; i += 4) {
+    s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(iX+i),   _mm_loadu_pd(iY+i)));
+    s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(iX+i+2), _mm_loadu_pd(iY+i+2)));
+  }
+  double s = simd_hsum_sse2(_mm_add_pd(s0, s1));
+  for (; i < iN; i++)
+    s += iX[i] * iY[i];
+  return s;
+}
+
+__attribute__((target("sse2")))
+inline float simd_sum_sse2(const float* iX, size_t iN)
+{
+  __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= iN; i += 8) {
+    s0 = _mm_add_ps(s0, _mm_loadu_ps(iX+i));
+    s1 = _mm_add_ps(s1, _mm_loadu_ps(iX+i+4));
+  }
+  float s = simd_hsum_sse2(_mm_add_ps(s0, s1));
+  for (; i < iN; i++)
+    s += iX[i];
+  return s;
+}
+
+__attribute__((target("sse2")))
+inline double simd_sum_sse2(const double* iX, size_t iN)
+{
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= iN; i += 4) {
+    s0 = _mm_add_pd(s0, _mm_loadu_pd(iX+i));
+    s1 = _mm_add_pd(s1, _mm_loadu_pd(iX+i+2));
+  }
+  double s = simd_hsum_sse2(_mm_add_pd(s0, s1));
+  for (; i < iN; i++)
+    s += iX[i];
+  return s;
+}
+
+__attribute__((target("sse2")))
+inline void simd_axpy_sse2(float iA, const float* iX, float* ioY, size_t iN)
+{
+  const __m128 a = _mm_set1_ps(iA);
+  size_t i = 0;
+  for (; i + 4 <= iN; i += 4)
+    _mm_storeu_ps(ioY+i, _mm_add_ps(_mm_loadu_ps(ioY+i), _mm_mul_ps(a, _mm_loadu_ps(iX+i))));
+  for (; i < iN; i++)
+    ioY[i] += iA * iX[i];
+}
+
+__attribute__((target("sse2")))
+inline void simd_axpy_sse2(double iA, const double* iX, double* ioY, size_t iN)
+{
+  const __m128d a = _mm_set1_pd(iA);
+  size_t i = 0;
+  for (; i + 2 <= iN; i += 2)
+    _mm_storeu_pd(ioY+i, _mm_add_pd(_mm_loadu_pd(ioY+i), _mm_mul_pd(a, _mm_loadu_pd(iX+i))));
+  for (; i < iN; i++)
+    ioY[i] += iA * iX[i];
+}
+
+
+//------------------------------------------------------------------------------
+// AVX2 kernels
+//------------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+inline float simd_hsum_avx2(__m256 iV)
+{
+  __m128 v = _mm_add_ps(_mm256_castps256_ps128(iV), _mm256_extractf128_ps(iV, 1));
+  v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+  v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+  return _mm_cvtss_f32(v);
+}
+
+__attribute__((target("avx2")))
+inline double simd_hsum_avx2(__m256d iV)
+{
+  __m128d v = _mm_add_pd(_mm256_castpd256_pd128(iV), _mm256_extractf128_pd(iV, 1));
+  return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+__attribute__((target("avx2")))
+inline int simd_hsum_avx2(__m256i iV)
+{
+  __m128i v = _mm_add_epi32(_mm256_castsi256_si128(iV), _mm256_extracti128_si256(iV, 1));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1,0,3,2)));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2,3,0,1)));
+  return _mm_cvtsi128_si32(v);
+}
+
+__attribute__((target("avx2")))
+inline float simd_dot_avx2(const float* iX, const float* iY, size_t iN)
+{
+  __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+  __m256 s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= iN; i += 32) {
+    s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(iX+i),    _mm256_loadu_ps(iY+i)));
+    s1 = _mm256_add_ps(s1, _mm256_mul_ps(_mm256_loadu_ps(iX+i+8),  _mm256_loadu_ps(iY+i+8)));
+    s2 = _mm256_add_ps(s2, _mm256_mul_ps(_mm256_loadu_ps(iX+i+16), _mm256_loadu_ps(iY+i+16)));
+    s3 = _mm256_add_ps(s3, _mm256_mul_ps(_mm256_loadu_ps(iX+i+24), _mm256_loadu_ps(iY+i+24)));
+  }
+  for (; i + 8 <= iN; i += 8)
+    s0 = _mm256_add_ps(s0, _mm256_mul_ps(_mm256_loadu_ps(iX+i), _mm256_loadu_ps(iY+i)));
+  float s = simd_hsum_avx2(_mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3)));
+  for (; i < iN; i++)
+    s += iX[i] * iY[i];
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline double simd_dot_avx2(const double* iX, const double* iY, size_t iN)
+{
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+  __m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 16 <= iN; i += 16) {
+    s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(iX+i),    _mm256_loadu_pd(iY+i)));
+    s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(iX+i+4),  _mm256_loadu_pd(iY+i+4)));
+    s2 = _mm256_add_pd(s2, _mm256_mul_pd(_mm256_loadu_pd(iX+i+8),  _mm256_loadu_pd(iY+i+8)));
+    s3 = _mm256_add_pd(s3, _mm256_mul_pd(_mm256_loadu_pd(iX+i+12), _mm256_loadu_pd(iY+i+12)));
+  }
+  for (; i + 4 <= iN; i += 4)
+    s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(iX+i), _mm256_loadu_pd(iY+i)));
+  double s = simd_hsum_avx2(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+  for (; i < iN; i++)
+    s += iX[i] * iY[i];
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline int simd_dot_avx2(const int* iX, const int* iY, size_t iN)
+{
+  __m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 16 <= iN; i += 16) {
+    __m256i x0 = _mm256_loadu_si256((const __m256i*)(iX+i));
+    __m256i x1 = _mm256_loadu_si256((const __m256i*)(iX+i+8));
+    __m256i y0 = _mm256_loadu_si256((const __m256i*)(iY+i));
+    __m256i y1 = _mm256_loadu_si256((const __m256i*)(iY+i+8));
+    s0 = _mm256_add_epi32(s0, _mm256_mullo_epi32(x0, y0));
+    s1 = _mm256_add_epi32(s1, _mm256_mullo_epi32(x1, y1));
+  }
+  int s = simd_hsum_avx2(_mm256_add_epi32(s0, s1));
+  for (; i < iN; i++)
+    s += iX[i] * iY[i];
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline float simd_sum_avx2(const float* iX, size_t iN)
+{
+  __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+  __m256 s2 = _mm256_setzero_ps(), s3 = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 32 <= iN; i += 32) {
+    s0 = _mm256_add_ps(s0, _mm256_loadu_ps(iX+i));
+    s1 = _mm256_add_ps(s1, _mm256_loadu_ps(iX+i+8));
+    s2 = _mm256_add_ps(s2, _mm256_loadu_ps(iX+i+16));
+    s3 = _mm256_add_ps(s3, _mm256_loadu_ps(iX+i+24));
+  }
+  for (; i + 8 <= iN; i += 8)
+    s0 = _mm256_add_ps(s0, _mm256_loadu_ps(iX+i));
+  float s = simd_hsum_avx2(_mm256_add_ps(_mm256_add_ps(s0, s1), _mm256_add_ps(s2, s3)));
+  for (; i < iN; i++)
+    s += iX[i];
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline double simd_sum_avx2(const double* iX, size_t iN)
+{
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+  __m256d s2 = _mm256_setzero_pd(), s3 = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 16 <= iN; i += 16) {
+    s0 = _mm256_add_pd(s0, _mm256_loadu_pd(iX+i));
+    s1 = _mm256_add_pd(s1, _mm256_loadu_pd(iX+i+4));
+    s2 = _mm256_add_pd(s2, _mm256_loadu_pd(iX+i+8));
+    s3 = _mm256_add_pd(s3, _mm256_loadu_pd(iX+i+12));
+  }
+  for (; i + 4 <= iN; i += 4)
+    s0 = _mm256_add_pd(s0, _mm256_loadu_pd(iX+i));
+  double s = simd_hsum_avx2(_mm256_add_pd(_mm256_add_pd(s0, s1), _mm256_add_pd(s2, s3)));
+  for (; i < iN; i++)
+    s += iX[i];
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline int simd_sum_avx2(const int* iX, size_t iN)
+{
+  __m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i + 16 <= iN; i += 16) {
+    s0 = _mm256_add_epi32(s0, _mm256_loadu_si256((const __m256i*)(iX+i)));
+    s1 = _mm256_add_epi32(s1, _mm256_loadu_si256((const __m256i*)(iX+i+8)));
+  }
+  int s = simd_hsum_avx2(_mm256_add_epi32(s0, s1));
+  for (; i < iN; i++)
+    s += iX[i];
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline float simd_min_avx2(const float* iX, size_t iN)
+{
+  if (iN < 8)
+    return *std::min_element(iX, iX+iN);
+  __m256 m = _mm256_loadu_ps(iX);
+  size_t i = 8;
+  for (; i + 8 <= iN; i += 8)
+    m = _mm256_min_ps(m, _mm256_loadu_ps(iX+i));
+  float buf[8];
+  _mm256_storeu_ps(buf, m);
+  float s = *std::min_element(buf, buf+8);
+  for (; i < iN; i++)
+    s = std::min(s, iX[i]);
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline double simd_min_avx2(const double* iX, size_t iN)
+{
+  if (iN < 4)
+    return *std::min_element(iX, iX+iN);
+  __m256d m = _mm256_loadu_pd(iX);
+  size_t i = 4;
+  for (; i + 4 <= iN; i += 4)
+    m = _mm256_min_pd(m, _mm256_loadu_pd(iX+i));
+  double buf[4];
+  _mm256_storeu_pd(buf, m);
+  double s = *std::min_element(buf, buf+4);
+  for (; i < iN; i++)
+    s = std::min(s, iX[i]);
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline int simd_min_avx2(const int* iX, size_t iN)
+{
+  if (iN < 8)
+    return *std::min_element(iX, iX+iN);
+  __m256i m = _mm256_loadu_si256((const __m256i*)iX);
+  size_t i = 8;
+  for (; i + 8 <= iN; i += 8)
+    m = _mm256_min_epi32(m, _mm256_loadu_si256((const __m256i*)(iX+i)));
+  int buf[8];
+  _mm256_storeu_si256((__m256i*)buf, m);
+  int s = *std::min_element(buf, buf+8);
+  for (; i < iN; i++)
+    s = std::min(s, iX[i]);
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline float simd_max_avx2(const float* iX, size_t iN)
+{
+  if (iN < 8)
+    return *std::max_element(iX, iX+iN);
+  __m256 m = _mm256_loadu_ps(iX);
+  size_t i = 8;
+  for (; i + 8 <= iN; i += 8)
+    m = _mm256_max_ps(m, _mm256_loadu_ps(iX+i));
+  float buf[8];
+  _mm256_storeu_ps(buf, m);
+  float s = *std::max_element(buf, buf+8);
+  for (; i < iN; i++)
+    s = std::max(s, iX[i]);
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline double simd_max_avx2(const double* iX, size_t iN)
+{
+  if (iN < 4)
+    return *std::max_element(iX, iX+iN);
+  __m256d m = _mm256_loadu_pd(iX);
+  size_t i = 4;
+  for (; i + 4 <= iN; i += 4)
+    m = _mm256_max_pd(m, _mm256_loadu_pd(iX+i));
+  double buf[4];
+  _mm256_storeu_pd(buf, m);
+  double s = *std::max_element(buf, buf+4);
+  for (; i < iN; i++)
+    s = std::max(s, iX[i]);
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline int simd_max_avx2(const int* iX, size_t iN)
+{
+  if (iN < 8)
+    return *std::max_element(iX, iX+iN);
+  __m256i m = _mm256_loadu_si256((const __m256i*)iX);
+  size_t i = 8;
+  for (; i + 8 <= iN; i += 8)
+    m = _mm256_max_epi32(m, _mm256_loadu_si256((const __m256i*)(iX+i)));
+  int buf[8];
+  _mm256_storeu_si256((__m256i*)buf, m);
+  int s = *std::max_element(buf, buf+8);
+  for (; i < iN; i++)
+    s = std::max(s, iX[i]);
+  return s;
+}
+
+__attribute__((target("avx2")))
+inline void simd_axpy_avx2(float iA, const float* iX, float* ioY, size_t iN)
+{
+  const __m256 a = _mm256_set1_ps(iA);
+  size_t i = 0;
+  for (; i + 16 <= iN; i += 16) {
+    __m256 y0 = _mm256_add_ps(_mm256_loadu_ps(ioY+i),   _mm256_mul_ps(a, _mm256_loadu_ps(iX+i)));
+    __m256 y1 = _mm256_add_ps(_mm256_loadu_ps(ioY+i+8), _mm256_mul_ps(a, _mm256_loadu_ps(iX+i+8)));
+    _mm256_storeu_ps(ioY+i, y0);
+    _mm256_storeu_ps(ioY+i+8, y1);
+  }
+  for (; i < iN; i++)
+    ioY[i] += iA * iX[i];
+}
+
+__attribute__((target("avx2")))
+inline void simd_axpy_avx2(double iA, const double* iX, double* ioY, size_t iN)
+{
+  const __m256d a = _mm256_set1_pd(iA);
+  size_t i = 0;
+  for (; i + 8 <= iN; i += 8) {
+    __m256d y0 = _mm256_add_pd(_mm256_loadu_pd(ioY+i),   _mm256_mul_pd(a, _mm256_loadu_pd(iX+i)));
+    __m256d y1 = _mm256_add_pd(_mm256_loadu_pd(ioY+i+4), _mm256_mul_pd(a, _mm256_loadu_pd(iX+i+4)));
+    _mm256_storeu_pd(ioY+i, y0);
+    _mm256_storeu_pd(ioY+i+4, y1);
+  }
+  for (; i < iN; i++)
+    ioY[i] += iA * iX[i];
+}
+
+__attribute__((target("avx2")))
+inline void simd_axpy_avx2(int iA, const int* iX, int* ioY, size_t iN)
+{
+  const __m256i a = _mm256_set1_epi32(iA);
+  size_t i = 0;
+  for (; i + 8 <= iN; i += 8) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(iX+i));
+    __m256i y = _mm256_loadu_si256((const __m256i*)(ioY+i));
+    _mm256_storeu_si256((__m256i*)(ioY+i), _mm256_add_epi32(y, _mm256_mullo_epi32(a, x)));
+  }
+  for (; i < iN; i++)
+    ioY[i] += iA * iX[i];
+}
+
+
+__attribute__((target("avx2")))
+inline void simd_max_add_avx2(float iA, const float* iX, float* ioY, size_t iN)
+{
+  const __m256 a = _mm256_set1_ps(iA);
+  size_t i = 0;
+  for (; i + 8 <= iN; i += 8)
+    _mm256_storeu_ps(ioY+i, _mm256_max_ps(_mm256_loadu_ps(ioY+i), _mm256_add_ps(_mm256_loadu_ps(iX+i), a)));
+  for (; i < iN; i++)
+    ioY[i] = std::max(ioY[i], iX[i] + iA);
+}
+
+__attribute__((target("avx2")))
+inline void simd_max_add_avx2(double iA, const double* iX, double* ioY, size_t iN)
+{
+  const __m256d a = _mm256_set1_pd(iA);
+  size_t i = 0;
+  for (; i + 4 <= iN; i += 4)
+    _mm256_storeu_pd(ioY+i, _mm256_max_pd(_mm256_loadu_pd(ioY+i), _mm256_add_pd(_mm256_loadu_pd(iX+i), a)));
+  for (; i < iN; i++)
+    ioY[i] = std::max(ioY[i], iX[i] + iA);
+}
+
+__attribute__((target("avx2")))
+inline void simd_max_add_avx2(int iA, const int* iX, int* ioY, size_t iN)
+{
+  const __m256i a = _mm256_set1_epi32(iA);
+  size_t i = 0;
+  for (; i + 8 <= iN; i += 8) {
+    __m256i x = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(iX+i)), a);
+    __m256i y = _mm256_loadu_si256((const __m256i*)(ioY+i));
+    _mm256_storeu_si256((__m256i*)(ioY+i), _mm256_max_epi32(y, x));
+  }
+  for (; i < iN; i++)
+    ioY[i] = std::max(ioY[i], iX[i] + iA);
+}
+
+__attribute__((target("avx2")))
+inline void simd_max_add_avx2(long long iA, const long long* iX, long long* ioY, size_t iN)
+{
+  const __m256i a = _mm256_set1_epi64x(iA);
+  size_t i = 0;
+  for (; i + 4 <= iN; i += 4) {
+    __m256i x = _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(iX+i)), a);
+    __m256i y = _mm256_loadu_si256((const __m256i*)(ioY+i));
+    _mm256_storeu_si256((__m256i*)(ioY+i), _mm256_blendv_epi8(y, x, _mm256_cmpgt_epi64(x, y)));
+  }
+  for (; i < iN; i++)
+    ioY[i] = std::max(ioY[i], iX[i] + iA);
+}
+
+
+//------------------------------------------------------------------------------
+// AVX-512 kernels (the maximum is a comparison and a blend: the _mm512_max_* functions of
+// some versions of gcc raise false warnings of uninitialized variables)
+//------------------------------------------------------------------------------
+
+__attribute__((target("avx512f")))
+inline void simd_max_add_avx512(float iA, const float* iX, float* ioY, size_t iN)
+{
+  const __m512 a = _mm512_set1_ps(iA);
+  size_t i = 0;
+  for (; i + 16 <= iN; i += 16) {
+    __m512 x = _mm512_add_ps(_mm512_loadu_ps(iX+i), a);
+    __m512 y = _mm512_loadu_ps(ioY+i);
+    _mm512_storeu_ps(ioY+i, _mm512_mask_blend_ps(_mm512_cmp_ps_mask(y, x, _CMP_LT_OQ), y, x));
+  }
+  for (; i < iN; i++)
+    ioY[i] = std::max(ioY[i], iX[i] + iA);
+}
+
+__attribute__((target("avx512f")))
+inline void simd_max_add_avx512(double iA, const double* iX, double* ioY, size_t iN)
+{
+  const __m512d a = _mm512_set1_pd(iA);
+  size_t i = 0;
+  for (; i + 8 <= iN; i += 8) {
+    __m512d x = _mm512_add_pd(_mm512_loadu_pd(iX+i), a);
+    __m512d y = _mm512_loadu_pd(ioY+i);
+    _mm512_storeu_pd(ioY+i, _mm512_mask_blend_pd(_mm512_cmp_pd_mask(y, x, _CMP_LT_OQ), y, x));
+  }
+  for (; i < iN; i++)
+    ioY[i] = std::max(ioY[i], iX[i] + iA);
+}
+
+__attribute__((target("avx512f")))
+inline void simd_max_add_avx512(int iA, const int* iX, int* ioY, size_t iN)
+{
+  const __m512i a = _mm512_set1_epi32(iA);
+  size_t i = 0;
+  for (; i + 16 <= iN; i += 16) {
+    __m512i x = _mm512_add_epi32(_mm512_loadu_si512((const void*)(iX+i)), a);
+    __m512i y = _mm512_loadu_si512((const void*)(ioY+i));
+    _mm512_storeu_si512((void*)(ioY+i), _mm512_mask_blend_epi32(_mm512_cmplt_epi32_mask(y, x), y, x));
+  }
+  for (; i < iN; i++)
+    ioY[i] = std::max(ioY[i], iX[i] + iA);
+}
+
+__attribute__((target("avx512f")))
+inline void simd_max_add_avx512(long long iA, const long long* iX, long long* ioY, size_t iN)
+{
+  const __m512i a = _mm512_set1_epi64(iA);
+  size_t i = 0;
+  for (; i + 8 <= iN; i += 8) {
+    __m512i x = _mm512_add_epi64(_mm512_loadu_si512((const void*)(iX+i)), a);
+    __m512i y = _mm512_loadu_si512((const void*)(ioY+i));
+    _mm512_storeu_si512((void*)(ioY+i), _mm512_mask_blend_epi64(_mm512_cmplt_epi64_mask(y, x), y, x));
+  }
+  for (; i < iN; i++)
+    ioY[i] = std::max(ioY[i], iX[i] + iA);
+}
+
+
+//------------------------------------------------------------------------------
+// Specialization of the kernels with runtime dispatch
+//------------------------------------------------------------------------------
+
+#define SIMD_KERNELS_FLOATING(T)                                        \
+  template<>                                                            \
+  inline T Simd_kernels<T>::dot(const T* iX, const T* iY, size_t iN)    \
+  {                                                                     \
+    if (simd_has_avx2()) return simd_dot_avx2(iX, iY, iN);              \
+    if (simd_has_sse2()) return simd_dot_sse2(iX, iY, iN);              \
+    return dot_scalar(iX, iY, iN);                                      \
+  }                                                                     \
+  template<>                                                            \
+  inline T Simd_kernels<T>::sum(const T* iX, size_t iN)                 \
+  {                                                                     \
+    if (simd_has_avx2()) return simd_sum_avx2(iX, iN);                  \
+    if (simd_has_sse2()) return simd_sum_sse2(iX, iN);                  \
+    return sum_scalar(iX, iN);                                          \
+  }                                                                     \
+  template<>                                                            \
+  inline void Simd_kernels<T>::axpy(T iA, const T* iX, T* ioY, size_t iN) \
+  {                                                                     \
+    if (simd_has_avx2()) simd_axpy_avx2(iA, iX, ioY, iN);               \
+    else if (simd_has_sse2()) simd_axpy_sse2(iA, iX, ioY, iN);          \
+    else axpy_scalar(iA, iX, ioY, iN);                                  \
+  }
+
+#define SIMD_KERNELS_INTEGRAL(T)                                        \
+  template<>                                                            \
+  inline T Simd_kernels<T>::dot(const T* iX, const T* iY, size_t iN)    \
+  {                                                                     \
+    if (simd_has_avx2()) return simd_dot_avx2(iX, iY, iN);              \
+    return dot_scalar(iX, iY, iN);                                      \
+  }                                                                     \
+  template<>                                                            \
+  inline T Simd_kernels<T>::sum(const T* iX, size_t iN)                 \
+  {                                                                     \
+    if (simd_has_avx2()) return simd_sum_avx2(iX, iN);                  \
+    return sum_scalar(iX, iN);                                          \
+  }                                                                     \
+  template<>                                                            \
+  inline void Simd_kernels<T>::axpy(T iA, const T* iX, T* ioY, size_t iN) \
+  {                                                                     \
+    if (simd_has_avx2()) simd_axpy_avx2(iA, iX, ioY, iN);               \
+    else axpy_scalar(iA, iX, ioY, iN);                                  \
+  }
+
+#define SIMD_KERNELS_MIN_MAX(T)                                         \
+  template<>                                                            \
+  inline T Simd_kernels<T>::min(const T* iX, size_t iN)                 \
+  {                                                                     \
+    if (simd_has_avx2()) return simd_min_avx2(iX, iN);                  \
+    return min_scalar(iX, iN);                                          \
+  }                                                                     \
+  template<>                                                            \
+  inline T Simd_kernels<T>::max(const T* iX, size_t iN)                 \
+  {                                                                     \
+    if (simd_has_avx2()) return simd_max_avx2(iX, iN);                  \
+    return max_scalar(iX, iN);                                          \
+  }
+
+SIMD_KERNELS_FLOATING(float)
+SIMD_KERNELS_FLOATING(double)
+SIMD_KERNELS_INTEGRAL(int)
+SIMD_KERNELS_MIN_MAX(float)
+SIMD_KERNELS_MIN_MAX(double)
+SIMD_KERNELS_MIN_MAX(int)
+
+#define SIMD_KERNELS_MAX_ADD(T)                                         \
+  template<>                                                            \
+  inline void Simd_kernels<T>::max_add(T iA, const T* iX, T* ioY, size_t iN) \
+  {                                                                     \
+    if (simd_has_avx512()) simd_max_add_avx512(iA, iX, ioY, iN);        \
+    else if (simd_has_avx2()) simd_max_add_avx2(iA, iX, ioY, iN);       \
+    else max_add_scalar(iA, iX, ioY, iN);                               \
+  }
+
+SIMD_KERNELS_MAX_ADD(float)
+SIMD_KERNELS_MAX_ADD(double)
+SIMD_KERNELS_MAX_ADD(int)
+SIMD_KERNELS_MAX_ADD(long long)
+
+// long has the size of int or of long long, depending on the platform
+template<>
+inline void Simd_kernels<long>::max_add(long iA, const long* iX, long* ioY, size_t iN)
+{
+  if (sizeof(long) == sizeof(long long))
+    Simd_kernels<long long>::max_add(iA, (const long long*)iX, (long long*)ioY, iN);
+  else
+    Simd_kernels<int>::max_add(iA, (const int*)iX, (int*)ioY, iN);
+}
+
+#endif // SIMD_TOOLS_X86 && !DOXYGEN_SHOULD_SKIP_THIS
+
+
+#endif // SIMD_TOOLS_H
@@ -0,0 +1,568 @@
+/**
+ * @file sparse_array2d.h
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Implementation of a template for sparse array with two dimensions.
+ * @details Two classes:
+ * - #Sparse_array2d_builder collects the nonzero elements in any order (coordinate format).
+ * - #Sparse_array2d stores the nonzero elements row after row (compressed sparse row format).
+ */
+
+
+#ifndef SPARSE_ARRAY2D_H
+#define SPARSE_ARRAY2D_H
+
+#include <algorithm>
+#include <assert.h>
+#include <iostream>
+#include <vector>
+
+#include "array2d.h"
+
+
+/**
+ * @brief Builder of #Sparse_array2d from elements given in any order (coordinate format)
+ * @details The elements added at the same position are summed.
+ */
+template <class T>
+class Sparse_array2d_builder
+{
+ public:
+  /**
+   * @brief Constructor
+   * @param[in] iP Number of rows of the array
+   * @param[in] iN Number of columns of the array
+   */
+  inline Sparse_array2d_builder(int iP = 0, int iN = 0);
+
+  /** @brief Destructor */
+  inline ~Sparse_array2d_builder();
+
+  /**
+   * @brief Add an element
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   * @param[in] iVal Value added at the position (iJ,iI)
+   */
+  inline void add(int iJ, int iI, const T& iVal);
+
+  /** @brief Reserve the memory for iNbElements elements */
+  inline void reserve(size_t iNbElements);
+
+  /** @brief Return the number of rows of the array */
+  inline int nb_rows() const;
+
+  /** @brief Return the number of columns of the array */
+  inline int nb_columns() const;
+
+  /** @brief Return the number of added elements (including duplicates) */
+  inline size_t nb_elements() const;
+
+  /** @brief Return the row indexes of the added elements */
+  inline const std::vector<int>& rows() const;
+
+  /** @brief Return the column indexes of the added elements */
+  inline const std::vector<int>& columns() const;
+
+  /** @brief Return the values of the added elements */
+  inline const std::vector<T>& values() const;
+
+ protected:
+  int _nb_rows;              /**< @brief Number of rows */
+  int _nb_columns;           /**< @brief Number of columns */
+  std::vector<int> _rows;    /**< @brief Row indexes of the elements */
+  std::vector<int> _columns; /**< @brief Column indexes of the elements */
+  std::vector<T> _values;    /**< @brief Values of the elements */
+};
+
+
+/**
+ * @brief Template for sparse array with two dimensions
+ * @details Only the nonzero elements are stored, row after row, with their column index
+ * (compressed sparse row format). The memory and the time of the dot products are
+ * proportional to the number of nonzero elements.
+ *
+ * The class has the same reading interface as #Array2d (nb_rows(), nb_columns(), operator(),
+ * dot_product(), push_back_row()), but its elements can not be modified in place. The array
+ * is built with push_back_row(), with a #Sparse_array2d_builder or from an #Array2d.
+ *
+ * A minimal example is given by the following code:
+ * @code{cpp}
+ * Sparse_array2d_builder<double> builder(1000, 1000);
+ * builder.add(10, 20, 1.5);
+ * builder.add(999, 0, -2.);
+ * Sparse_array2d<double> S(builder);
+ *
+ * Array2d<double> D;
+ * S.to_dense(D);  // D(10,20) == 1.5
+ * @endcode
+ */
+template <class T>
+class Sparse_array2d
+{
+ public:
+  /**
+   * @brief Constructor of an array without nonzero element
+   * @param[in] iP Number of rows of the array
+   * @param[in] iN Number of columns of the array
+   */
+  inline Sparse_array2d(int iP = 0, int iN = 0);
+
+  /**
+   * @brief Constructor from the elements of a builder
+   * @param[in] iBuilder Builder containing the elements (the duplicates are summed)
+   */
+  inline explicit Sparse_array2d(const Sparse_array2d_builder<T>& iBuilder);
+
+  /**
+   * @brief Constructor from a dense array
+   * @param[in] iArray2d Dense array whose nonzero elements are copied
+   */
+  template <class Layout, class Alloc>
+  inline explicit Sparse_array2d(const Array2d<T,Layout,Alloc>& iArray2d);
+
+  /** @brief Destructor */
+  inline ~Sparse_array2d();
+
+  /**
+   * @brief Copy the array in a dense array
+   * @param[out] oArray2d Dense array resized and filled with the elements
+   */
+  template <class Layout, class Alloc>
+  inline void to_dense(Array2d<T,Layout,Alloc>& oArray2d) const;
+
+  /**
+   * @brief Add a row at the end of the array
+   * @param[in] iR Vector containing all the elements of the new row (the zeros are not stored)
+   */
+  inline void push_back_row(const std::vector<T> & iR);
+
+  /**
+   * @brief Add a row at the end of the array from its nonzero elements
+   * @param[in] iColumns Column indexes of the nonzero elements, in increasing order
+   * @param[in] iValues Values of the nonzero elements
+   */
+  inline void push_back_row(const std::vector<int> & iColumns, const std::vector<T> & iValues);
+
+  /**
+   * @brief Removes all elements from the array, leaving the container with a size of 0.
+   */
+  inline void clear();
+
+  /** @brief Return the number of rows of the array */
+  inline int nb_rows() const;
+
+  /** @brief Return the number of columns of the array */
+  inline int nb_columns() const;
+
+  /** @brief Return the number of stored (nonzero) elements */
+  inline int nb_nonzeros() const;
+
+  /**
+   * @brief Read access to coefficients of the array
+   * @details The element is searched by dichotomy in its row. The indexes are checked only in
+   * debug builds (that is, if NDEBUG is not defined).
+   * @param[in] iJ Index of the row
+   * @param[in] iI Index of the column
+   * @return The element, or T() if it is not stored
+   */
+  inline T operator()(int iJ, int iI) const;
+
+  /** @brief Return the number of nonzero elements of a row */
+  inline int row_size(int iJ) const;
+
+  /** @brief Return the column indexes of the nonzero elements of a row (increasing order) */
+  inline const int* row_columns(int iJ) const;
+
+  /** @brief Return the values of the nonzero elements of a row */
+  inline const T* row_values(int iJ) const;
+
+  /**
+   * @brief Return the dot product between this array and the argument array
+   * @details The nonzero elements of each row are merged in O(nonzeros).
+   * @param[in] A Sparse array with the same size
+   */
+  inline T dot_product(const Sparse_array2d& A) const;
+
+  /**
+   * @brief Return the dot product between this array and a dense array
+   * @details Only the nonzero elements of this array are visited.
+   * @param[in] A Dense array with the same size
+   */
+  template <class Layout, class Alloc>
+  inline T dot_product(const Array2d<T,Layout,Alloc>& A) const;
+
+  /** @brief Return the sum of the elements of the array */
+  inline T sum() const;
+
+ protected:
+  /** @brief Print a warning and stop (in debug builds) if the indexes are out of range */
+  inline void check_range(int iJ, int iI) const;
+
+  int _nb_columns;              /**< @brief Number of columns */
+  std::vector<int> _row_start;  /**< @brief Position of the first element of each row (and end) */
+  std::vector<int> _columns;    /**< @brief Column indexes of the elements, row after row */
+  std::vector<T> _values;       /**< @brief Values of the elements, row after row */
+};
+
+
+//==============================================================================
+// Implementation of methods
+//==============================================================================
+
+
+template <class T>
+inline Sparse_array2d_builder<T>::Sparse_array2d_builder(int iP, int iN)
+: _nb_rows(iP > 0 ? iP : 0),
+  _nb_columns(iN > 0 ? iN : 0),
+  _rows(),
+  _columns(),
+  _values()
+{
+}
+
+
+template <class T>
+inline Sparse_array2d_builder<T>::~Sparse_array2d_builder()
+{
+}
+
+
+template <class T>
+inline void Sparse_array2d_builder<T>::add(int iJ, int iI, const T& iVal)
+{
+  if (0 <= iJ && iJ < _nb_rows && 0 <= iI && iI < _nb_columns) {
+    _rows.push_back(iJ);
+    _columns.push_back(iI);
+    _values.push_back(iVal);
+  }
+  else {
+    std::cerr << "[WARNING] void Sparse_array2d_builder<T>::add(int,int,const T&)" << std::endl
+              << "Index out of range. No element added." << std::endl;
+    assert(false);
+  }
+}
+
+
+template <class T>
+inline void Sparse_array2d_builder<T>::reserve(size_t iNbElements)
+{
+  _rows.reserve(iNbElements);
+  _columns.reserve(iNbElements);
+  _values.reserve(iNbElements);
+}
+
+
+template <class T>
+inline int Sparse_array2d_builder<T>::nb_rows() const
+{
+  return _nb_rows;
+}
+
+
+template <class T>
+inline int Sparse_array2d_builder<T>::nb_columns() const
+{
+  return _nb_columns;
+}
+
+
+template <class T>
+inline size_t Sparse_array2d_builder<T>::nb_elements() const
+{
+  return _values.size();
+}
+
+
+template <class T>
+inline const std::vector<int>& Sparse_array2d_builder<T>::rows() const
+{
+  return _rows;
+}
+
+
+template <class T>
+inline const std::vector<int>& Sparse_array2d_builder<T>::columns() const
+{
+  return _columns;
+}
+
+
+template <class T>
+inline const std::vector<T>& Sparse_array2d_builder<T>::values() const
+{
+  return _values;
+}
+
+
+template <class T>
+inline Sparse_array2d<T>::Sparse_array2d(int iP, int iN)
+: _nb_columns(iN > 0 ? iN : 0),
+  _row_start(iP > 0 ? iP+1 : 1, 0),
+  _columns(),
+  _values()
+{
+}
+
+
+template <class T>
+inline Sparse_array2d<T>::Sparse_array2d(const Sparse_array2d_builder<T>& iBuilder)
+: _nb_columns(iBuilder.nb_columns()),
+  _row_start(iBuilder.nb_rows()+1, 0),
+  _columns(),
+  _values()
+{
+  // Counting sort of the elements by row
+  const std::vector<int>& rows = iBuilder.rows();
+  const size_t nb_elements = rows.size();
+  for (size_t e = 0; e < nb_elements; e++)
+    _row_start[rows[e]+1]++;
+  for (int j = 0; j < nb_rows(); j++)
+    _row_start[j+1] += _row_start[j];
+  std::vector<int> position(_row_start.begin(), _row_start.end()-1);
+  std::vector<int> order(nb_elements);
+  for (size_t e = 0; e < nb_elements; e++)
+    order[position[rows[e]]++] = e;
+
+  // Sort each row by column and sum the duplicates
+  const std::vector<int>& columns = iBuilder.columns();
+  const std::vector<T>& values = iBuilder.values();
+  _columns.reserve(nb_elements);
+  _values.reserve(nb_elements);
+  int begin = 0;
+  for (int j = 0; j < nb_rows(); j++) {
+    const int end = _row_start[j+1];
+    std::sort(order.begin()+begin, order.begin()+end,
+              [&columns](int a, int b) { return columns[a] < columns[b] || (columns[a] == columns[b] && a < b); });
+    _row_start[j] = _columns.size();
+    for (int e = begin; e < end; ) {
+      const int column = columns[order[e]];
+      T value = values[order[e]];
+      for (e++; e < end && columns[order[e]] == column; e++)
+        value += values[order[e]];
+      if (value != T()) {
+        _columns.push_back(column);
+        _values.push_back(value);
+      }
+    }
+    begin = end;
+  }
+  _row_start[nb_rows()] = _columns.size();
+}
+
+
+template <class T>
+template <class Layout, class Alloc>
+inline Sparse_array2d<T>::Sparse_array2d(const Array2d<T,Layout,Alloc>& iArray2d)
+: _nb_columns(iArray2d.nb_columns()),
+  _row_start(1, 0),
+  _columns(),
+  _values()
+{
+  _row_start.reserve(iArray2d.nb_rows()+1);
+  for (int j = 0; j < iArray2d.nb_rows(); j++) {
+    for (int i = 0; i < iArray2d.nb_columns(); i++) {
+      const T& value = iArray2d.unchecked(j,i);
+      if (value != T()) {
+        _columns.push_back(i);
+        _values.push_back(value);
+      }
+    }
+    _row_start.push_back(_columns.size());
+  }
+}
+
+
+template <class T>
+inline Sparse_array2d<T>::~Sparse_array2d()
+{
+}
+
+
+template <class T>
+template <class Layout, class Alloc>
+inline void Sparse_array2d<T>::to_dense(Array2d<T,Layout,Alloc>& oArray2d) const
+{
+  oArray2d.resize(nb_rows(), nb_columns());
+  oArray2d.fill(T());
+  for (int j = 0; j < nb_rows(); j++)
+    for (int e = _row_start[j]; e < _row_start[j+1]; e++)
+      oArray2d.unchecked(j, _columns[e]) = _values[e];
+}
+
+
+template <class T>
+inline void Sparse_array2d<T>::push_back_row(const std::vector<T> & iR)
+{
+  if (nb_rows() == 0)
+    _nb_columns = iR.size();
+  if (iR.size() == (unsigned int)_nb_columns) {
+    for (int i = 0; i < _nb_columns; i++) {
+      if (iR[i] != T()) {
+        _columns.push_back(i);
+        _values.push_back(iR[i]);
+      }
+    }
+    _row_start.push_back(_columns.size());
+  }
+  else {
+    std::cerr << "[WARNING] void Sparse_array2d<T>::push_back_row(const std::vector<T>&)" << std::endl
+              << "New row size different from array row size. No row added." << std::endl;
+    assert(false);
+  }
+}
+
+
+template <class T>
+inline void Sparse_array2d<T>::push_back_row(const std::vector<int> & iColumns, const std::vector<T> & iValues)
+{
+  bool is_valid = iColumns.size() == iValues.size();
+  for (size_t e = 0; e < iColumns.size() && is_valid; e++)
+    is_valid = 0 <= iColumns[e] && iColumns[e] < _nb_columns && (e == 0 || iColumns[e-1] < iColumns[e]);
+  if (is_valid) {
+    _columns.insert(_columns.end(), iColumns.begin(), iColumns.end());
+    _values.insert(_values.end(), iValues.begin(), iValues.end());
+    _row_start.push_back(_columns.size());
+  }
+  else {
+    std::cerr << "[WARNING] void Sparse_array2d<T>::push_back_row(const std::vector<int>&, const std::vector<T>&)" << std::endl
+              << "Invalid or unsorted column indexes. No row added." << std::endl;
+    assert(false);
+  }
+}
+
+
+template <class T>
+inline void Sparse_array2d<T>::clear()
+{
+  _nb_columns = 0;
+  _row_start.assign(1, 0);
+  _columns.clear();
+  _values.clear();
+}
+
+
+template <class T>
+inline int Sparse_array2d<T>::nb_rows() const
+{
+  return _row_start.size()-1;
+}
+
+
+template <class T>
+inline int Sparse_array2d<T>::nb_columns() const
+{
+  return _nb_columns;
+}
+
+
+template <class T>
+inline int Sparse_array2d<T>::nb_nonzeros() const
+{
+  return _values.size();
+}
+
+
+template <class T>
+inline T Sparse_array2d<T>::operator()(int iJ, int iI) const
+{
+#ifndef NDEBUG
+  check_range(iJ, iI);
+#endif
+  const int* first = row_columns(iJ);
+  const int* last = first + row_size(iJ);
+  const int* it = std::lower_bound(first, last, iI);
+  return (it != last && *it == iI) ? _values[it - _columns.data()] : T();
+}
+
+
+template <class T>
+inline int Sparse_array2d<T>::row_size(int iJ) const
+{
+  return _row_start[iJ+1] - _row_start[iJ];
+}
+
+
+template <class T>
+inline const int* Sparse_array2d<T>::row_columns(int iJ) const
+{
+  return _columns.data() + _row_start[iJ];
+}
+
+
+template <class T>
+inline const T* Sparse_array2d<T>::row_values(int iJ) const
+{
+  return _values.data() + _row_start[iJ];
+}
+
+
+template <class T>
+inline T Sparse_array2d<T>::dot_product(const Sparse_array2d& A) const
+{
+  if (nb_columns() != A.nb_columns() || nb_rows() != A.nb_rows()) {
+    std::cerr << "[ERROR] T Sparse_array2d<T>::dot_product(const Sparse_array2d<T>& A)" << std::endl
+              << "The two array have not the same same size." << std::endl;
+    return T();
+  }
+  T dot_prod = T();
+  for (int j = 0; j < nb_rows(); j++) {
+    int e = _row_start[j], f = A._row_start[j];
+    const int e_end = _row_start[j+1], f_end = A._row_start[j+1];
+    while (e < e_end && f < f_end) {
+      if (_columns[e] < A._columns[f])
+        e++;
+      else if (A._columns[f] < _columns[e])
+        f++;
+      else
+        dot_prod += _values[e++] * A._values[f++];
+    }
+  }
+  return dot_prod;
+}
+
+
+template <class T>
+template <class Layout, class Alloc>
+inline T Sparse_array2d<T>::dot_product(const Array2d<T,Layout,Alloc>& A) const
+{
+  if (nb_columns() != A.nb_columns() || nb_rows() != A.nb_rows()) {
+    std::cerr << "[ERROR] T Sparse_array2d<T>::dot_product(const Array2d<T>& A)" << std::endl
+              << "The two array have not the same same size." << std::endl;
+    return T();
+  }
+  T dot_prod = T();
+  for (int j = 0; j < nb_rows(); j++)
+    for (int e = _row_start[j]; e < _row_start[j+1]; e++)
+      dot_prod += _values[e] * A.unchecked(j, _columns[e]);
+  return dot_prod;
+}
+
+
+template <class T>
+inline T Sparse_array2d<T>::sum() const
+{
+  T s = T();
+  for (size_t e = 0; e < _values.size(); e++)
+    s += _values[e];
+  return s;
+}
+
+
+template <class T>
+inline void Sparse_array2d<T>::check_range(int iJ, int iI) const
+{
+  if (iJ < 0 || iJ >= nb_rows()) {
+    std::cerr << "[WARNING] T Sparse_array2d<T>::operator()(int,int)" << std::endl
+              << "Row index out of range." << std::endl;
+    assert(false);
+  }
+  else if (iI < 0 || iI >= nb_columns()) {
+    std::cerr << "[WARNING] T Sparse_array2d<T>::operator()(int,int)" << std::endl
+              << "Column index out of range." << std::endl;
+    assert(false);
+  }
+}
+
+
+#endif // SPARSE_ARRAY2D_H
@@ -0,0 +1,307 @@
+/**
+ * @file benchmark.cpp
+ * @author Etienne de Saint Germain
+ * @date 2014
+ * @brief Benchmarks of the tools.
+ * @details Compile with the optimization options (see the Makefile) to get meaningful times.
+ */
+
+#include "array2d.h"
+#include "array2d_expr.h"
+#include "array2d_view.h"
+#include "fixed_array2d.h"
+#include "knapsack.h"
+#include "time_tools.h"
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+
+/**
+ * @brief Column generation workload: the array is built column by column, some columns in the
+ * middle are replaced, then the whole array is summed.
+ * @param[in] iNbRows Number of rows of the array
+ * @param[in] iNbColumns Number of columns of the array
+ * @return Wall time of the workload in seconds
+ */
+template <class Layout>
+double column_generation_benchmark(int iNbRows, int iNbColumns)
+{
+  double start = get_wall_time();
+  Array2d<double, Layout> A;
+  std::vector<double> col(iNbRows);
+  for (int i = 0; i < iNbColumns; i++) {
+    for (int j = 0; j < iNbRows; j++)
+      col[j] = i + 0.001*j;
+    A.push_back_column(col);
+  }
+  for (int i = 0; i < iNbColumns/10; i++) {
+    A.erase_column(A.nb_columns()/2);
+    A.insert_column(A.nb_columns()/3, col);
+  }
+  volatile double sum = A.sum();
+  (void)sum;
+  return get_wall_time() - start;
+}
+
+
+/**
+ * @brief Product of two square arrays with the naive triple loop and with Array2d::multiply()
+ * @param[in] iN Size of the arrays
+ * @param[out] oNaive Wall time of the naive product in seconds
+ * @param[out] oTiled Wall time of Array2d::multiply() in seconds
+ */
+void multiply_benchmark(int iN, double& oNaive, double& oTiled)
+{
+  Array2d<double> A(iN, iN), B(iN, iN), C(iN, iN);
+  for (int j = 0; j < iN; j++)
+    for (int i = 0; i < iN; i++) {
+      A(j,i) = (j + 2*i) % 7;
+      B(j,i) = (3*j + i) % 5;
+    }
+
+  double start = get_wall_time();
+  for (int j = 0; j < iN; j++)
+    for (int i = 0; i < iN; i++) {
+      double c = 0;
+      for (int k = 0; k < iN; k++)
+        c += A(j,k) * B(k,i);
+      C(j,i) = c;
+    }
+  oNaive = get_wall_time() - start;
+
+  start = get_wall_time();
+  A.multiply(B, C);
+  oTiled = get_wall_time() - start;
+}
+
+
+/**
+ * @brief Update C = a*A + B - D with temporary arrays and with an expression template
+ * @param[in] iN Size of the arrays
+ * @param[out] oTemporaries Wall time with temporary arrays (copy() and axpy()) in seconds
+ * @param[out] oExpression Wall time with the expression template in seconds
+ */
+void expression_benchmark(int iN, double& oTemporaries, double& oExpression)
+{
+  Array2d<double> A(iN, iN), B(iN, iN), C(iN, iN), D(iN, iN);
+  A.fill(1.);
+  B.fill(2.);
+  D.fill(3.);
+  const int nb_repeats = 10;
+
+  double start = get_wall_time();
+  for (int r = 0; r < nb_repeats; r++) {
+    Array2d<double> T1(A);
+    T1.transform([](double x) { return 0.5*x; });
+    Array2d<double> T2(T1);
+    T2.axpy(1., B);
+    C = T2;
+    C.axpy(-1., D);
+  }
+  oTemporaries = get_wall_time() - start;
+
+  start = get_wall_time();
+  for (int r = 0; r < nb_repeats; r++)
+    C = 0.5*A + B - D;
+  oExpression = get_wall_time() - start;
+}
+
+
+/**
+ * @brief Sum of all the square blocks of an array, with a copy of each block and with views
+ * @param[in] iN Size of the array
+ * @param[in] iBlock Size of the blocks
+ * @param[out] oCopies Wall time with a copy of each block in seconds
+ * @param[out] oViews Wall time with Array2d_view in seconds
+ */
+void block_benchmark(int iN, int iBlock, double& oCopies, double& oViews)
+{
+  Array2d<double> A(iN, iN);
+  A.fill(1.);
+  volatile double sum = 0;
+
+  double start = get_wall_time();
+  for (int j = 0; j + iBlock <= iN; j += iBlock)
+    for (int i = 0; i + iBlock <= iN; i += iBlock) {
+      Array2d<double> T(iBlock, iBlock);
+      for (int jj = 0; jj < iBlock; jj++)
+        for (int ii = 0; ii < iBlock; ii++)
+          T(jj,ii) = A(j+jj,i+ii);
+      sum = sum + T.sum();
+    }
+  oCopies = get_wall_time() - start;
+
+  start = get_wall_time();
+  Array2d_view<const double> v(A);
+  for (int j = 0; j + iBlock <= iN; j += iBlock)
+    for (int i = 0; i + iBlock <= iN; i += iBlock)
+      sum = sum + v.block(j, i, iBlock, iBlock).sum();
+  oViews = get_wall_time() - start;
+}
+
+
+/**
+ * @brief Removal of one row out of three, row by row and with a single call to erase_rows()
+ * @param[in] iNbRows Number of rows of the array
+ * @param[in] iNbColumns Number of columns of the array
+ * @param[out] oLoop Wall time of the loop on erase_row() in seconds
+ * @param[out] oBatch Wall time of erase_rows(const std::vector<int>&) in seconds
+ */
+void erase_benchmark(int iNbRows, int iNbColumns, double& oLoop, double& oBatch)
+{
+  Array2d<double> A(iNbRows, iNbColumns);
+  A.fill(1.);
+  Array2d<double> B(A);
+  std::vector<int> rows;
+  for (int j = 0; j < iNbRows; j += 3)
+    rows.push_back(j);
+
+  double start = get_wall_time();
+  for (int k = (int)rows.size()-1; k >= 0; k--)
+    A.erase_row(rows[k]);
+  oLoop = get_wall_time() - start;
+
+  start = get_wall_time();
+  B.erase_rows(rows);
+  oBatch = get_wall_time() - start;
+}
+
+
+/**
+ * @brief Composition of many 3x3 transforms with Array2d and with Fixed_array2d
+ * @param[in] iN Number of products
+ * @param[out] oDynamic Wall time with Array2d in seconds
+ * @param[out] oFixed Wall time with Fixed_array2d in seconds
+ */
+void small_matrix_benchmark(int iN, double& oDynamic, double& oFixed)
+{
+  volatile double sum = 0;
+  double start = get_wall_time();
+  for (int k = 0; k < iN; k++) {
+    Array2d<double> A(3, 3), B(3, 3), C;
+    for (int j = 0; j < 3; j++) {
+      A(j,j) = 1. + k%3;
+      B(j,(j+1)%3) = 0.5;
+    }
+    A.multiply(B, C);
+    sum = sum + C.sum();
+  }
+  oDynamic = get_wall_time() - start;
+
+  start = get_wall_time();
+  for (int k = 0; k < iN; k++) {
+    Fixed_array2d<double, 3, 3> A, B;
+    for (int j = 0; j < 3; j++) {
+      A(j,j) = 1. + k%3;
+      B(j,(j+1)%3) = 0.5;
+    }
+    sum = sum + A.multiply(B).sum();
+  }
+  oFixed = get_wall_time() - start;
+}
+
+
+/**
+ * @brief Knapsack problem solved with the scalar table of vectors and with Knapsack
+ * @param[in] iN Number of items
+ * @param[in] iW Capacity of the knapsack
+ * @param[out] oScalar Wall time of the scalar dynamic programming on a table of vectors in seconds
+ * @param[out] oKnapsack Wall time of Knapsack (value only) in seconds
+ */
+void knapsack_benchmark(int iN, unsigned int iW, double& oScalar, double& oKnapsack)
+{
+  std::vector<int> val(iN);
+  std::vector<unsigned int> wt(iN);
+  for (int i = 0; i < iN; i++) {
+    val[i] = (i*7919) % 1000 + 1;
+    wt[i] = (i*104729) % (iW/10) + 1;
+  }
+
+  double start = get_wall_time();
+  std::vector< std::vector<int> > K(iN+1, std::vector<int>(iW+1, 0));
+  for (int i = 1; i <= iN; i++)
+    for (unsigned int w = 0; w <= iW; w++) {
+      if (wt[i-1] <= w)
+        K[i][w] = std::max(val[i-1]+K[i-1][w-wt[i-1]], K[i-1][w]);
+      else
+        K[i][w] = K[i-1][w];
+    }
+  volatile int opt = K[iN][iW];
+  oScalar = get_wall_time() - start;
+
+  start = get_wall_time();
+  Knapsack<int> knapsack(iW, wt, val);
+  knapsack.set_value_only(true);
+  opt = knapsack();
+  (void)opt;
+  oKnapsack = get_wall_time() - start;
+}
+
+
+int main()
+{
+  const int sizes[][2] = { {100, 1000}, {1000, 2000}, {5000, 2000} };
+  cout << "Column generation (push_back_column, insert_column, erase_column, sum)" << endl;
+  cout << setw(12) << "rows x cols" << setw(18) << "Row_major (s)" << setw(18)
+       << "Column_major (s)" << endl;
+  for (int k = 0; k < 3; k++) {
+    double row_major = column_generation_benchmark<Row_major>(sizes[k][0], sizes[k][1]);
+    double column_major = column_generation_benchmark<Column_major>(sizes[k][0], sizes[k][1]);
+    cout << setw(5) << sizes[k][0] << " x " << setw(4) << sizes[k][1]
+         << setw(18) << row_major << setw(18) << column_major << endl;
+  }
+
+  cout << endl << "Matrix product" << endl;
+  cout << setw(12) << "size" << setw(18) << "naive (s)" << setw(18) << "multiply (s)" << endl;
+  for (int n = 256; n <= 1024; n *= 2) {
+    double naive, tiled;
+    multiply_benchmark(n, naive, tiled);
+    cout << setw(12) << n << setw(18) << naive << setw(18) << tiled << endl;
+  }
+
+  cout << endl << "Update C = a*A + B - D (10 times)" << endl;
+  cout << setw(12) << "size" << setw(18) << "temporaries (s)" << setw(18) << "expression (s)" << endl;
+  for (int n = 1000; n <= 4000; n *= 2) {
+    double temporaries, expression;
+    expression_benchmark(n, temporaries, expression);
+    cout << setw(12) << n << setw(18) << temporaries << setw(18) << expression << endl;
+  }
+
+  cout << endl << "Sum of the 16x16 blocks (copy of each block / view)" << endl;
+  cout << setw(12) << "size" << setw(18) << "copies (s)" << setw(18) << "views (s)" << endl;
+  for (int n = 256; n <= 1024; n *= 2) {
+    double copies, views;
+    block_benchmark(n, 16, copies, views);
+    cout << setw(12) << n << setw(18) << copies << setw(18) << views << endl;
+  }
+
+  cout << endl << "Erase one row out of three (erase_row in a loop / erase_rows)" << endl;
+  cout << setw(12) << "rows x cols" << setw(18) << "loop (s)" << setw(18) << "batch (s)" << endl;
+  for (int k = 0; k < 3; k++) {
+    double loop, batch;
+    erase_benchmark(sizes[k][1]*5, sizes[k][0]/10, loop, batch);
+    cout << setw(5) << sizes[k][1]*5 << " x " << setw(4) << sizes[k][0]/10
+         << setw(18) << loop << setw(18) << batch << endl;
+  }
+
+  cout << endl << "Products of 3x3 arrays" << endl;
+  cout << setw(12) << "products" << setw(18) << "Array2d (s)" << setw(18) << "Fixed_array2d (s)" << endl;
+  for (int n = 10000; n <= 1000000; n *= 10) {
+    double dynamic, fixed;
+    small_matrix_benchmark(n, dynamic, fixed);
+    cout << setw(12) << n << setw(18) << dynamic << setw(18) << fixed << endl;
+  }
+
+  cout << endl << "Knapsack with 100 items" << endl;
+  cout << setw(12) << "capacity" << setw(18) << "scalar table (s)" << setw(18) << "value only (s)" << endl;
+  for (unsigned int w = 100000; w <= 400000; w *= 2) {
+    double scalar, row;
+    knapsack_benchmark(100, w, scalar, row);
+    cout << setw(12) << w << setw(18) << scalar << setw(18) << row << endl;
+  }
+  return 0;
+}
@@ -1,22 +1,114 @@
+#include "aligned_allocator.h"
 #include "array2d.h"
+#include "array2d_expr.h"
+#include "array2d_io.h"
+#include "array2d_view.h"
+#include "fixed_array2d.h"
 #include "hcube_iterator.h"
 #include "knapsack.h"
+#include "knapsack_bounded.h"
+#include "knapsack_branch_and_bound.h"
+#include "knapsack_incremental.h"
+#include "knapsack_multiple_choice.h"
+#include "knapsack_unbounded.h"
+#include "parallel_tools.h"
 #include "n_choose_k_iterator.h"
 #include "quick_sort.h"
 #include "random_iterator.h"
+#include "simd_tools.h"
+#include "sparse_array2d.h"
 #include "time_tools.h"
 #include "tolerance.h"
 
 #include <algorithm>
 #include <iostream>
 #include <math.h>
+#include <sstream>
+#include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <vector>
 
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#define MAIN_HAS_MEMORY_RESOURCE
+#endif
+#endif
+
 using namespace std;
 
 
+int allocator_test()
+{
+  cout << "*********** Allocator test *************" << endl;
+  int fail = 0;
+
+#ifdef MAIN_HAS_MEMORY_RESOURCE
+  // Everything is allocated in the arena: the null upstream resource throws if it is exceeded
+  static char buffer[1 << 16];
+  std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+  try {
+    typedef std::pmr::polymorphic_allocator<double> Double_allocator;
+    Array2d<double, Row_major, Double_allocator> A(10, 20, &arena);
+    A.fill(1.5);
+    A.push_back_column(std::vector<double>(10, 2.));
+    Array2d<double, Row_major, Double_allocator> B(A, &arena);
+    B.transpose_in_place();
+    if (A.sum() != 320. || B.nb_rows() != 21 || B(20,9) != 2. || B.get_allocator().resource() != &arena)
+      fail++;
+
+    std::vector<unsigned int> wt(3);
+    std::vector<int> val(3);
+    wt[0] = 3; wt[1] = 4; wt[2] = 5;
+    val[0] = 4; val[1] = 5; val[2] = 6;
+    const Knapsack_table_mode modes[] = { KNAPSACK_FULL_TABLE, KNAPSACK_ROLLING_ROW, KNAPSACK_BIT_TABLE };
+    for (int k = 0; k < 4; k++) {
+      Knapsack<int, std::pmr::polymorphic_allocator<int> > knapsack(9, wt, val, &arena);
+      if (k < 3)
+        knapsack.set_table_mode(modes[k]);
+      else
+        knapsack.set_value_only(true);
+      if (knapsack() != 11)
+        fail++;
+    }
+    std::vector<unsigned int> count(3, 2), copies;
+    Knapsack_bounded<int, std::pmr::polymorphic_allocator<int> > bounded(12, wt, val, count, &arena);
+    if (bounded() != 15)
+      fail++;
+    bounded.get_chosen_objects(copies);
+    if (copies.size() != 3 || copies[0] != 1 || copies[1] != 1 || copies[2] != 1)
+      fail++;
+
+    typedef std::pmr::polymorphic_allocator<unsigned int> Index_allocator;
+    Basic_N_choose_K_iterator<Index_allocator> nck(5, 2, &arena);
+    Basic_Hcube_iterator<Index_allocator> hcube(3, 2, &arena);
+    Basic_Random_iterator<Index_allocator> random(10, &arena);
+    int nb_combinations = 0, nb_vertices = 0, sum = 0;
+    for (nck.reset(false); !nck.is_ended(); ++nck)
+      nb_combinations++;
+    for (; !hcube.is_ended(); ++hcube)
+      nb_vertices++;
+    for (; !random.is_ended(); ++random)
+      sum += random();
+    if (nb_combinations != 10 || nb_vertices != 8 || sum != 45)
+      fail++;
+  }
+  catch (std::bad_alloc&) {
+    cout << "Allocation outside of the arena" << endl;
+    fail++;
+  }
+#else
+  cout << "std::pmr is not available." << endl;
+#endif
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
 int array2d_test()
 {
   cout << "************* Array2d test *************" << endl;
@@ -97,6 +189,30 @@ int array2d_test()
   {
     fail++;
   }
+
+  Array2d<int> tab_7(3,4);
+  for (int j = 0; j < tab_7.nb_rows(); j++)
+    for (int i = 0; i < tab_7.nb_columns(); i++)
+      tab_7(j,i) = 10*j+i;
+  tab_7.erase_column(1);
+  tab_7.erase_row(0);
+  tab_7.push_back_column(vector<int>(2,5));
+  if (tab_7.nb_rows()!=2 || tab_7.nb_columns()!=4
+    || tab_7(0,0)!=10 || tab_7(0,1)!=12 || tab_7(0,2)!=13 || tab_7(0,3)!=5
+    || tab_7(1,0)!=20 || tab_7(1,1)!=22 || tab_7(1,2)!=23 || tab_7(1,3)!=5 )
+  {
+    fail++;
+  }
+
+  int sum = 0, nb_elements = 0;
+  for (Array2d<int>::const_iterator it = tab_7.begin(); it != tab_7.end(); ++it) {
+    sum += *it;
+    nb_elements++;
+  }
+  const int* row = tab_7.row_data(1);
+  if (nb_elements != 8 || sum != 110 || row[1] != 22 || tab_7.unchecked(1,2) != 23
+      || tab_7.row_end(0)-tab_7.row_begin(0) != 4)
+    fail++;
   
   if (fail > 0) {
     cout << "===> FAIL <===" << endl;
@@ -106,6 +222,696 @@ int array2d_test()
 }
 
 
+int array2d_kernels_test()
+{
+  cout << "********* Array2d kernels test *********" << endl;
+  int fail = 0;
+
+  // Odd sizes to go through the vectorized loops and their remainders
+  int p = 7; int n = 37;
+  Array2d<double> A(p,n), B(p,n);
+  Array2d<int> C(p,n), D(p,n);
+  for (int j = 0; j < p; j++) {
+    for (int i = 0; i < n; i++) {
+      A(j,i) = 0.5*(j+1) - 0.25*i;
+      B(j,i) = 1.0/(1+i+j);
+      C(j,i) = (3*i+j) % 11 - 5;
+      D(j,i) = (i*j) % 7 - 3;
+    }
+  }
+  A(3,20) = -100;
+  C(6,36) = 42;
+
+  double dot_ref = 0, sum_ref = 0;
+  int dot_int_ref = 0;
+  for (int j = 0; j < p; j++) {
+    for (int i = 0; i < n; i++) {
+      dot_ref += A(j,i)*B(j,i);
+      sum_ref += A(j,i);
+      dot_int_ref += C(j,i)*D(j,i);
+    }
+  }
+
+  Tolerance tol(1e-9, 1e-12);
+  if (!tol.close(A.dot_product(B), dot_ref) || !tol.close(A.sum(), sum_ref)
+      || A.min() != -100 || C.max() != 42 || C.dot_product(D) != dot_int_ref)
+    fail++;
+
+  // Same computations on rows which are not contiguous
+  Array2d<double> E;
+  E.copy(A);
+  E.push_back_column(vector<double>(p, 1.));
+  E.erase_column(n);
+  if (!tol.close(E.dot_product(B), dot_ref) || !tol.close(E.norm2(), A.norm2()) || E.min() != -100)
+    fail++;
+
+  E.axpy(-1., A);
+  if (E.min() != 0 || E.max() != 0)
+    fail++;
+
+  float x[19], y[19];
+  float dot_float_ref = 0;
+  for (int i = 0; i < 19; i++) {
+    x[i] = 0.5f*i; y[i] = 2.f-i;
+    dot_float_ref += x[i]*y[i];
+  }
+  if (fabs(Simd_kernels<float>::dot(x, y, 19) - dot_float_ref) > 1e-3
+      || Simd_kernels<float>::max(y, 19) != 2.f || Simd_kernels<float>::min(x, 19) != 0.f)
+    fail++;
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+double twice(double x) { return 2*x; }
+
+
+int array2d_parallel_test()
+{
+  cout << "******** Array2d parallel test *********" << endl;
+  int fail = 0;
+
+  // Small grain size to split the array in many blocks
+  Parallel_policy det_policy(0, 100, true);
+  Parallel_policy seq_policy(1, 100, true);
+  Parallel_policy nondet_policy(0, 100, false);
+
+  Array2d<double> A(300, 47);
+  A.fill(1.5, det_policy);
+  A.transform(twice, det_policy);  // All elements are 3
+  for (int j = 0; j < A.nb_rows(); j++)
+    A(j, j % A.nb_columns()) = 0.1*j;
+
+  double sum_det = A.sum(det_policy);
+  if (sum_det != A.sum(seq_policy)  // Bitwise reproducible whatever the number of threads
+      || fabs(sum_det - A.sum(nondet_policy)) > 1e-9
+      || fabs(sum_det - (300*46*3. + 0.1*299*300/2)) > 1e-9
+      || A.max(nondet_policy) != 0.1*299 || A.min(det_policy) != 0.)
+    fail++;
+
+  Array2d<double> B;
+  B.copy(A, det_policy);
+  B.axpy(-1., A, det_policy);
+  if (B.nb_rows() != 300 || B.nb_columns() != 47 || B.norm2(det_policy) != 0.)
+    fail++;
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+int array2d_layout_test()
+{
+  cout << "********* Array2d layout test **********" << endl;
+  int fail = 0;
+
+  // The same edits on both layouts must give the same arrays
+  Array2d<int> R;
+  Array2d<int, Column_major> C;
+  for (int i = 0; i < 6; i++) {
+    std::vector<int> col(4);
+    for (int j = 0; j < 4; j++)
+      col[j] = 10*j + i;
+    R.push_back_column(col);
+    C.push_back_column(col);
+  }
+  R.insert_column(2, std::vector<int>(4, -1));
+  C.insert_column(2, std::vector<int>(4, -1));
+  R.erase_column(4);
+  C.erase_column(4);
+  R.erase_row(1);
+  C.erase_row(1);
+  R.push_back_row(std::vector<int>(6, 7));
+  C.push_back_row(std::vector<int>(6, 7));
+  R.resize(5, 8, 2);
+  C.resize(5, 8, 2);
+
+  if (C.nb_rows() != 5 || C.nb_columns() != 8 || C.nb_lines() != 8 || C.line_size() != 5)
+    fail++;
+  for (int j = 0; j < R.nb_rows(); j++)
+    for (int i = 0; i < R.nb_columns(); i++)
+      if (R(j,i) != C(j,i))
+        fail++;
+  if (C(0,2) != -1 || C(1,5) != 25 || C(3,0) != 7 || C(4,7) != 2 || C.column_data(3)[2] != 32)
+    fail++;
+  if (C.sum() != R.sum() || C.min() != -1 || C.max() != 35 || C.dot_product(C) != R.dot_product(R))
+    fail++;
+
+  C.swap_row(0, 2);
+  C.swap_column(0, 1);
+  if (C(2,1) != 0 || C(0,0) != 31)
+    fail++;
+  C.erase_rows(0, C.nb_rows());
+  if (C.nb_rows() != 0 || C.nb_columns() != 0)
+    fail++;
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+template <class Layout>
+int array2d_transpose_multiply_test()
+{
+  int fail = 0;
+  Parallel_policy policy(0, 500, true);
+
+  Array2d<int, Layout> A(37, 150);
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++)
+      A(j,i) = (7*j + 3*i) % 11 - 5;
+
+  Array2d<int, Layout> T;
+  A.transpose(T, policy);
+  if (T.nb_rows() != 150 || T.nb_columns() != 37)
+    fail++;
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++)
+      if (T(i,j) != A(j,i))
+        fail++;
+
+  // Product (37x150) * (150x37) against the naive triple loop
+  Array2d<int, Layout> C;
+  A.multiply(T, C, policy);
+  if (C.nb_rows() != 37 || C.nb_columns() != 37)
+    fail++;
+  for (int j = 0; j < C.nb_rows(); j++)
+    for (int i = 0; i < C.nb_columns(); i++) {
+      int c = 0;
+      for (int k = 0; k < A.nb_columns(); k++)
+        c += A(j,k) * T(k,i);
+      if (C(j,i) != c)
+        fail++;
+    }
+
+  // In place transpose of the square product (not a multiple of the tile size)
+  Array2d<int, Layout> S(130, 130);
+  for (int j = 0; j < S.nb_rows(); j++)
+    for (int i = 0; i < S.nb_columns(); i++)
+      S(j,i) = 1000*j + i;
+  S.transpose_in_place(policy);
+  for (int j = 0; j < S.nb_rows(); j++)
+    for (int i = 0; i < S.nb_columns(); i++)
+      if (S(j,i) != 1000*i + j)
+        fail++;
+
+  // Aliasing and non-square in place transpose
+  T.multiply(A, T, policy);
+  A.transpose_in_place(policy);
+  if (T.nb_rows() != 150 || T.nb_columns() != 150 || T(3,5) != T(5,3)  // T = tA * A
+      || A.nb_rows() != 150 || A.nb_columns() != 37 || A(5,3) != -2)
+    fail++;
+
+  return fail;
+}
+
+
+int array2d_transpose_multiply_test()
+{
+  cout << "**** Array2d transpose multiply test ****" << endl;
+  int fail = array2d_transpose_multiply_test<Row_major>()
+             + array2d_transpose_multiply_test<Column_major>();
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+template <class Layout>
+int array2d_batch_test()
+{
+  int fail = 0;
+
+  // Element (j,i) is 100*j + i: the indexes can be read from the values
+  Array2d<int, Layout> A(8, 9);
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++)
+      A(j,i) = 100*j + i;
+
+  std::vector<int> rows(3);
+  rows[0] = 6; rows[1] = 1; rows[2] = 6;
+  A.erase_rows(rows);
+  rows[0] = 0; rows[1] = 8; rows[2] = 4;
+  A.erase_columns(rows);
+  // Rows 0 2 3 4 5 7, columns 1 2 3 5 6 7
+  if (A.nb_rows() != 6 || A.nb_columns() != 6 || A(1,0) != 201 || A(5,3) != 705 || A(2,5) != 307)
+    fail++;
+
+  // Two rows before the row 0, one row at the end, one row before the row 3
+  std::vector<int> positions(4);
+  positions[0] = 6; positions[1] = 0; positions[2] = 3; positions[3] = 0;
+  std::vector< std::vector<int> > R(4, std::vector<int>(6));
+  for (int k = 0; k < 4; k++)
+    R[k][0] = -k;
+  A.insert_rows(positions, R);
+  if (A.nb_rows() != 10 || A(0,0) != -1 || A(1,0) != -3 || A(2,0) != 1 || A(5,0) != -2
+      || A(6,0) != 401 || A(9,0) != 0 || A(8,3) != 705)
+    fail++;
+
+  positions.assign(2, 6);
+  std::vector< std::vector<int> > C(2, std::vector<int>(10, 9));
+  A.push_back_column(std::vector<int>(10, 8));
+  A.insert_columns(positions, C);
+  if (A.nb_columns() != 9 || A(2,5) != 7 || A(2,6) != 9 || A(2,7) != 9 || A(2,8) != 8 || A(3,4) != 206)
+    fail++;
+
+  // Reverse the rows and rotate the columns
+  std::vector<int> perm(10);
+  for (int j = 0; j < 10; j++)
+    perm[j] = 9 - j;
+  Array2d<int, Layout> B(A);
+  A.permute_rows(perm);
+  perm.resize(9);
+  for (int i = 0; i < 9; i++)
+    perm[i] = (i + 1) % 9;
+  A.permute_columns(perm);
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++)
+      if (A(j,i) != B(9-j, (i+1) % 9))
+        fail++;
+
+  // Erasing all the columns leaves the rows, as erase_columns(int,int)
+  for (int i = 0; i < 9; i++)
+    perm[i] = 8 - i;
+  A.erase_columns(perm);
+  B.erase_columns(0, 9);
+  if (A.nb_rows() != 10 || A.nb_columns() != 0 || B.nb_rows() != 10 || B.nb_columns() != 0)
+    fail++;
+
+  return fail;
+}
+
+
+int array2d_batch_test()
+{
+  cout << "********** Array2d batch test **********" << endl;
+  int fail = array2d_batch_test<Row_major>() + array2d_batch_test<Column_major>();
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+Array2d<int> make_identity(int iN)
+{
+  Array2d<int> I(iN, iN);
+  for (int j = 0; j < iN; j++)
+    I(j,j) = 1;
+  return I;
+}
+
+
+int array2d_aligned_test()
+{
+  cout << "********* Array2d aligned test *********" << endl;
+  int fail = 0;
+
+  typedef Array2d<double, Row_major, Aligned_allocator<double> > Aligned_array2d;
+  Aligned_array2d A(7, 13);
+  Array2d<double> B(7, 13);
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++)
+      A(j,i) = B(j,i) = j + 0.5*i;
+  A.insert_row(3, std::vector<double>(13, 1.));
+  B.insert_row(3, std::vector<double>(13, 1.));
+  A.push_back_column(std::vector<double>(8, 2.));
+  B.push_back_column(std::vector<double>(8, 2.));
+
+  // Each row starts on 64 bytes
+  if (A.stride() % 8 != 0 || A.stride() < A.nb_columns() || B.stride() % 8 == 0)
+    fail++;
+  for (int j = 0; j < A.nb_rows(); j++)
+    if ((size_t)A.row_data(j) % 64 != 0)
+      fail++;
+
+  Aligned_array2d C(A);
+  Aligned_array2d D;
+  D = A + C;
+  if (A.sum() != B.sum() || A.dot_product(C) != B.dot_product(B) || D.sum() != 2*B.sum()
+      || C.stride() != 16 || (size_t)D.row_data(5) % 64 != 0)
+    fail++;
+
+  Array2d<int, Column_major, Aligned_allocator<int, 32> > E(3, 5);
+  if (E.stride() != 8 || (size_t)E.column_data(4) % 32 != 0)
+    fail++;
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+int array2d_copy_move_test()
+{
+  cout << "******** Array2d copy move test ********" << endl;
+  int fail = 0;
+
+  const Array2d<int> I = make_identity(5);  // Moved out of the function
+  Array2d<int> A(I);
+  if (A.nb_rows() != 5 || A.nb_columns() != 5 || A.sum() != 5 || A(3,3) != 1)
+    fail++;
+
+  // Copy of an array with gaps between its lines, into an array with enough capacity
+  Array2d<int> B(5, 3);
+  B.push_back_column(std::vector<int>(5, 2));
+  Array2d<int> C(20, 20);
+  const int* buffer = C.row_data(0);
+  C = B;
+  if (C.row_data(0) != buffer || C.nb_rows() != 5 || C.nb_columns() != 4 || C.sum() != 10
+      || C(4,3) != 2 || C.row_end(1)-C.row_begin(1) != 4)
+    fail++;
+
+  // Move and swap
+  Array2d<int> D(std::move(A));
+  if (A.nb_rows() != 0 || A.nb_columns() != 0 || D.sum() != 5)
+    fail++;
+  A = std::move(C);
+  A.swap(D);
+  if (A.sum() != 5 || D.sum() != 10 || D.nb_columns() != 4 || C.nb_rows() != 0)
+    fail++;
+
+  Array2d<std::string, Column_major> S(2, 3);
+  S(1,2) = "abc";
+  Array2d<std::string, Column_major> S2;
+  S2 = S;
+  if (S2(1,2) != "abc" || S2.nb_rows() != 2 || S2.nb_columns() != 3)
+    fail++;
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+int array2d_io_test()
+{
+  cout << "*********** Array2d io test ************" << endl;
+  int fail = 0;
+
+  Array2d<double> A(13, 7);
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++)
+      A(j,i) = 0.5*j - i;
+  A.push_back_column(std::vector<double>(13, 3.));  // Gaps between the rows
+
+  const std::string file_name = "array2d_io_test.bin";
+  if (!save_array2d(A, file_name))
+    fail++;
+
+  Array2d<double> B;
+  Array2d<double, Column_major> C;
+  if (!load_array2d(B, file_name) || !load_array2d(C, file_name))
+    fail++;
+  {
+    Array2d_mapped<double> M(file_name);
+    if (!M.is_open() || M.nb_rows() != 13 || M.nb_columns() != 8)
+      fail++;
+    for (int j = 0; j < A.nb_rows(); j++)
+      for (int i = 0; i < A.nb_columns(); i++)
+        if (B(j,i) != A(j,i) || C(j,i) != A(j,i) || M(j,i) != A(j,i))
+          fail++;
+    Array2d_mapped<double> M2(std::move(M));
+    if (M.is_open() || M2.line_data(12)[7] != 3.)
+      fail++;
+  }
+
+  // Wrong type or layout
+  cerr << "The following errors are expected:" << endl;
+  Array2d<int> I;
+  Array2d_mapped<double, Column_major> MC;
+  if (load_array2d(I, file_name) || MC.open(file_name) || MC.is_open()
+      || load_array2d(B, "file_which_does_not_exist.bin") || B.nb_rows() != 0)
+    fail++;
+
+  // Corrupt headers: dimensions above INT_MAX, size overflowing int64, no elements after the header
+  const int64_t sizes[3][2] = { {(int64_t)1 << 40, 2}, {2147483647, 2147483647}, {1000, 1000} };
+  for (int k = 0; k < 3; k++) {
+    Array2d_file_header header;
+    header.set<double>(sizes[k][0], sizes[k][1], true);
+    std::ofstream file(file_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    file.write((const char*)&header, sizeof(header));
+    file.close();
+    Array2d_mapped<double> M;
+    if (load_array2d(B, file_name) || B.nb_rows() != 0 || M.open(file_name))
+      fail++;
+  }
+
+  remove(file_name.c_str());
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+/** @brief Stream buffer giving a text, then failing (the read throws an exception) */
+class Failing_streambuf : public std::streambuf
+{
+public:
+  explicit Failing_streambuf(const std::string& iText) : _text(iText), _is_read(false) {}
+
+protected:
+  int_type underflow()
+  {
+    if (_is_read)
+      throw std::ios_base::failure("Failing_streambuf");
+    _is_read = true;
+    setg(&_text[0], &_text[0], &_text[0] + _text.size());
+    return traits_type::to_int_type(_text[0]);
+  }
+
+  std::string _text;
+  bool _is_read;
+};
+
+
+int array2d_text_test()
+{
+  cout << "********** Array2d text test ***********" << endl;
+  int fail = 0;
+
+  Array2d<double> A(50, 4);
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++)
+      A(j,i) = (j - 2.) / (i + 3.);
+
+  // Round trip through a CSV file (the doubles are read back exactly, the rows by several blocks)
+  const std::string file_name = "array2d_text_test.csv";
+  Array2d<double, Column_major> B;
+  if (!write_array2d_text(A, file_name, ',') || !read_array2d_text(B, file_name, ','))
+    fail++;
+  if (B.nb_rows() != 50 || B.nb_columns() != 4)
+    fail++;
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++)
+      if (B(j,i) != A(j,i))
+        fail++;
+  remove(file_name.c_str());
+
+  // Spaces, carriage returns, empty lines, missing final end of line
+  std::istringstream tsv("1\t -2 \t3\r\n\n+4\t5\t6");
+  Array2d<int> C;
+  if (!read_array2d_text(C, tsv) || C.nb_rows() != 2 || C.nb_columns() != 3
+      || C(0,1) != -2 || C(1,0) != 4 || C.sum() != 17)
+    fail++;
+
+  std::ostringstream out;
+  write_array2d_text(C, out);
+  if (out.str() != "1\t-2\t3\n4\t5\t6\n")
+    fail++;
+
+  cerr << "The following errors are expected:" << endl;
+  std::istringstream bad_element("1,2\n3,x\n"), bad_row("1,2\n3\n");
+  if (read_array2d_text(C, bad_element, ',') || read_array2d_text(C, bad_row, ',')
+      || C.nb_rows() != 0)
+    fail++;
+
+  // Error of the stream after two lines, and file which cannot be read (a directory)
+  Failing_streambuf failing("1\t2\n3\t4\n");
+  std::istream failing_stream(&failing);
+  if (read_array2d_text(C, failing_stream) || C.nb_rows() != 0)
+    fail++;
+  if (read_array2d_text(C, std::string(".")) || C.nb_rows() != 0)
+    fail++;
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+int array2d_expr_test()
+{
+  cout << "********** Array2d expr test ***********" << endl;
+  int fail = 0;
+
+  Array2d<double> A(9, 21), B(9, 21), D(9, 21);
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++) {
+      A(j,i) = j - 0.5*i;
+      B(j,i) = 1. + i;
+      D(j,i) = 0.25*j*i;
+    }
+  B.push_back_column(std::vector<double>(9, 0.));  // B has gaps between its rows
+  B.erase_column(21);
+
+  Array2d<double> C;
+  C = 2.*A + B - D;
+  Array2d<double> E(A*B/2. - (-D));
+  if (C.nb_rows() != 9 || C.nb_columns() != 21 || E.nb_rows() != 9)
+    fail++;
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++)
+      if (C(j,i) != 2.*A(j,i) + B(j,i) - D(j,i) || E(j,i) != A(j,i)*B(j,i)/2. + D(j,i))
+        fail++;
+
+  // The assigned array can appear in the expression
+  C = C - 2.*A - B + D + 1;
+  if (C.sum() != 9*21 || C.min() != 1.)
+    fail++;
+
+  Array2d<int, Column_major> F(4, 3), G(4, 3);
+  F.fill(6);
+  G.fill(2);
+  Array2d<int, Column_major> H;
+  H = F/G * 10 - 1 - G;
+  if (H.nb_rows() != 4 || H.nb_columns() != 3 || H.sum() != 12*27)
+    fail++;
+
+  // Serial assignment, and assignment by blocks of 2 rows shared by 4 threads
+  Array2d<double> S, P;
+  S.assign(2.*A + B - D, Parallel_policy(1));
+  P.assign(2.*A + B - D, Parallel_policy(4, 2*21));
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++)
+      if (S(j,i) != 2.*A(j,i) + B(j,i) - D(j,i) || P(j,i) != S(j,i))
+        fail++;
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+int array2d_view_test()
+{
+  cout << "********** Array2d view test ***********" << endl;
+  int fail = 0;
+
+  Array2d<int> A(6, 8);
+  for (int j = 0; j < A.nb_rows(); j++)
+    for (int i = 0; i < A.nb_columns(); i++)
+      A(j,i) = 10*j + i;
+
+  Array2d_view<int> v(A);
+  Array2d_view<int> b = v.block(1, 2, 3, 4);
+  if (b.nb_rows() != 3 || b.nb_columns() != 4 || b(0,0) != 12 || b(2,3) != 35
+      || b.sum() != 12*(12+35)/2 || b.min() != 12 || b.max() != 35)
+    fail++;
+  if (v.row(4).sum() != 8*40+28 || v.column(3).sum() != 150+18 || b.column(1).max() != 33)
+    fail++;
+
+  // Every other row of the columns 1, 4 and 7
+  Array2d_view<const int> s = v.strided(0, 1, 3, 3, 2, 3);
+  if (s(1,2) != 27 || s.sum() != 3*(1+4+7) + 3*(0+20+40) || s.transpose()(2,1) != 27)
+    fail++;
+
+  // The views write in the array, without copy
+  b.fill(-1);
+  v.block(4, 0, 2, 2).transform([](int x) { return 2*x; });
+  if (A(2,3) != -1 || A(4,4) != 44 || A(5,1) != 102 || A.sum() != v.sum())
+    fail++;
+
+  // Views on a column-major array and dot product between different layouts
+  Array2d<int, Column_major> B(6, 8);
+  Array2d_view<int>(B).copy(v);
+  const Array2d<int, Column_major>& C = B;
+  Array2d_view<const int> w(C);
+  if (w.row_stride() != 1 || B(5,1) != 102 || w.dot_product(v) != v.norm2()
+      || w.block(1, 2, 3, 4).sum() != -12)
+    fail++;
+
+  Array2d<int> D;
+  w.block(3, 5, 2, 3).transpose().copy_to(D);
+  if (D.nb_rows() != 3 || D.nb_columns() != 2 || D(2,1) != 47)
+    fail++;
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+int fixed_array2d_test()
+{
+  cout << "********* Fixed_array2d test ***********" << endl;
+  int fail = 0;
+
+  // Rotation of 90 degrees around z
+  Fixed_array2d<int, 3, 3> R = { 0, -1, 0,
+                                 1,  0, 0,
+                                 0,  0, 1 };
+  Fixed_array2d<int, 3, 1> p = { 1, 2, 3 };
+  Fixed_array2d<int, 3, 1> q = R.multiply(p);
+  if (q(0,0) != -2 || q(1,0) != 1 || q(2,0) != 3 || R.nb_rows() != 3 || sizeof(R) != 9*sizeof(int))
+    fail++;
+
+  Fixed_array2d<int, 3, 3> I = R.multiply(R.transpose());
+  R.transpose_in_place();
+  R.axpy(2, I);
+  if (I.sum() != 3 || I.dot_product(I) != 3 || R(0,1) != 1 || R(2,2) != 3 || R.max() != 3 || R.min() != -1)
+    fail++;
+
+  // Non-square arrays and conversion from and to Array2d
+  Array2d<int, Column_major> A(2, 4);
+  for (int j = 0; j < 2; j++)
+    for (int i = 0; i < 4; i++)
+      A(j,i) = 4*j + i;
+  Fixed_array2d<int, 2, 4> B(A);
+  Fixed_array2d<int, 4, 2> T = B.transpose();
+  Fixed_array2d<int, 2, 2> C = B.multiply(T);
+  Array2d<int> D;
+  C.copy_to(D);
+  if (T(3,1) != 7 || C(0,1) != 38 || C(1,1) != 126 || D.nb_rows() != 2 || D(1,0) != 38)
+    fail++;
+
+  B.transform([](int x) { return x*x; });
+  B.swap_row(0, 1);
+  if (B.norm2() != 1+16+81+256+625+1296+2401 || B(0,3) != 49 || *(B.end()-1) != 9)
+    fail++;
+
+  // Shape above the template depth of a loop unrolled element by element
+  Fixed_array2d<double, 32, 31> L(0.5);
+  L(31,30) = 2.;
+  Fixed_array2d<double, 31, 32> Lt = L.transpose();
+  L.fill(1.);
+  if (Lt.sum() != 0.5*991 + 2. || Lt(30,31) != 2. || L.dot_product(L) != 992. || L.max() != 1.)
+    fail++;
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
 int hcube_iterator_test()
 {
   cout << "********* Hcube_iterator test **********" << endl;
@@ -266,6 +1072,577 @@ int KnapSack_test3()
 }
 
 
+/** @brief Return a pseudo-random integer in [0, iN[ and update the seed (linear congruential generator) */
+static unsigned int knapsack_random(unsigned int& ioSeed, unsigned int iN)
+{
+  ioSeed = ioSeed*1103515245 + 12345;
+  return (ioSeed >> 16) % iN;
+}
+
+/**
+ * @brief Generate a random instance of the knapsack tests
+ * @param[in,out] ioSeed Seed of the generator
+ * @param[in] iN Number of items
+ * @param[in] iNbWeights The weights are in [0, iNbWeights[
+ * @param[in] iNbValues The values are in [-iOffset, iNbValues-iOffset[
+ * @param[in] iOffset Offset of the values
+ * @param[out] oWt Weights of the items
+ * @param[out] oVal Values of the items
+ */
+template <class T>
+static void knapsack_random_instance(unsigned int& ioSeed, int iN, unsigned int iNbWeights, unsigned int iNbValues, T iOffset,
+                                     vector<unsigned int>& oWt, vector<T>& oVal)
+{
+  oWt.resize(iN);
+  oVal.resize(iN);
+  for (int i = 0; i < iN; i++) {
+    oWt[i] = knapsack_random(ioSeed, iNbWeights);
+    oVal[i] = T(knapsack_random(ioSeed, iNbValues)) - iOffset;
+  }
+}
+
+/**
+ * @brief Return true if a solution fits in the knapsack and reaches a value
+ * @param[in] iSolution Number of chosen copies of each item (or true if the item is chosen)
+ * @param[in] iWt Weights of the items
+ * @param[in] iVal Values of the items
+ * @param[in] iW Weight limit of the knapsack
+ * @param[in] iValue Expected value of the solution
+ * @param[in] iTolerance Tolerance on the value of the solution
+ */
+template <class C, class T>
+static bool knapsack_is_feasible(const vector<C>& iSolution, const vector<unsigned int>& iWt, const vector<T>& iVal,
+                                 unsigned int iW, T iValue, T iTolerance = T())
+{
+  if (iSolution.size() != iWt.size())
+    return false;
+  T value = T();
+  unsigned int weight = 0;
+  for (size_t i = 0; i < iSolution.size(); i++) {
+    value += iSolution[i] * iVal[i];
+    weight += iSolution[i] * iWt[i];
+  }
+  return !(value + iTolerance < iValue) && !(iValue + iTolerance < value) && weight <= iW;
+}
+
+
+int KnapSack_table_test()
+{
+  cout << "******** Knapsack table test ***********" << endl;
+  int fail = 0;
+
+  // Random instances solved with the whole table and with a rolling row
+  unsigned int seed = 12345;
+  for (int t = 0; t < 20; t++) {
+    vector<int> val;
+    vector<unsigned int> wt;
+    knapsack_random_instance(seed, 1 + t*3, 40, 100, 10, wt, val);
+    const unsigned int W = 7*t + 3;
+
+    Knapsack<int> full(W, wt, val);
+    Knapsack<int> rolling(W, wt, val);
+    rolling.set_table_mode(KNAPSACK_ROLLING_ROW);
+    Knapsack<int> value_only(W, wt, val);
+    value_only.set_value_only(true);
+    Knapsack<int> bits(W, wt, val);
+    bits.set_table_mode(KNAPSACK_BIT_TABLE);
+    const int opt = full();
+    if (rolling() != opt || value_only() != opt || bits() != opt)
+      fail++;
+
+    // The table of bits gives the same items as the full table
+    vector<bool> S1, S2;
+    full.get_chosen_objects(S1);
+    bits.get_chosen_objects(S2);
+    if (S1 != S2)
+      fail++;
+
+    // Both solutions are feasible and optimal
+    for (int k = 0; k < 2; k++) {
+      vector<bool> Solution;
+      (k == 0 ? full : rolling).get_chosen_objects(Solution);
+      if (!knapsack_is_feasible(Solution, wt, val, W, opt))
+        fail++;
+    }
+  }
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+template <class T>
+int KnapSack_simd_test()
+{
+  int fail = 0;
+
+  // Weights around KNAPSACK_MIN_SIMD_WEIGHT, against the dynamic programming written naively
+  unsigned int seed = 777;
+  const int n = 60;
+  const unsigned int W = 1000;
+  vector<T> val;
+  vector<unsigned int> wt;
+  knapsack_random_instance(seed, n, 150, 1000, T(100), wt, val);
+  vector<T> K(W+1, T());
+  for (int i = 0; i < n; i++)
+    for (unsigned int w = W; w >= wt[i] && w <= W; w--)
+      if (K[w] < K[w-wt[i]] + val[i])
+        K[w] = K[w-wt[i]] + val[i];
+
+  Knapsack<T> full(W, wt, val);
+  Knapsack<T> rolling(W, wt, val);
+  rolling.set_table_mode(KNAPSACK_ROLLING_ROW);
+  if (full() != K[W] || rolling() != K[W])
+    fail++;
+
+  // Each vectorized version of the kernel against the scalar loop
+  T x[37], y[37], z[37];
+  for (int i = 0; i < 37; i++) {
+    x[i] = T((i*7) % 13);
+    y[i] = z[i] = T((i*5) % 17);
+  }
+  for (int i = 0; i < 37; i++)
+    z[i] = std::max(z[i], x[i] + T(3));
+  Simd_kernels<T>::max_add(T(3), x, y, 37);
+  for (int i = 0; i < 37; i++)
+    if (y[i] != z[i])
+      fail++;
+#ifdef SIMD_TOOLS_X86
+  if (simd_has_avx2()) {
+    for (int i = 0; i < 37; i++)
+      y[i] = T((i*5) % 17);
+    simd_max_add_avx2(T(3), x, y, 37);
+    for (int i = 0; i < 37; i++)
+      if (y[i] != z[i])
+        fail++;
+  }
+#endif
+
+  return fail;
+}
+
+
+int KnapSack_simd_test()
+{
+  cout << "********* Knapsack simd test ***********" << endl;
+  int fail = KnapSack_simd_test<int>() + KnapSack_simd_test<long long>()
+             + KnapSack_simd_test<float>() + KnapSack_simd_test<double>();
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+int KnapSack_parallel_test()
+{
+  cout << "******* Knapsack parallel test *********" << endl;
+  int fail = 0;
+
+  unsigned int seed = 4242;
+  const unsigned int W = 777;
+  vector<double> val;
+  vector<unsigned int> wt;
+  knapsack_random_instance(seed, 45, 100, 300, 0., wt, val);
+  for (size_t i = 0; i < val.size(); i++)
+    val[i] *= 0.5;  // Values which are not integers
+  Knapsack<double> reference(W, wt, val);
+  const double opt = reference();
+  vector<bool> Solution;
+  reference.get_chosen_objects(Solution);
+
+  // Blocks of 50 weights shared by 4 threads, with all the table modes
+  Parallel_policy policy(4, 50);
+  const Knapsack_table_mode modes[] = { KNAPSACK_FULL_TABLE, KNAPSACK_ROLLING_ROW, KNAPSACK_BIT_TABLE };
+  for (int k = 0; k < 3; k++) {
+    Knapsack<double> knapsack(W, wt, val);
+    knapsack.set_parallel_policy(policy);
+    knapsack.set_table_mode(modes[k]);
+    vector<bool> S;
+    if (knapsack() != opt || knapsack.get_parallel_policy().get_grain_size() != 50)
+      fail++;
+    knapsack.get_chosen_objects(S);
+    if (!knapsack_is_feasible(S, wt, val, W, opt) || (k != 1 && S != Solution))
+      fail++;
+  }
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+/** @brief Value without conversion to double, with the operators required by Knapsack only */
+struct Knapsack_value
+{
+  int _v;
+  Knapsack_value() : _v(0) {}
+  explicit Knapsack_value(int iV) : _v(iV) {}
+  Knapsack_value operator+(const Knapsack_value& iV) const { return Knapsack_value(_v + iV._v); }
+  bool operator<(const Knapsack_value& iV) const { return _v < iV._v; }
+  bool operator==(const Knapsack_value& iV) const { return _v == iV._v; }
+};
+
+
+int KnapSack_preprocessing_test()
+{
+  cout << "***** Knapsack preprocessing test ******" << endl;
+  int fail = 0;
+
+  // Random instances with items too heavy, without value or without weight
+  unsigned int seed = 1618;
+  const Knapsack_table_mode modes[] = { KNAPSACK_FULL_TABLE, KNAPSACK_ROLLING_ROW, KNAPSACK_BIT_TABLE };
+  for (int t = 0; t < 30; t++) {
+    const int n = 1 + 2*t;
+    vector<int> val;
+    vector<unsigned int> wt;
+    knapsack_random_instance(seed, n, 50, 100, 10, wt, val);
+    const unsigned int W = 9*t + 4;
+    Knapsack<int> reference(W, wt, val);
+    const int opt = reference();
+
+    for (int k = 0; k < 4; k++) {
+      Knapsack<int> knapsack(W, wt, val);
+      knapsack.set_preprocessing(true);
+      if (k < 3)
+        knapsack.set_table_mode(modes[k]);
+      else
+        knapsack.set_value_only(true);
+      vector<bool> Solution;
+      if (knapsack() != opt || !knapsack.is_preprocessing() || knapsack.get_nb_core_items() > (size_t)n)
+        fail++;
+      knapsack.get_chosen_objects(Solution);
+      // No item is given with the value only
+      if (!knapsack_is_feasible(Solution, wt, val, W, k < 3 ? opt : 0))
+        fail++;
+    }
+  }
+
+  // Values close to the weights: most of the items are fixed by the bounds
+  {
+    const int n = 200;
+    vector<double> val(n);
+    vector<unsigned int> wt(n);
+    unsigned int sum = 0;
+    for (int i = 0; i < n; i++) {
+      wt[i] = 10 + knapsack_random(seed, 90);
+      val[i] = wt[i] * (0.5 + knapsack_random(seed, 1000) / 1000.);
+      sum += wt[i];
+    }
+    Knapsack<double> reference(sum/2, wt, val);
+    Knapsack<double> knapsack(sum/2, wt, val);
+    knapsack.set_preprocessing(true);
+    const double opt = reference();
+    vector<bool> Solution;
+    if (fabs(knapsack() - opt) > 1e-9 * opt || knapsack.get_nb_core_items() >= (size_t)n/2)
+      fail++;
+    knapsack.get_chosen_objects(Solution);
+    if (!knapsack_is_feasible(Solution, wt, val, sum/2, opt, 1e-9 * opt))
+      fail++;
+    cout << "Items in the table: " << knapsack.get_nb_core_items() << " / " << n << endl;
+  }
+
+  // Without conversion to double, only the items too heavy or without value are removed
+  {
+    vector<unsigned int> wt(4);  wt[0] = 3; wt[1] = 4; wt[2] = 12; wt[3] = 5;
+    vector<Knapsack_value> val(4);
+    val[0] = Knapsack_value(4); val[1] = Knapsack_value(5); val[2] = Knapsack_value(9); val[3] = Knapsack_value(-6);
+    Knapsack<Knapsack_value> knapsack(9, wt, val);
+    knapsack.set_preprocessing(true);
+    vector<bool> Solution;
+    if (knapsack()._v != 9 || knapsack.get_nb_core_items() != 2)
+      fail++;
+    knapsack.get_chosen_objects(Solution);
+    if (!Solution[0] || !Solution[1] || Solution[2] || Solution[3])
+      fail++;
+  }
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+int KnapSack_batch_test()
+{
+  cout << "********* Knapsack batch test **********" << endl;
+  int fail = 0;
+
+  unsigned int seed = 31415;
+  const int n = 40;
+  vector<int> val;
+  vector<unsigned int> wt;
+  knapsack_random_instance(seed, n, 70, 100, 5, wt, val);
+  vector<unsigned int> capacities;
+  for (unsigned int w = 0; w <= 600; w += 37)
+    capacities.push_back(600 - w);
+
+  // Same values and items as the resolution of each capacity
+  Knapsack<int> batch;
+  batch(0, wt, val);
+  vector<int> values, values_only;
+  vector< vector<bool> > solutions;
+  batch.solve_batch(capacities, values, solutions);
+  for (size_t k = 0; k < capacities.size(); k++) {
+    Knapsack<int> single(capacities[k], wt, val);
+    vector<bool> Solution, S;
+    const int opt = single();
+    single.get_chosen_objects(Solution);
+    batch.get_chosen_objects(capacities[k], S);
+    if (values[k] != opt || solutions[k] != Solution || batch.get_optimal_value(capacities[k]) != opt || S != Solution)
+      fail++;
+  }
+  if (batch.get_optimal_value() != values[0])
+    fail++;
+
+  // Values only, with a single row
+  Knapsack<int> row(0, wt, val);
+  row.solve_batch(capacities, values_only);
+  if (values_only != values)
+    fail++;
+
+  // Items given as arrays, then all the capacities of the weight limit
+  Knapsack<int> arrays;
+  if (arrays(600, wt.data(), val.data(), n) != values[0] || arrays.solve_all_capacities() != values[0]
+      || arrays.get_optimal_value(capacities[3]) != values[3])
+    fail++;
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+int KnapSack_incremental_test()
+{
+  cout << "****** Knapsack incremental test *******" << endl;
+  int fail = 0;
+
+  // Random stream of additions and removals, compared to the resolution of the current items
+  unsigned int seed = 2024;
+  const unsigned int W = 150;
+  Knapsack_incremental<int> incremental(W);
+  vector<unsigned int> wt;
+  vector<int> val;
+  for (int t = 0; t < 300; t++) {
+    const unsigned int r = knapsack_random(seed, 100);
+    if (wt.empty() || r < 55) {
+      wt.push_back(knapsack_random(seed, 60));
+      val.push_back((int)knapsack_random(seed, 100) - 5);
+      incremental.add_item(wt.back(), val.back());
+    }
+    else {
+      // First, last or any item
+      size_t i = knapsack_random(seed, wt.size());
+      if (r < 70)
+        i = 0;
+      else if (r < 85)
+        i = wt.size() - 1;
+      wt.erase(wt.begin() + i);
+      val.erase(val.begin() + i);
+      incremental.remove_item(i);
+    }
+
+    Knapsack<int> reference(W, wt, val);
+    const int opt = reference();
+    vector<bool> Solution;
+    if (incremental() != opt || incremental.nb_items() != wt.size())
+      fail++;
+    incremental.get_chosen_objects(Solution);
+    if (!knapsack_is_feasible(Solution, wt, val, W, opt))
+      fail++;
+  }
+
+  // Example of the documentation
+  {
+    vector<unsigned int> wt(3);  wt[0] = 20;  wt[1] = 20; wt[2] = 30;
+    vector<int> val(3);          val[0] = 100; val[1] = 60; val[2] = 120;
+    Knapsack_incremental<int> knapsack(50, wt, val);
+    if (knapsack() != 220)
+      fail++;
+    knapsack.remove_item(0);
+    vector<bool> Solution;
+    knapsack.get_chosen_objects(Solution);
+    if (knapsack.get_optimal_value() != 180 || Solution.size() != 2 || !Solution[0] || !Solution[1])
+      fail++;
+  }
+
+  // Value type with the operators +, < and == only
+  {
+    Knapsack_incremental<Knapsack_value> knapsack(50);
+    knapsack.add_item(20, Knapsack_value(100));
+    knapsack.add_item(20, Knapsack_value(60));
+    knapsack.add_item(30, Knapsack_value(120));
+    vector<bool> Solution;
+    knapsack.get_chosen_objects(Solution);
+    if (!(knapsack() == Knapsack_value(220)) || Solution.size() != 3 || !Solution[0] || Solution[1] || !Solution[2])
+      fail++;
+  }
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+int KnapSack_variants_test()
+{
+  cout << "******* Knapsack variants test *********" << endl;
+  int fail = 0;
+
+  unsigned int seed = 8086;
+  for (int t = 0; t < 20; t++) {
+    const int n = 1 + t/2;
+    const unsigned int W = 20 + 13*t;
+    vector<unsigned int> wt, count(n), group(n);
+    vector<int> val;
+    knapsack_random_instance(seed, n, 40, 100, 5, wt, val);
+    for (int i = 0; i < n; i++) {
+      wt[i]++;  // No item without weight for the unbounded problem
+      count[i] = knapsack_random(seed, 7);
+      group[i] = knapsack_random(seed, 4);
+    }
+
+    // Bounded: same value as the 0/1 problem with a copy of each item
+    vector<unsigned int> copies_wt;
+    vector<int> copies_val;
+    for (int i = 0; i < n; i++)
+      for (unsigned int c = 0; c < count[i]; c++) {
+        copies_wt.push_back(wt[i]);
+        copies_val.push_back(val[i]);
+      }
+    Knapsack<int> copies(W, copies_wt, copies_val);
+    Knapsack_bounded<int> bounded(W, wt, val, count);
+    const int opt_bounded = copies();
+    vector<unsigned int> Counts;
+    if (bounded() != opt_bounded || bounded.get_nb_split_items() > copies_wt.size())
+      fail++;
+    bounded.get_chosen_objects(Counts);
+    if (!knapsack_is_feasible(Counts, wt, val, W, opt_bounded))
+      fail++;
+    for (int i = 0; i < n; i++)
+      if (Counts[i] > count[i])
+        fail++;
+
+    // Unbounded: same value as the bounded problem with as many copies as the knapsack can hold
+    vector<unsigned int> max_count(n);
+    for (int i = 0; i < n; i++)
+      max_count[i] = W / wt[i];
+    Knapsack_bounded<int> all_copies(W, wt, val, max_count);
+    all_copies.set_table_mode(KNAPSACK_ROLLING_ROW);
+    Knapsack_unbounded<int> unbounded(W, wt, val);
+    const int opt_unbounded = all_copies();
+    if (unbounded() != opt_unbounded)
+      fail++;
+    unbounded.get_chosen_objects(Counts);
+    if (!knapsack_is_feasible(Counts, wt, val, W, opt_unbounded))
+      fail++;
+
+    // Multiple choice: same value as the enumeration of the choices (no item or one item per group)
+    int opt_choice = 0;
+    for (int combination = 0; combination < 1 << (2*4); combination++) {
+      // Item number (combination >> 2g) & 3 of the group g, 0 for no item
+      int value = 0;
+      unsigned int weight = 0;
+      bool valid = true;
+      for (unsigned int g = 0; g < 4; g++) {
+        int rank = (combination >> (2*g)) & 3;
+        int item = -1;
+        for (int i = 0; i < n && rank > 0; i++)
+          if (group[i] == g && --rank == 0)
+            item = i;
+        if (rank > 0)
+          valid = false;
+        else if (item >= 0) {
+          value += val[item];
+          weight += wt[item];
+        }
+      }
+      if (valid && weight <= W)
+        opt_choice = std::max(opt_choice, value);
+    }
+    Knapsack_multiple_choice<int> choice(W, wt, val, group);
+    vector<bool> Solution;
+    if (choice() != opt_choice)
+      fail++;
+    choice.get_chosen_objects(Solution);
+    vector<int> nb_chosen(4, 0);
+    for (int i = 0; i < n; i++)
+      if (Solution[i])
+        nb_chosen[group[i]]++;
+    if (!knapsack_is_feasible(Solution, wt, val, W, opt_choice) || *std::max_element(nb_chosen.begin(), nb_chosen.end()) > 1)
+      fail++;
+  }
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
+int KnapSack_branch_and_bound_test()
+{
+  cout << "*** Knapsack branch and bound test ****" << endl;
+  int fail = 0;
+
+  // Same optimal value as the dynamic programming on random instances
+  unsigned int seed = 2718;
+  for (int t = 0; t < 30; t++) {
+    vector<int> val;
+    vector<unsigned int> wt;
+    knapsack_random_instance(seed, 1 + t, 60, 100, 10, wt, val);
+    const unsigned int W = 11*t + 5;
+    Knapsack<int> dynamic(W, wt, val);
+    Knapsack_branch_and_bound<int, unsigned int> branch(W, wt, val);
+    const int opt = dynamic();
+    if (branch() != opt || branch.get_optimal_value() != opt || !branch.is_optimal())
+      fail++;
+
+    vector<bool> Solution;
+    branch.get_chosen_objects(Solution);
+    if (!knapsack_is_feasible(Solution, wt, val, W, opt))
+      fail++;
+  }
+
+  // Huge capacity with real weights: the weights are the ones of a small instance times 1e10
+  {
+    vector<unsigned int> wt(5);  wt[0] = 12; wt[1] = 7; wt[2] = 11; wt[3] = 8; wt[4] = 9;
+    vector<double> val(5);       val[0] = 24; val[1] = 13; val[2] = 23; val[3] = 15; val[4] = 16;
+    vector<double> huge_wt(5);
+    for (int i = 0; i < 5; i++)
+      huge_wt[i] = wt[i] * 1e10;
+    Knapsack<double> dynamic(26, wt, val);
+    Knapsack_branch_and_bound<double> branch;
+    if (branch(26e10, huge_wt, val) != dynamic())
+      fail++;
+    vector<bool> S1, S2;
+    dynamic.get_chosen_objects(S1);
+    branch.get_chosen_objects(S2);
+    if (S1 != S2)
+      fail++;
+
+    // With a limit on the nodes, the solution stays feasible
+    branch.set_max_nodes(1);
+    branch();
+    if (branch.get_nb_nodes() > 1 || branch.get_optimal_value() > dynamic.get_optimal_value())
+      fail++;
+  }
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
 int n_choose_k_iterator_test()
 {
   cout << "******* N_choose_K_iterator test *******" << endl;
@@ -431,6 +1808,46 @@ int random_iterator_test()
 }
 
 
+int sparse_array2d_test()
+{
+  cout << "********* Sparse_array2d test **********" << endl;
+  int fail = 0;
+
+  Sparse_array2d_builder<double> builder(6, 9);
+  builder.add(4, 7, 2.);
+  builder.add(0, 3, 1.);
+  builder.add(4, 1, -1.);
+  builder.add(4, 7, 0.5);  // Summed with the first element
+  builder.add(2, 2, 3.);
+  builder.add(2, 2, -3.);  // Cancel the element (2,2)
+  Sparse_array2d<double> S(builder);
+  if (S.nb_rows() != 6 || S.nb_columns() != 9 || S.nb_nonzeros() != 3 || S.row_size(4) != 2
+      || S(4,7) != 2.5 || S(4,1) != -1. || S(2,2) != 0. || S(5,8) != 0. || S.sum() != 2.5)
+    fail++;
+
+  Array2d<double> D;
+  S.to_dense(D);
+  Sparse_array2d<double> S2(D);
+  if (D(0,3) != 1. || D.sum() != 2.5 || S2.nb_nonzeros() != 3 || S2(4,7) != 2.5)
+    fail++;
+  if (S.dot_product(S2) != D.dot_product(D) || S.dot_product(D) != D.dot_product(D))
+    fail++;
+
+  S.push_back_row(std::vector<double>(9, 0.));
+  std::vector<int> columns(2);
+  columns[0] = 1;
+  columns[1] = 8;
+  S.push_back_row(columns, std::vector<double>(2, 4.));
+  if (S.nb_rows() != 8 || S.nb_nonzeros() != 5 || S(7,8) != 4. || S(6,1) != 0.)
+    fail++;
+
+  if (fail > 0) {
+    cout << "===> FAIL <===" << endl;
+  }
+  return fail;
+}
+
+
 int time_tools_test()
 {
   cout << "*********** Time tools test ************" << endl;
@@ -518,9 +1935,48 @@ int main()
   srand (time(NULL));
 
   int nb_failure = 0;
+  nb_failure += allocator_test();
+  std::cout << std::endl;
+
   nb_failure += array2d_test();
   std::cout << std::endl;
 
+  nb_failure += array2d_kernels_test();
+  std::cout << std::endl;
+
+  nb_failure += array2d_parallel_test();
+  std::cout << std::endl;
+
+  nb_failure += array2d_layout_test();
+  std::cout << std::endl;
+
+  nb_failure += array2d_transpose_multiply_test();
+  std::cout << std::endl;
+
+  nb_failure += array2d_batch_test();
+  std::cout << std::endl;
+
+  nb_failure += array2d_aligned_test();
+  std::cout << std::endl;
+
+  nb_failure += array2d_copy_move_test();
+  std::cout << std::endl;
+
+  nb_failure += array2d_expr_test();
+  std::cout << std::endl;
+
+  nb_failure += array2d_view_test();
+  std::cout << std::endl;
+
+  nb_failure += array2d_io_test();
+  std::cout << std::endl;
+
+  nb_failure += array2d_text_test();
+  std::cout << std::endl;
+
+  nb_failure += fixed_array2d_test();
+  std::cout << std::endl;
+
   nb_failure += hcube_iterator_test();
   std::cout << std::endl;
 
@@ -533,6 +1989,30 @@ int main()
   nb_failure += KnapSack_test3();
   std::cout << std::endl;
 
+  nb_failure += KnapSack_table_test();
+  std::cout << std::endl;
+
+  nb_failure += KnapSack_simd_test();
+  std::cout << std::endl;
+
+  nb_failure += KnapSack_parallel_test();
+  std::cout << std::endl;
+
+  nb_failure += KnapSack_preprocessing_test();
+  std::cout << std::endl;
+
+  nb_failure += KnapSack_batch_test();
+  std::cout << std::endl;
+
+  nb_failure += KnapSack_incremental_test();
+  std::cout << std::endl;
+
+  nb_failure += KnapSack_variants_test();
+  std::cout << std::endl;
+
+  nb_failure += KnapSack_branch_and_bound_test();
+  std::cout << std::endl;
+
   nb_failure += n_choose_k_iterator_test();
   std::cout << std::endl;
 
@@ -545,6 +2025,9 @@ int main()
   nb_failure += random_iterator_test();
   std::cout << std::endl;
 
+  nb_failure += sparse_array2d_test();
+  std::cout << std::endl;
+
   nb_failure += time_tools_test();
   std::cout << std::endl;
 